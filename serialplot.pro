@@ -60,7 +60,9 @@ SOURCES += \
     src/omitstreamreader.cpp \
     src/omitstreamreadersettings.cpp \
     src/portcontrol.cpp \
+    src/asyncserialport.cpp \
     src/plot.cpp \
+    src/curvelayer.cpp \
     src/zoomer.cpp \
     src/scrollzoomer.cpp \
     src/scrollbar.cpp \
@@ -85,9 +87,21 @@ SOURCES += \
     src/streamchannel.cpp \
     src/channelinfomodel.cpp \
     src/ringbuffer.cpp \
+    src/minmax.cpp \
+    src/gainoffset.cpp \
+    src/minmaxpyramid.cpp \
     src/indexbuffer.cpp \
     src/linindexbuffer.cpp \
-    src/readonlybuffer.cpp \
+    src/xringbuffer.cpp \
+    src/multiringbuffer.cpp \
+    src/mirroredmemory.cpp \
+    src/parallelfor.cpp \
+    src/allocator.cpp \
+    src/historyfile.cpp \
+    src/tieredhistory.cpp \
+    src/sweepbuffer.cpp \
+    src/compression.cpp \
+    src/compressedbuffer.cpp \
     src/framebufferseries.cpp \
     src/numberformatbox.cpp \
     src/endiannessbox.cpp \
@@ -101,6 +115,7 @@ SOURCES += \
     src/framedreader.cpp \
     src/framedreadersettings.cpp \
     src/plotmanager.cpp \
+    src/renderscheduler.cpp \
     src/plotmenu.cpp \
     src/barplot.cpp \
     src/barchart.cpp \
@@ -110,20 +125,26 @@ SOURCES += \
     src/versionnumber.cpp \
     src/updatecheckdialog.cpp \
     src/samplepack.cpp \
+    src/samplepackview.cpp \
     src/source.cpp \
     src/sink.cpp \
+    src/sinkpool.cpp \
     src/samplecounter.cpp \
+    src/packqueue.cpp \
     src/ledwidget.cpp \
     src/datatextview.cpp \
-    src/bpslabel.cpp
+    src/bpslabel.cpp \
+    src/memorylabel.cpp
 
 HEADERS += \
     src/mainwindow.h \
     src/omitstreamreadersettings.h \
     src/utils.h \
     src/portcontrol.h \
+    src/asyncserialport.h \
     src/byteswap.h \
     src/plot.h \
+    src/curvelayer.h \
     src/hidabletabwidget.h \
     src/framebuffer.h \
     src/scalepicker.h \
@@ -153,6 +174,7 @@ HEADERS += \
     src/demoreader.h \
     src/framedreader.h \
     src/plotmanager.h \
+    src/renderscheduler.h \
     src/setting_defines.h \
     src/numberformat.h \
     src/recordpanel.h \
@@ -161,6 +183,7 @@ HEADERS += \
     src/demoreadersettings.h \
     src/datatextview.h \
     src/bpslabel.h \
+    src/memorylabel.h \
     src/barchart.h \
     src/barplot.h \
     src/barscaledraw.h \
@@ -170,14 +193,30 @@ HEADERS += \
     src/indexbuffer.h \
     src/ledwidget.h \
     src/linindexbuffer.h \
+    src/xringbuffer.h \
+    src/multiringbuffer.h \
+    src/mirroredmemory.h \
+    src/parallelfor.h \
+    src/allocator.h \
+    src/history.h \
+    src/historyfile.h \
+    src/tieredhistory.h \
     src/plotmenu.h \
-    src/readonlybuffer.h \
+    src/sweepbuffer.h \
+    src/compression.h \
+    src/compressedbuffer.h \
     src/ringbuffer.h \
+    src/minmax.h \
+    src/gainoffset.h \
+    src/minmaxpyramid.h \
     src/samplecounter.h \
+    src/packqueue.h \
     src/samplepack.h \
+    src/samplepackview.h \
     src/scrollbar.h \
     src/scrollzoomer.h \
     src/sink.h \
+    src/sinkpool.h \
     src/source.h \
     src/streamchannel.h \
     src/stream.h \
@@ -18,6 +18,8 @@
 */
 
 #include "abstractreader.h"
+#include <QMetaObject>
+#include <QThread>
 #include <QtDebug>
 
 AbstractReader::AbstractReader(QIODevice* device, QObject* parent) :
@@ -53,8 +55,17 @@ void AbstractReader::onDataReady()
 
 unsigned AbstractReader::getBytesRead()
 {
-    unsigned r = bytesRead;
-    bytesRead = 0;
+    return bytesRead.exchange(0);
+}
 
-    return r;
+void AbstractReader::runInReaderThread(std::function<void()> func)
+{
+    if (thread() == QThread::currentThread())
+    {
+        func();
+    }
+    else
+    {
+        QMetaObject::invokeMethod(this, func, Qt::BlockingQueuedConnection);
+    }
 }
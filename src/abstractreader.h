@@ -20,6 +20,8 @@
 #ifndef ABSTRACTREADER_H
 #define ABSTRACTREADER_H
 
+#include <atomic>
+#include <functional>
 #include <QObject>
 #include <QIODevice>
 #include <QWidget>
@@ -29,6 +31,10 @@
 
 /**
  * All reader classes must inherit this class.
+ *
+ * A reader may be moved to the thread of its device so that data is
+ * decoded as soon as it arrives. Settings widgets stay in GUI thread,
+ * changes from them are applied with `runInReaderThread()`.
  */
 class AbstractReader : public QObject, public Source
 {
@@ -43,15 +49,21 @@ public:
     virtual QWidget* settingsWidget() = 0;
 
     /// Reader should only read when enabled. Default state should be
-    /// 'disabled'.
+    /// 'disabled'. Must be called in reader thread.
     virtual void enable(bool enabled = true);
 
-    /// None of the current readers support X channel at the moment
-    bool hasX() const final { return false; };
+    /// Readers that provide X data (ex: device timestamps) should
+    /// re-implement this. Default is no X data.
+    bool hasX() const override { return false; };
 
-    /// Read and 'zero' the byte counter
+    /// Read and 'zero' the byte counter. Can be called from any
+    /// thread.
     unsigned getBytesRead();
 
+    /// Runs `func` in the thread of the reader and waits for it to
+    /// finish. It's called directly if reader is in the calling thread.
+    void runInReaderThread(std::function<void()> func);
+
 signals:
     // TODO: should we keep this?
     void numOfChannelsChanged(unsigned);
@@ -61,7 +73,8 @@ public slots:
      * Pauses the reading.
      *
      * Reader should actually continue reading to keep the
-     * synchronization but shouldn't commit data.
+     * synchronization but shouldn't commit data. Must be called in
+     * reader thread.
      */
     void pause(bool enabled);
 
@@ -81,7 +94,7 @@ protected:
     virtual unsigned readData() = 0;
 
 private:
-    unsigned bytesRead;
+    std::atomic<unsigned> bytesRead;
 
 private slots:
     void onDataReady();
@@ -0,0 +1,287 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "allocator.h"
+
+#if defined(Q_OS_LINUX) || defined(__linux__)
+#include <sys/mman.h>
+#define MAP_SUPPORTED
+#endif
+
+/// Aligned blocks at least this big are mapped directly from the system
+static const size_t MIN_MAPPED_SIZE = 256 * 1024;
+/// Mapped blocks at least this big are aligned and marked for huge pages
+static const size_t HUGEPAGE_SIZE = 2 * 1024 * 1024;
+/// Size of the smallest class of pool, each class is twice the previous one
+static const size_t MIN_CLASS_SIZE = MEMORY_ALIGNMENT;
+/// Number of size classes, bigger blocks are not pooled (64B ... 1MB)
+static const unsigned NUM_CLASSES = 15;
+/// Maximum number of free blocks kept in a class
+static const unsigned MAX_CLASS_BLOCKS = 32;
+/// Maximum total size of free blocks kept in a class
+static const size_t MAX_CLASS_BYTES = 4 * 1024 * 1024;
+
+static std::atomic<size_t> counters[MemoryUser_NUM];
+static std::atomic<size_t> misses;
+
+namespace
+{
+    struct Pool
+    {
+        std::mutex lock;
+        std::vector<void*> blocks[NUM_CLASSES]; ///< free blocks of each class
+
+        Pool()
+        {
+            // returning a block never allocates
+            for (auto& b : blocks) b.reserve(MAX_CLASS_BLOCKS);
+        }
+    };
+}
+
+/// Returns the pool. It's never destroyed, so that blocks can be returned
+/// to it during static destruction.
+static Pool& pool()
+{
+    static Pool* p = new Pool;
+    return *p;
+}
+
+/// Allocates a zeroed, aligned block from heap. Start of the underlying
+/// allocation is stored right before the returned block.
+static void* heapAlloc(size_t bytes)
+{
+    void* block = calloc(bytes + MEMORY_ALIGNMENT + sizeof(void*), 1);
+    if (block == nullptr) throw std::bad_alloc();
+
+    uintptr_t addr = reinterpret_cast<uintptr_t>(block) + sizeof(void*);
+    addr = (addr + MEMORY_ALIGNMENT - 1) / MEMORY_ALIGNMENT * MEMORY_ALIGNMENT;
+    reinterpret_cast<void**>(addr)[-1] = block;
+    return reinterpret_cast<void*>(addr);
+}
+
+static void heapFree(void* mem)
+{
+    free(static_cast<void**>(mem)[-1]);
+}
+
+#ifdef MAP_SUPPORTED
+static void* mapAlloc(size_t bytes)
+{
+    if (bytes < HUGEPAGE_SIZE)
+    {
+        void* mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) throw std::bad_alloc();
+        return mem;
+    }
+
+    // huge pages can only be used for aligned parts of the block, so an
+    // aligned range is cut from a bigger mapping
+    size_t alignedLength = (bytes + HUGEPAGE_SIZE - 1) / HUGEPAGE_SIZE * HUGEPAGE_SIZE;
+    size_t length = alignedLength + HUGEPAGE_SIZE;
+    void* mem = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) throw std::bad_alloc();
+
+    char* start = static_cast<char*>(mem);
+    char* end = start + length;
+    char* aligned = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(start) + HUGEPAGE_SIZE - 1) / HUGEPAGE_SIZE * HUGEPAGE_SIZE);
+    char* alignedEnd = aligned + alignedLength;
+    if (aligned > start) munmap(start, aligned - start);
+    if (end > alignedEnd) munmap(alignedEnd, end - alignedEnd);
+
+#ifdef MADV_HUGEPAGE
+    // just a hint, failure is not important
+    madvise(aligned, alignedEnd - aligned, MADV_HUGEPAGE);
+#endif
+    return aligned;
+}
+
+static void mapFree(void* mem, size_t bytes)
+{
+    if (bytes >= HUGEPAGE_SIZE)
+    {
+        bytes = (bytes + HUGEPAGE_SIZE - 1) / HUGEPAGE_SIZE * HUGEPAGE_SIZE;
+    }
+    munmap(mem, bytes);
+}
+#endif // MAP_SUPPORTED
+
+void* allocAligned(size_t bytes, MemoryUser user)
+{
+    void* mem;
+#ifdef MAP_SUPPORTED
+    if (bytes >= MIN_MAPPED_SIZE)
+    {
+        mem = mapAlloc(bytes);
+    }
+    else
+#endif
+    {
+        mem = heapAlloc(bytes);
+    }
+
+    countMemory(user, bytes);
+    return mem;
+}
+
+void freeAligned(void* mem, size_t bytes, MemoryUser user)
+{
+    if (mem == nullptr) return;
+
+#ifdef MAP_SUPPORTED
+    if (bytes >= MIN_MAPPED_SIZE)
+    {
+        mapFree(mem, bytes);
+    }
+    else
+#endif
+    {
+        heapFree(mem);
+    }
+
+    countMemory(user, -(ptrdiff_t) bytes);
+}
+
+/// Returns index of the smallest class that fits `bytes`. Returns
+/// `NUM_CLASSES` if it doesn't fit any.
+static unsigned sizeClass(size_t bytes)
+{
+    unsigned c = 0;
+    while (c < NUM_CLASSES && (MIN_CLASS_SIZE << c) < bytes) c++;
+    return c;
+}
+
+void* allocPooled(size_t bytes, MemoryUser user)
+{
+    unsigned c = sizeClass(bytes);
+    if (c == NUM_CLASSES)
+    {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return allocAligned(bytes, user);
+    }
+
+    size_t classSize = MIN_CLASS_SIZE << c;
+    void* mem = nullptr;
+    {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> guard(p.lock);
+        if (!p.blocks[c].empty())
+        {
+            mem = p.blocks[c].back();
+            p.blocks[c].pop_back();
+        }
+    }
+
+    if (mem != nullptr)
+    {
+        countMemory(MemoryUser_Pool, -(ptrdiff_t) classSize);
+    }
+    else
+    {
+        mem = heapAlloc(classSize);
+        misses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    countMemory(user, classSize);
+    return mem;
+}
+
+void freePooled(void* mem, size_t bytes, MemoryUser user)
+{
+    if (mem == nullptr) return;
+
+    unsigned c = sizeClass(bytes);
+    if (c == NUM_CLASSES)
+    {
+        freeAligned(mem, bytes, user);
+        return;
+    }
+
+    size_t classSize = MIN_CLASS_SIZE << c;
+    size_t maxBlocks = std::max<size_t>(1, std::min<size_t>(MAX_CLASS_BLOCKS, MAX_CLASS_BYTES / classSize));
+    bool kept = false;
+    {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> guard(p.lock);
+        if (p.blocks[c].size() < maxBlocks)
+        {
+            p.blocks[c].push_back(mem);
+            kept = true;
+        }
+    }
+
+    if (kept)
+    {
+        countMemory(MemoryUser_Pool, classSize);
+    }
+    else
+    {
+        heapFree(mem);
+    }
+
+    countMemory(user, -(ptrdiff_t) classSize);
+}
+
+void countMemory(MemoryUser user, ptrdiff_t bytes)
+{
+    Q_ASSERT(user < MemoryUser_NUM);
+
+    counters[user].fetch_add((size_t) bytes, std::memory_order_relaxed);
+}
+
+size_t memoryReserved(MemoryUser user)
+{
+    Q_ASSERT(user < MemoryUser_NUM);
+
+    return counters[user].load(std::memory_order_relaxed);
+}
+
+size_t poolMisses()
+{
+    return misses.load(std::memory_order_relaxed);
+}
+
+const char* memoryUserName(MemoryUser user)
+{
+    switch (user)
+    {
+        case MemoryUser_Channels:
+            return "Channels";
+        case MemoryUser_Packs:
+            return "Sample packs";
+        case MemoryUser_Snapshots:
+            return "Snapshots";
+        case MemoryUser_Pool:
+            return "Pool (free)";
+        default:
+            return "";
+    }
+}
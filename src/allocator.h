@@ -0,0 +1,84 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stddef.h>
+
+/**
+ * @file allocator.h
+ *
+ * Memory for sample data. All blocks are aligned to `MEMORY_ALIGNMENT`
+ * bytes so that channel data can be processed with SIMD instructions.
+ *
+ * There are 2 kinds of allocations:
+ *
+ * - Aligned (`allocAligned()`): long lived buffers, ex: channel data. Big
+ *   blocks are mapped directly from the system, so they are zeroed lazily,
+ *   and they are marked for transparent huge pages where supported.
+ *
+ * - Pooled (`allocPooled()`): short lived buffers, ex: sample packs that
+ *   are created for every read from device. Sizes are rounded up to a
+ *   power of 2 and freed blocks are kept in a pool to be re-used by next
+ *   allocation of the same size class, so they don't churn the heap.
+ *
+ * Both functions are thread safe. Bytes reserved by each user are counted
+ * and can be queried with `memoryReserved()`.
+ */
+
+/// Subsystems that memory is accounted for
+enum MemoryUser
+{
+    MemoryUser_Channels,     ///< channel buffers of the stream
+    MemoryUser_Packs,        ///< sample packs in flight
+    MemoryUser_Snapshots,    ///< snapshot buffers
+    MemoryUser_Pool,         ///< free blocks kept in pool
+    MemoryUser_NUM           ///< number of users
+};
+
+/// Alignment of all blocks in bytes
+const size_t MEMORY_ALIGNMENT = 64;
+
+/// Returns a zero initialized, aligned block of `bytes` bytes.
+void* allocAligned(size_t bytes, MemoryUser user);
+/// Frees a block that is allocated with `allocAligned()` with same parameters.
+void freeAligned(void* mem, size_t bytes, MemoryUser user);
+
+/// Returns an aligned block of `bytes` bytes from pool. Contents are *not*
+/// initialized.
+void* allocPooled(size_t bytes, MemoryUser user);
+/// Returns a block that is allocated with `allocPooled()` with same
+/// parameters back to pool.
+void freePooled(void* mem, size_t bytes, MemoryUser user);
+
+/**
+ * Adds `bytes` (can be negative) to the counter of `user`. For memory
+ * that is allocated by other means, ex: mirrored memory.
+ */
+void countMemory(MemoryUser user, ptrdiff_t bytes);
+/// Returns number of bytes currently reserved by `user`.
+size_t memoryReserved(MemoryUser user);
+/// Returns number of pooled allocations so far that couldn't be served from
+/// the pool and are allocated from the system.
+size_t poolMisses();
+/// Returns display name of a user.
+const char* memoryUserName(MemoryUser user);
+
+#endif // ALLOCATOR_H
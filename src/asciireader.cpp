@@ -34,34 +34,41 @@ AsciiReader::AsciiReader(QIODevice* device, QObject* parent) :
     delimiter = _settingsWidget.delimiter();
     isHexData = _settingsWidget.isHex();
 
+    // settings are applied in reader thread, see `AbstractReader`
     connect(&_settingsWidget, &AsciiReaderSettings::numOfChannelsChanged,
             [this](unsigned value)
             {
-                _numChannels = value;
-                updateNumChannels(); // TODO: setting numchannels = 0, should remove all buffers
-                                     // do we want this?
-                autoNumOfChannels = (_numChannels == NUMOFCHANNELS_AUTO);
-                if (!autoNumOfChannels)
-                {
-                    emit numOfChannelsChanged(value);
-                }
+                runInReaderThread([this, value]()
+                    {
+                        _numChannels = value;
+                        updateNumChannels(); // TODO: setting numchannels = 0, should remove all buffers
+                                             // do we want this?
+                        autoNumOfChannels = (_numChannels == NUMOFCHANNELS_AUTO);
+                        if (!autoNumOfChannels)
+                        {
+                            emit numOfChannelsChanged(value);
+                        }
+                    });
             });
 
     connect(&_settingsWidget, &AsciiReaderSettings::delimiterChanged,
             [this](QChar d)
             {
-                delimiter = d;
+                runInReaderThread([this, d]() {delimiter = d;});
             });
     connect(&_settingsWidget, &AsciiReaderSettings::filterChanged,
             [this](AsciiReaderSettings::FilterMode mode, QString prefix)
             {
-                filterMode = mode;
-                filterPrefix = prefix;
+                runInReaderThread([this, mode, prefix]()
+                    {
+                        filterMode = mode;
+                        filterPrefix = prefix;
+                    });
             });
     connect(&_settingsWidget, &AsciiReaderSettings::hexChanged,
             [this](bool hexData)
             {
-                isHexData = hexData;
+                runInReaderThread([this, hexData]() {isHexData = hexData;});
             });
 }
 
@@ -136,11 +143,10 @@ unsigned AsciiReader::readData()
                 break;
         }
 
-        const SamplePack* samples = parseLine(line);
-        if (samples != nullptr) {
+        if (parseLine(line)) {
             // update number of channels if in auto mode
             if (autoNumOfChannels ) {
-                unsigned nc = samples->numChannels();
+                unsigned nc = lineSamples.numChannels();
                 if (nc != _numChannels) {
                     _numChannels = nc;
                     updateNumChannels();
@@ -149,18 +155,17 @@ unsigned AsciiReader::readData()
                 }
             }
 
-            Q_ASSERT(samples->numChannels() == _numChannels);
+            Q_ASSERT(lineSamples.numChannels() == _numChannels);
 
             // commit data
-            feedOut(*samples);
-            delete samples;
+            feedOut(lineSamples);
         }
     }
 
     return numBytesRead;
 }
 
-SamplePack* AsciiReader::parseLine(const QString& line) const
+bool AsciiReader::parseLine(const QString& line)
 {
     auto separatedValues = line.split(delimiter, QString::SkipEmptyParts);
     unsigned numComingChannels = separatedValues.length();
@@ -170,11 +175,16 @@ SamplePack* AsciiReader::parseLine(const QString& line) const
     {
         qWarning() << "Line parsing error: invalid number of channels!";
         qWarning() << "Read line: " << line;
-        return nullptr;
+        return false;
     }
 
-    // parse data per channel
-    auto samples = new SamplePack(1, numComingChannels);
+    // parse data per channel, pack is only re-created when number of
+    // channels changes
+    if (lineSamples.numChannels() != numComingChannels)
+    {
+        lineSamples = SamplePack(1, numComingChannels);
+    }
+    SamplePack* samples = &lineSamples;
     for (unsigned ci = 0; ci < numComingChannels; ci++)
     {
         // Strip arduino style labels from data
@@ -197,12 +207,11 @@ SamplePack* AsciiReader::parseLine(const QString& line) const
             qWarning() << "Data parsing error for channel: " << ci;
             qWarning() << "Read line: " << line;
 
-            delete samples;
-            return nullptr;
+            return false;
         }
     }
 
-    return samples;
+    return true;
 }
 
 void AsciiReader::saveSettings(QSettings* settings)
@@ -52,17 +52,18 @@ private:
     QString filterPrefix; ///< selected ASCII mode filter prefix
 
     bool firstReadAfterEnable = false;
+    SamplePack lineSamples; ///< re-used for each line
 
     unsigned readData() override;
 
 private slots:
 
     /**
-     * Parses given line and returns sample pack.
+     * Parses given line into `lineSamples`.
      *
-     * Returns `nullptr` in case of error.
+     * Returns `false` in case of error.
      */
-    SamplePack* parseLine(const QString& line) const;
+    bool parseLine(const QString& line);
 };
 
 #endif // ASCIIREADER_H
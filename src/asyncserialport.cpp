@@ -0,0 +1,286 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <QMutexLocker>
+#include <QMetaObject>
+#include <QtDebug>
+
+#include "asyncserialport.h"
+
+AsyncSerialPort::AsyncSerialPort(QObject* parent) :
+    QIODevice(parent)
+{
+    _ioThread.setObjectName("Serial I/O");
+    rxOffset = 0;
+    _droppedBytes = 0;
+    port = new QSerialPort;
+    port->moveToThread(&_ioThread);
+
+    // these are emitted and handled in I/O thread
+    connect(port, &QSerialPort::readyRead, port, [this]()
+            {
+                drainPort();
+            });
+    connect(port, &QSerialPort::errorOccurred, port,
+            [this](QSerialPort::SerialPortError e)
+            {
+                forwardError(e);
+            });
+
+    _ioThread.start();
+}
+
+AsyncSerialPort::~AsyncSerialPort()
+{
+    if (isOpen()) close();
+    _ioThread.quit();
+    _ioThread.wait();
+    delete port;
+}
+
+template <typename F>
+auto AsyncSerialPort::inPortThread(F func) const -> decltype(func())
+{
+    decltype(func()) result;
+    QMetaObject::invokeMethod(port, [&result, &func]()
+                              {
+                                  result = func();
+                              }, Qt::BlockingQueuedConnection);
+    return result;
+}
+
+void AsyncSerialPort::drainPort()
+{
+    QByteArray data = port->readAll();
+    if (data.isEmpty()) return;
+
+    {
+        QMutexLocker locker(&rxLock);
+
+        // move unread data to front once read part is the bigger half,
+        // so that reads don't have to
+        if (rxOffset > 0 && rxOffset >= rxBuffer.size() - rxOffset)
+        {
+            rxBuffer.remove(0, rxOffset);
+            rxOffset = 0;
+        }
+
+        int space = RX_BUFFER_LIMIT - (rxBuffer.size() - rxOffset);
+        if (data.size() > space)
+        {
+            if (_droppedBytes == 0)
+            {
+                qWarning() << "Serial receive buffer is full, dropping incoming data!";
+            }
+            _droppedBytes += data.size() - space;
+            data.truncate(space);
+        }
+        rxBuffer.append(data);
+    }
+
+    // readers in this thread are called directly
+    if (isOpen()) emit readyRead();
+}
+
+void AsyncSerialPort::forwardError(QSerialPort::SerialPortError e)
+{
+    QString msg = port->errorString();
+    QMetaObject::invokeMethod(this, [this, e, msg]()
+                              {
+                                  setErrorString(msg);
+                                  emit error(e);
+                              }, Qt::QueuedConnection);
+}
+
+QThread* AsyncSerialPort::ioThread()
+{
+    return &_ioThread;
+}
+
+bool AsyncSerialPort::isSequential() const
+{
+    return true;
+}
+
+void AsyncSerialPort::clearRx()
+{
+    rxBuffer.clear();
+    rxOffset = 0;
+}
+
+bool AsyncSerialPort::open(OpenMode mode)
+{
+    {
+        QMutexLocker locker(&rxLock);
+        clearRx();
+        _droppedBytes = 0;
+    }
+
+    // device state is changed in I/O thread where it's read
+    bool opened = inPortThread([this, mode]()
+                               {
+                                   return port->open(mode) && QIODevice::open(mode);
+                               });
+    if (!opened)
+    {
+        setErrorString(inPortThread([this]() {return port->errorString();}));
+    }
+    return opened;
+}
+
+void AsyncSerialPort::close()
+{
+    inPortThread([this]()
+                 {
+                     QIODevice::close(); // emits `aboutToClose`
+                     port->close();
+                     return true;
+                 });
+
+    QMutexLocker locker(&rxLock);
+    clearRx();
+}
+
+qint64 AsyncSerialPort::bytesAvailable() const
+{
+    QMutexLocker locker(&rxLock);
+    return rxBuffer.size() - rxOffset + QIODevice::bytesAvailable();
+}
+
+bool AsyncSerialPort::canReadLine() const
+{
+    {
+        QMutexLocker locker(&rxLock);
+        if (rxBuffer.indexOf('\n', rxOffset) >= 0) return true;
+    }
+    return QIODevice::canReadLine();
+}
+
+quint64 AsyncSerialPort::droppedBytes() const
+{
+    QMutexLocker locker(&rxLock);
+    return _droppedBytes;
+}
+
+qint64 AsyncSerialPort::readData(char* data, qint64 maxSize)
+{
+    QMutexLocker locker(&rxLock);
+    qint64 n = std::min(maxSize, (qint64) (rxBuffer.size() - rxOffset));
+    memcpy(data, rxBuffer.constData() + rxOffset, n);
+    rxOffset += n;
+    if (rxOffset == rxBuffer.size()) clearRx();
+    return n;
+}
+
+qint64 AsyncSerialPort::readLineData(char* data, qint64 maxSize)
+{
+    // default implementation reads a byte at a time
+    QMutexLocker locker(&rxLock);
+    const char* start = rxBuffer.constData() + rxOffset;
+    qint64 n = std::min(maxSize, (qint64) (rxBuffer.size() - rxOffset));
+    const char* nl = static_cast<const char*>(memchr(start, '\n', n));
+    if (nl != nullptr) n = nl - start + 1;
+    memcpy(data, start, n);
+    rxOffset += n;
+    if (rxOffset == rxBuffer.size()) clearRx();
+    return n;
+}
+
+qint64 AsyncSerialPort::writeData(const char* data, qint64 maxSize)
+{
+    QByteArray copy(data, maxSize);
+    QMetaObject::invokeMethod(port, [this, copy]()
+                              {
+                                  port->write(copy);
+                              }, Qt::QueuedConnection);
+    return maxSize;
+}
+
+QString AsyncSerialPort::portName() const
+{
+    return _portName;
+}
+
+void AsyncSerialPort::setPortName(const QString& name)
+{
+    _portName = name;
+    inPortThread([this, name]() {port->setPortName(name); return true;});
+}
+
+bool AsyncSerialPort::setBaudRate(qint32 baudRate)
+{
+    return inPortThread([this, baudRate]() {return port->setBaudRate(baudRate);});
+}
+
+qint32 AsyncSerialPort::baudRate() const
+{
+    return inPortThread([this]() {return port->baudRate();});
+}
+
+bool AsyncSerialPort::setDataBits(QSerialPort::DataBits dataBits)
+{
+    return inPortThread([this, dataBits]() {return port->setDataBits(dataBits);});
+}
+
+QSerialPort::DataBits AsyncSerialPort::dataBits() const
+{
+    return inPortThread([this]() {return port->dataBits();});
+}
+
+bool AsyncSerialPort::setParity(QSerialPort::Parity parity)
+{
+    return inPortThread([this, parity]() {return port->setParity(parity);});
+}
+
+QSerialPort::Parity AsyncSerialPort::parity() const
+{
+    return inPortThread([this]() {return port->parity();});
+}
+
+bool AsyncSerialPort::setStopBits(QSerialPort::StopBits stopBits)
+{
+    return inPortThread([this, stopBits]() {return port->setStopBits(stopBits);});
+}
+
+QSerialPort::StopBits AsyncSerialPort::stopBits() const
+{
+    return inPortThread([this]() {return port->stopBits();});
+}
+
+bool AsyncSerialPort::setFlowControl(QSerialPort::FlowControl flowControl)
+{
+    return inPortThread([this, flowControl]() {return port->setFlowControl(flowControl);});
+}
+
+bool AsyncSerialPort::setDataTerminalReady(bool set)
+{
+    return inPortThread([this, set]() {return port->setDataTerminalReady(set);});
+}
+
+bool AsyncSerialPort::setRequestToSend(bool set)
+{
+    return inPortThread([this, set]() {return port->setRequestToSend(set);});
+}
+
+QSerialPort::PinoutSignals AsyncSerialPort::pinoutSignals() const
+{
+    return inPortThread([this]() {return port->pinoutSignals();});
+}
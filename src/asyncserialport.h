@@ -0,0 +1,118 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ASYNCSERIALPORT_H
+#define ASYNCSERIALPORT_H
+
+#include <QIODevice>
+#include <QSerialPort>
+#include <QThread>
+#include <QMutex>
+#include <QByteArray>
+
+/**
+ * A serial port that does its I/O in a dedicated thread.
+ *
+ * Underlying `QSerialPort` lives in a worker thread which drains the
+ * device as soon as data arrives. So the OS buffer doesn't overflow
+ * when the GUI thread is busy (replotting, a modal dialog etc.).
+ * Received data is queued and read through the `QIODevice` interface
+ * as if it was the port itself. `readyRead()` is emitted in the worker
+ * thread, so readers that are moved to `ioThread()` decode data as soon
+ * as it arrives. Data should only be read in that thread.
+ *
+ * Port settings are applied in worker thread, setters block until
+ * done. Only the part of `QSerialPort` API that is used by the
+ * application is provided.
+ *
+ * Queued data is limited to `RX_BUFFER_LIMIT` bytes. If readers fall
+ * that much behind, incoming data is dropped and counted in
+ * `droppedBytes()`.
+ */
+class AsyncSerialPort : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    /// Maximum number of received bytes that are kept for reading
+    static const int RX_BUFFER_LIMIT = 32 * 1024 * 1024;
+
+    explicit AsyncSerialPort(QObject* parent = 0);
+    ~AsyncSerialPort();
+
+    bool isSequential() const override;
+    bool open(OpenMode mode) override;
+    void close() override;
+    qint64 bytesAvailable() const override;
+    bool canReadLine() const override;
+
+    QString portName() const;
+    void setPortName(const QString& name);
+
+    bool setBaudRate(qint32 baudRate);
+    qint32 baudRate() const;
+    bool setDataBits(QSerialPort::DataBits dataBits);
+    QSerialPort::DataBits dataBits() const;
+    bool setParity(QSerialPort::Parity parity);
+    QSerialPort::Parity parity() const;
+    bool setStopBits(QSerialPort::StopBits stopBits);
+    QSerialPort::StopBits stopBits() const;
+    bool setFlowControl(QSerialPort::FlowControl flowControl);
+
+    bool setDataTerminalReady(bool set);
+    bool setRequestToSend(bool set);
+    QSerialPort::PinoutSignals pinoutSignals() const;
+
+    /// Number of received bytes that are dropped because receive
+    /// buffer was full, since the port is opened
+    quint64 droppedBytes() const;
+
+    /// Thread that the port does its I/O and emits `readyRead()` in
+    QThread* ioThread();
+
+signals:
+    void error(QSerialPort::SerialPortError error);
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 readLineData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    QThread _ioThread;
+    QSerialPort* port;          ///< lives in `_ioThread`
+    QString _portName;
+    mutable QMutex rxLock;
+    QByteArray rxBuffer;        ///< received data, guarded by `rxLock`
+    int rxOffset;               ///< start of unread data in `rxBuffer`
+    quint64 _droppedBytes;      ///< guarded by `rxLock`
+
+    /// Runs `func` in the I/O thread and waits for its result.
+    template <typename F>
+    auto inPortThread(F func) const -> decltype(func());
+
+    /// Moves received data to `rxBuffer`. Runs in I/O thread.
+    void drainPort();
+    /// Drops all received data, `rxLock` must be held
+    void clearRx();
+    /// Forwards a port error. Runs in I/O thread.
+    void forwardError(QSerialPort::SerialPortError error);
+};
+
+#endif // ASYNCSERIALPORT_H
@@ -36,12 +36,17 @@ void BarChart::resample()
 
 QVector<double> BarChart::chartData() const
 {
+    // only the last sample is displayed, it's read by its sequence number
+    // so that it doesn't matter what channels are displaying
     unsigned numChannels = _stream->numChannels();
-    unsigned numSamples = _stream->numSamples();
     QVector<double> data(numChannels);
+    quint64 last = _stream->sequence();
     for (unsigned i = 0; i < numChannels; i++)
     {
-        data[i] = _stream->channel(i)->yData()->sample(numSamples-1);
+        if (last == 0 || !_stream->readSamples(i, last - 1, last, &data[i]))
+        {
+            data[i] = 0;
+        }
     }
     return data;
 }
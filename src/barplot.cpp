@@ -21,7 +21,8 @@
 #include "barscaledraw.h"
 #include "utils.h"
 
-BarPlot::BarPlot(Stream* stream, PlotMenu* menu, QWidget* parent) :
+BarPlot::BarPlot(Stream* stream, PlotMenu* menu, RenderScheduler* scheduler,
+                 QWidget* parent) :
     QwtPlot(parent), _menu(menu), barChart(stream)
 {
     _stream = stream;
@@ -30,7 +31,16 @@ BarPlot::BarPlot(Stream* stream, PlotMenu* menu, QWidget* parent) :
     setAxisScaleDraw(QwtPlot::xBottom, new BarScaleDraw(stream));
 
     update();
-    connect(_stream, &Stream::dataAdded, this, &BarPlot::update);
+    if (scheduler != nullptr)
+    {
+        scheduler->add(this, this, [this]() {update();});
+        connect(_stream, &Stream::dataAdded, this,
+                [this, scheduler]() {scheduler->markDirty(this);});
+    }
+    else
+    {
+        connect(_stream, &Stream::dataAdded, this, &BarPlot::update);
+    }
     connect(_stream, &Stream::numChannelsChanged, this, &BarPlot::update);
 
     // connect to menu
@@ -25,14 +25,17 @@
 #include "stream.h"
 #include "plotmenu.h"
 #include "barchart.h"
+#include "renderscheduler.h"
 
 class BarPlot : public QwtPlot
 {
     Q_OBJECT
 
 public:
+    /// If `scheduler` is given, new data is rendered with its frames
     explicit BarPlot(Stream* stream,
                      PlotMenu* menu,
+                     RenderScheduler* scheduler = nullptr,
                      QWidget* parent = 0);
 
 public slots:
@@ -30,25 +30,39 @@ BinaryStreamReader::BinaryStreamReader(QIODevice* device, QObject* parent) :
     skipByteRequested = false;
     skipSampleRequested = false;
 
+    // settings are applied in reader thread, see `AbstractReader`
     _numChannels = _settingsWidget.numOfChannels();
     connect(&_settingsWidget, &BinaryStreamReaderSettings::numOfChannelsChanged,
-                     this, &BinaryStreamReader::onNumOfChannelsChanged);
+            [this](unsigned value)
+            {
+                runInReaderThread([this, value]() {onNumOfChannelsChanged(value);});
+            });
 
     // initial number format selection
     onNumberFormatChanged(_settingsWidget.numberFormat());
     connect(&_settingsWidget, &BinaryStreamReaderSettings::numberFormatChanged,
-            this, &BinaryStreamReader::onNumberFormatChanged);
+            [this](NumberFormat nf)
+            {
+                runInReaderThread([this, nf]() {onNumberFormatChanged(nf);});
+            });
+
+    endianness = _settingsWidget.endianness();
+    connect(&_settingsWidget, &BinaryStreamReaderSettings::endiannessChanged,
+            [this](Endianness e)
+            {
+                runInReaderThread([this, e]() {endianness = e;});
+            });
 
     // enable skip byte and sample buttons
     connect(&_settingsWidget, &BinaryStreamReaderSettings::skipByteRequested,
             [this]()
             {
-                skipByteRequested = true;
+                runInReaderThread([this]() {skipByteRequested = true;});
             });
     connect(&_settingsWidget, &BinaryStreamReaderSettings::skipSampleRequested,
             [this]()
             {
-                skipSampleRequested = true;
+                runInReaderThread([this]() {skipSampleRequested = true;});
             });
 }
 
@@ -62,8 +76,14 @@ unsigned BinaryStreamReader::numChannels() const
     return _numChannels;
 }
 
+NumberFormat BinaryStreamReader::numberFormat() const
+{
+    return _numberFormat;
+}
+
 void BinaryStreamReader::onNumberFormatChanged(NumberFormat numberFormat)
 {
+    _numberFormat = numberFormat;
     switch(numberFormat)
     {
         case NumberFormat_uint8:
@@ -102,6 +122,8 @@ void BinaryStreamReader::onNumberFormatChanged(NumberFormat numberFormat)
             Q_ASSERT(1); // never
             break;
     }
+
+    updateNumChannels();
 }
 
 void BinaryStreamReader::onNumOfChannelsChanged(unsigned value)
@@ -151,16 +173,19 @@ unsigned BinaryStreamReader::readData()
         return totalRead;
     }
 
-    // actual reading
-    SamplePack samples(numOfPackagesToRead, _numChannels);
-    for (unsigned i = 0; i < numOfPackagesToRead; i++)
+    // actual reading, samples are decoded in the order they arrive and
+    // sinks are given a view of them
+    unsigned numSamples = numOfPackagesToRead * _numChannels;
+    if ((unsigned) decodeBuffer.size() < numSamples)
+    {
+        decodeBuffer.resize(numSamples);
+    }
+    double* samples = decodeBuffer.data();
+    for (unsigned i = 0; i < numSamples; i++)
     {
-        for (unsigned ci = 0; ci < _numChannels; ci++)
-        {
-            samples.data(ci)[i] = (this->*readSample)();
-        }
+        samples[i] = (this->*readSample)();
     }
-    feedOut(samples);
+    feedOut(SamplePackView::interleaved(numOfPackagesToRead, _numChannels, samples));
 
     return totalRead;
 }
@@ -171,7 +196,7 @@ template<typename T> double BinaryStreamReader::readSampleAs()
 
     _device->read((char*) &data, sizeof(data));
 
-    if (_settingsWidget.endianness() == LittleEndian)
+    if (endianness == LittleEndian)
     {
         data = qFromLittleEndian(data);
     }
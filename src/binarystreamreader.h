@@ -21,6 +21,7 @@
 #define BINARYSTREAMREADER_H
 
 #include <QSettings>
+#include <QVector>
 
 #include "abstractreader.h"
 #include "binarystreamreadersettings.h"
@@ -37,6 +38,7 @@ public:
     explicit BinaryStreamReader(QIODevice* device, QObject *parent = 0);
     QWidget* settingsWidget();
     unsigned numChannels() const;
+    NumberFormat numberFormat() const override;
     /// Stores settings into a `QSettings`
     void saveSettings(QSettings* settings);
     /// Loads settings from a `QSettings`.
@@ -45,9 +47,12 @@ public:
 private:
     BinaryStreamReaderSettings _settingsWidget;
     unsigned _numChannels;
+    NumberFormat _numberFormat;
+    Endianness endianness;      ///< copy of selection in settings widget
     unsigned sampleSize;
     bool skipByteRequested;
     bool skipSampleRequested;
+    QVector<double> decodeBuffer; ///< interleaved samples of last read
 
     /// points to the readSampleAs function for currently selected number format
     double (BinaryStreamReader::*readSample)();
@@ -41,6 +41,8 @@ BinaryStreamReaderSettings::BinaryStreamReaderSettings(QWidget *parent) :
 
     connect(ui->nfBox, SIGNAL(selectionChanged(NumberFormat)),
             this, SIGNAL(numberFormatChanged(NumberFormat)));
+    connect(ui->endiBox, SIGNAL(selectionChanged(Endianness)),
+            this, SIGNAL(endiannessChanged(Endianness)));
 
     connect(ui->pbSkipByte, SIGNAL(clicked()), this, SIGNAL(skipByteRequested()));
     connect(ui->pbSkipSample, SIGNAL(clicked()), this, SIGNAL(skipSampleRequested()));
@@ -50,6 +50,7 @@ public:
 signals:
     void numOfChannelsChanged(unsigned);
     void numberFormatChanged(NumberFormat);
+    void endiannessChanged(Endianness);
     void skipByteRequested();
     void skipSampleRequested();
 
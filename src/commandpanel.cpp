@@ -24,7 +24,7 @@
 #include "ui_commandpanel.h"
 #include "setting_defines.h"
 bool _offAutoSendRb;
-CommandPanel::CommandPanel(QSerialPort* port, QWidget *parent) :
+CommandPanel::CommandPanel(AsyncSerialPort* port, QWidget *parent) :
     QWidget(parent),
     ui(new Ui::CommandPanel),
     _menu(trUtf8("&Commands")), _newCommandAction(trUtf8("&New Command"), this)
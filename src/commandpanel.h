@@ -28,6 +28,7 @@
 #include <QAction>
 #include <QSettings>
 
+#include "asyncserialport.h"
 #include "commandwidget.h"
 extern bool _offAutoSendRb;
 namespace Ui {
@@ -39,9 +40,9 @@ class CommandPanel : public QWidget
     Q_OBJECT
 
 public:
-    explicit CommandPanel(QSerialPort* port, QWidget *parent = 0);
+    explicit CommandPanel(AsyncSerialPort* port, QWidget *parent = 0);
     ~CommandPanel();
-    QSerialPort* serialPort;
+    AsyncSerialPort* serialPort;
     QMenu* menu();
     /// Action for creating a new command.
     QAction* newCommandAction();
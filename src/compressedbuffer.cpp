@@ -0,0 +1,163 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+#include <algorithm>
+
+#include "compressedbuffer.h"
+#include "minmax.h"
+
+CompressedBuffer::CompressedBuffer(const FrameBuffer* source, unsigned start, unsigned n)
+{
+    Q_ASSERT(n > 0 && start + n <= source->size());
+
+    _size = n;
+    cache = nullptr;
+    cachedBlock = -1;
+
+    auto buffer = static_cast<double*>(allocPooled(sizeof(double) * BLOCK_SIZE,
+                                                   MemoryUser_Snapshots));
+    for (unsigned i = 0; i < n; i += BLOCK_SIZE)
+    {
+        unsigned len = std::min(BLOCK_SIZE, n - i);
+        source->copySamples(start + i, len, buffer);
+        addBlock(buffer, len);
+    }
+    freePooled(buffer, sizeof(double) * BLOCK_SIZE, MemoryUser_Snapshots);
+}
+
+CompressedBuffer::CompressedBuffer(const double* source, unsigned n)
+{
+    Q_ASSERT(source != nullptr && n > 0);
+
+    _size = n;
+    cache = nullptr;
+    cachedBlock = -1;
+
+    for (unsigned i = 0; i < n; i += BLOCK_SIZE)
+    {
+        addBlock(source + i, std::min(BLOCK_SIZE, n - i));
+    }
+}
+
+CompressedBuffer::~CompressedBuffer()
+{
+    for (auto& block : blocks)
+    {
+        releaseBlock(block, MemoryUser_Snapshots);
+    }
+    freeAligned(cache, sizeof(double) * BLOCK_SIZE, MemoryUser_Snapshots);
+}
+
+void CompressedBuffer::addBlock(const double* data, unsigned n)
+{
+    Range r = minMax(data, n);
+    _limits = blocks.isEmpty() ? r : combineLimits(_limits, r);
+    blockLimits.append(r);
+    blocks.append(compressBlock(data, n, MemoryUser_Snapshots));
+}
+
+const double* CompressedBuffer::decompressed(unsigned b) const
+{
+    if (cachedBlock != (int) b)
+    {
+        if (cache == nullptr)
+        {
+            cache = static_cast<double*>(allocAligned(sizeof(double) * BLOCK_SIZE,
+                                                      MemoryUser_Snapshots));
+        }
+        decompressBlock(blocks[b], cache);
+        cachedBlock = b;
+    }
+    return cache;
+}
+
+unsigned CompressedBuffer::size() const
+{
+    return _size;
+}
+
+double CompressedBuffer::sample(unsigned i) const
+{
+    Q_ASSERT(i < _size);
+
+    return decompressed(i / BLOCK_SIZE)[i % BLOCK_SIZE];
+}
+
+Range CompressedBuffer::limits() const
+{
+    return _limits;
+}
+
+Range CompressedBuffer::rangeLimits(unsigned start, unsigned n) const
+{
+    Q_ASSERT(n > 0 && start + n <= _size);
+
+    Range result = {0, 0};
+    unsigned end = start + n;
+    for (unsigned i = start; i < end;)
+    {
+        unsigned b = i / BLOCK_SIZE;
+        unsigned offset = i % BLOCK_SIZE;
+        unsigned len = std::min(blocks[b].numSamples - offset, end - i);
+
+        // only partially covered blocks are decompressed
+        Range r = len == blocks[b].numSamples ?
+            blockLimits[b] : minMax(decompressed(b) + offset, len);
+        result = i == start ? r : combineLimits(result, r);
+        i += len;
+    }
+    return result;
+}
+
+void CompressedBuffer::copySamples(unsigned start, unsigned n, double* out) const
+{
+    Q_ASSERT(start + n <= _size);
+
+    unsigned end = start + n;
+    for (unsigned i = start; i < end;)
+    {
+        unsigned b = i / BLOCK_SIZE;
+        unsigned offset = i % BLOCK_SIZE;
+        unsigned len = std::min(blocks[b].numSamples - offset, end - i);
+
+        if (len == blocks[b].numSamples && (int) b != cachedBlock)
+        {
+            // whole block is decompressed directly to output
+            decompressBlock(blocks[b], out);
+        }
+        else
+        {
+            const double* data = decompressed(b) + offset;
+            std::copy(data, data + len, out);
+        }
+        out += len;
+        i += len;
+    }
+}
+
+size_t CompressedBuffer::compressedSize() const
+{
+    size_t total = 0;
+    for (auto& block : blocks)
+    {
+        total += block.size;
+    }
+    return total;
+}
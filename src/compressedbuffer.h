@@ -0,0 +1,75 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPRESSEDBUFFER_H
+#define COMPRESSEDBUFFER_H
+
+#include <QVector>
+
+#include "framebuffer.h"
+#include "compression.h"
+
+/**
+ * A read only frame buffer that keeps its data compressed, used for
+ * storing snapshot data. See `compression.h`.
+ *
+ * Data is compressed in `BLOCK_SIZE` long blocks. Limits of each block
+ * are kept uncompressed, so that limits are calculated without
+ * decompression, except for partially covered blocks. Blocks are
+ * decompressed on demand, last decompressed block is cached.
+ */
+class CompressedBuffer : public FrameBuffer
+{
+public:
+    /// Number of samples in a block
+    static const unsigned BLOCK_SIZE = 4096;
+
+    /// Creates a buffer from a slice of the `source`. (start + n) should
+    /// be smaller or equal than `source->size()`.
+    CompressedBuffer(const FrameBuffer* source, unsigned start, unsigned n);
+    /// Creates a buffer with data copied from an array
+    CompressedBuffer(const double* source, unsigned n);
+    ~CompressedBuffer();
+
+    unsigned size() const override;
+    double sample(unsigned i) const override;
+    Range limits() const override;
+    Range rangeLimits(unsigned start, unsigned n) const override;
+    void copySamples(unsigned start, unsigned n, double* out) const override;
+
+    /// Returns size of compressed data in bytes
+    size_t compressedSize() const;
+
+private:
+    unsigned _size;
+    QVector<CompressedBlock> blocks;
+    QVector<Range> blockLimits;
+    Range _limits;
+
+    /// Decompressed data of `cachedBlock`, allocated at first use
+    mutable double* cache;
+    mutable int cachedBlock;      ///< -1 if cache is empty
+
+    /// Compresses a block and adds it
+    void addBlock(const double* data, unsigned n);
+    /// Returns decompressed data of block `b`
+    const double* decompressed(unsigned b) const;
+};
+
+#endif // COMPRESSEDBUFFER_H
@@ -0,0 +1,398 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+#include <string.h>
+
+#include "compression.h"
+
+/// Codec of a block, first byte of encoded data
+enum Codec : unsigned char
+{
+    Codec_Delta,    ///< zigzag varint of deltas
+    Codec_Xor32,    ///< XOR of `float`s
+    Codec_Xor64,    ///< XOR of `double`s
+    Codec_Raw32,    ///< raw `float`s
+    Codec_Raw64     ///< raw `double`s
+};
+
+/// Maximum size of any encoding of `n` samples (a varint is at most 10
+/// bytes, XOR of a double is at most 77 bits)
+static size_t maxEncodedSize(unsigned n)
+{
+    return 1 + 10 * (size_t) n + 8;
+}
+
+/// Writes bits to a byte array, most significant first.
+class BitWriter
+{
+public:
+    explicit BitWriter(unsigned char* out) : out(out), pos(0), acc(0), numBits(0) {}
+
+    /// Writes lowest `n` bits of `v`, `n` can be up to 64.
+    void write(uint64_t v, unsigned n)
+    {
+        if (n > 32)
+        {
+            write32(v >> 32, n - 32);
+            n = 32;
+        }
+        write32(v, n);
+    }
+
+    /// Writes remaining bits and returns number of bytes written.
+    size_t finish()
+    {
+        if (numBits) out[pos++] = (unsigned char) (acc << (8 - numBits));
+        numBits = 0;
+        return pos;
+    }
+
+private:
+    unsigned char* out;
+    size_t pos;
+    uint64_t acc;      ///< lowest `numBits` are pending
+    unsigned numBits;
+
+    void write32(uint64_t v, unsigned n)
+    {
+        if (n == 0) return;
+        acc = (acc << n) | (v & ((uint64_t(1) << n) - 1));
+        numBits += n;
+        while (numBits >= 8)
+        {
+            numBits -= 8;
+            out[pos++] = (unsigned char) (acc >> numBits);
+        }
+    }
+};
+
+/// Reads bits written by `BitWriter`.
+class BitReader
+{
+public:
+    explicit BitReader(const unsigned char* in) : in(in), pos(0), acc(0), numBits(0) {}
+
+    /// Reads `n` bits, `n` can be up to 64.
+    uint64_t read(unsigned n)
+    {
+        if (n > 32)
+        {
+            uint64_t high = read32(n - 32);
+            return (high << 32) | read32(32);
+        }
+        return read32(n);
+    }
+
+private:
+    const unsigned char* in;
+    size_t pos;
+    uint64_t acc;
+    unsigned numBits;
+
+    uint64_t read32(unsigned n)
+    {
+        if (n == 0) return 0;
+        while (numBits < n)
+        {
+            acc = (acc << 8) | in[pos++];
+            numBits += 8;
+        }
+        numBits -= n;
+        return (acc >> numBits) & ((uint64_t(1) << n) - 1);
+    }
+};
+
+static unsigned leadingZeros(uint64_t x, unsigned width)
+{
+    unsigned n = 0;
+    for (uint64_t bit = uint64_t(1) << (width - 1); !(x & bit); bit >>= 1) n++;
+    return n;
+}
+
+static unsigned trailingZeros(uint64_t x)
+{
+    unsigned n = 0;
+    for (; !(x & 1); x >>= 1) n++;
+    return n;
+}
+
+/// Encodes integer values as zigzag varints of deltas. Returns end of output.
+template <typename T>
+static unsigned char* encodeDelta(const T* data, unsigned n, unsigned char* out)
+{
+    int64_t prev = 0;
+    for (unsigned i = 0; i < n; i++)
+    {
+        int64_t v = (int64_t) data[i];
+        uint64_t d = (uint64_t) v - (uint64_t) prev;
+        uint64_t zz = (d << 1) ^ (uint64_t) ((int64_t) d >> 63);
+        while (zz >= 0x80)
+        {
+            *out++ = (unsigned char) (zz | 0x80);
+            zz >>= 7;
+        }
+        *out++ = (unsigned char) zz;
+        prev = v;
+    }
+    return out;
+}
+
+static void decodeDelta(const unsigned char* in, unsigned n, double* out)
+{
+    int64_t prev = 0;
+    for (unsigned i = 0; i < n; i++)
+    {
+        uint64_t zz = 0;
+        unsigned shift = 0;
+        unsigned char b;
+        do
+        {
+            b = *in++;
+            zz |= uint64_t(b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+
+        uint64_t d = (zz >> 1) ^ (~(zz & 1) + 1);
+        prev = (int64_t) ((uint64_t) prev + d);
+        out[i] = (double) prev;
+    }
+}
+
+/// Bits of a floating point type
+template <typename F> struct FloatBits;
+template <> struct FloatBits<float>  {typedef uint32_t U; static const unsigned lenBits = 5;};
+template <> struct FloatBits<double> {typedef uint64_t U; static const unsigned lenBits = 6;};
+
+/// Encodes floating point values with XOR compression. Returns number of bytes.
+template <typename F>
+static size_t encodeXor(const F* data, unsigned n, unsigned char* out)
+{
+    typedef typename FloatBits<F>::U U;
+    const unsigned width = sizeof(U) * 8;
+    const unsigned lenBits = FloatBits<F>::lenBits;
+
+    BitWriter writer(out);
+    U prev;
+    memcpy(&prev, &data[0], sizeof(U));
+    writer.write(prev, width);
+
+    unsigned prevLead = width + 1; // no window yet
+    unsigned prevTrail = 0;
+    for (unsigned i = 1; i < n; i++)
+    {
+        U cur;
+        memcpy(&cur, &data[i], sizeof(U));
+        U x = cur ^ prev;
+        prev = cur;
+
+        if (x == 0)
+        {
+            writer.write(0, 1);
+            continue;
+        }
+
+        unsigned lead = std::min(leadingZeros(x, width), 31u);
+        unsigned trail = trailingZeros(x);
+        if (prevLead <= width && lead >= prevLead && trail >= prevTrail)
+        {
+            // meaningful bits fit in previous window
+            writer.write(2, 2);
+            writer.write(x >> prevTrail, width - prevLead - prevTrail);
+        }
+        else
+        {
+            unsigned len = width - lead - trail;
+            writer.write(3, 2);
+            writer.write(lead, 5);
+            writer.write(len - 1, lenBits);
+            writer.write(x >> trail, len);
+            prevLead = lead;
+            prevTrail = trail;
+        }
+    }
+    return writer.finish();
+}
+
+template <typename F>
+static void decodeXor(const unsigned char* in, unsigned n, double* out)
+{
+    typedef typename FloatBits<F>::U U;
+    const unsigned width = sizeof(U) * 8;
+    const unsigned lenBits = FloatBits<F>::lenBits;
+
+    BitReader reader(in);
+    U prev = (U) reader.read(width);
+    F f;
+    memcpy(&f, &prev, sizeof(U));
+    out[0] = f;
+
+    unsigned lead = 0, len = width;
+    for (unsigned i = 1; i < n; i++)
+    {
+        if (reader.read(1))
+        {
+            if (reader.read(1))
+            {
+                lead = reader.read(5);
+                len = reader.read(lenBits) + 1;
+            }
+            U x = (U) reader.read(len) << (width - lead - len);
+            prev ^= x;
+        }
+        memcpy(&f, &prev, sizeof(U));
+        out[i] = f;
+    }
+}
+
+/// Returns true if all values can be stored as integers without loss.
+template <typename T>
+static bool isIntegral(const T* data, unsigned n)
+{
+    if (std::numeric_limits<T>::is_integer) return true;
+
+    const double maxExact = 9007199254740992.0; // 2^53
+    for (unsigned i = 0; i < n; i++)
+    {
+        double v = data[i];
+        if (!(std::fabs(v) < maxExact) || v != std::floor(v) ||
+            (v == 0 && std::signbit(v))) return false;
+    }
+    return true;
+}
+
+/// Encodes non integral floating point data. Returns encoded size.
+template <typename T>
+static size_t encodeFloat(const T* data, unsigned n, unsigned char* out)
+{
+    // not reached for integer types, see `compressBlock`
+    Q_UNUSED(data); Q_UNUSED(n); Q_UNUSED(out);
+    return 0;
+}
+
+template <>
+size_t encodeFloat(const float* data, unsigned n, unsigned char* out)
+{
+    size_t size = encodeXor(data, n, out + 1);
+    if (size < sizeof(float) * n)
+    {
+        out[0] = Codec_Xor32;
+        return 1 + size;
+    }
+    out[0] = Codec_Raw32;
+    memcpy(out + 1, data, sizeof(float) * n);
+    return 1 + sizeof(float) * n;
+}
+
+template <>
+size_t encodeFloat(const double* data, unsigned n, unsigned char* out)
+{
+    size_t size = encodeXor(data, n, out + 1);
+    if (size < sizeof(double) * n)
+    {
+        out[0] = Codec_Xor64;
+        return 1 + size;
+    }
+    out[0] = Codec_Raw64;
+    memcpy(out + 1, data, sizeof(double) * n);
+    return 1 + sizeof(double) * n;
+}
+
+template <typename T>
+CompressedBlock compressBlock(const T* data, unsigned n, MemoryUser user)
+{
+    Q_ASSERT(n > 0);
+
+    size_t maxSize = maxEncodedSize(n);
+    auto buffer = static_cast<unsigned char*>(allocPooled(maxSize, MemoryUser_Packs));
+
+    size_t size;
+    if (isIntegral(data, n))
+    {
+        buffer[0] = Codec_Delta;
+        size = encodeDelta(data, n, buffer + 1) - buffer;
+    }
+    else
+    {
+        size = encodeFloat(data, n, buffer);
+    }
+    Q_ASSERT(size <= maxSize);
+
+    CompressedBlock block;
+    block.data = static_cast<unsigned char*>(allocAligned(size, user));
+    block.size = size;
+    block.numSamples = n;
+    memcpy(block.data, buffer, size);
+
+    freePooled(buffer, maxSize, MemoryUser_Packs);
+    return block;
+}
+
+void decompressBlock(const CompressedBlock& block, double* out)
+{
+    Q_ASSERT(block.data != nullptr);
+
+    const unsigned char* in = block.data + 1;
+    unsigned n = block.numSamples;
+    switch (block.data[0])
+    {
+        case Codec_Delta:
+            decodeDelta(in, n, out);
+            break;
+        case Codec_Xor32:
+            decodeXor<float>(in, n, out);
+            break;
+        case Codec_Xor64:
+            decodeXor<double>(in, n, out);
+            break;
+        case Codec_Raw32:
+            for (unsigned i = 0; i < n; i++)
+            {
+                float f;
+                memcpy(&f, in + i * sizeof(float), sizeof(float));
+                out[i] = f;
+            }
+            break;
+        case Codec_Raw64:
+            memcpy(out, in, sizeof(double) * n);
+            break;
+        default:
+            Q_ASSERT(false);
+    }
+}
+
+void releaseBlock(CompressedBlock& block, MemoryUser user)
+{
+    freeAligned(block.data, block.size, user);
+    block.data = nullptr;
+    block.size = 0;
+}
+
+template CompressedBlock compressBlock(const quint8* data, unsigned n, MemoryUser user);
+template CompressedBlock compressBlock(const quint16* data, unsigned n, MemoryUser user);
+template CompressedBlock compressBlock(const quint32* data, unsigned n, MemoryUser user);
+template CompressedBlock compressBlock(const qint8* data, unsigned n, MemoryUser user);
+template CompressedBlock compressBlock(const qint16* data, unsigned n, MemoryUser user);
+template CompressedBlock compressBlock(const qint32* data, unsigned n, MemoryUser user);
+template CompressedBlock compressBlock(const float* data, unsigned n, MemoryUser user);
+template CompressedBlock compressBlock(const double* data, unsigned n, MemoryUser user);
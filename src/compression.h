@@ -0,0 +1,65 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <stddef.h>
+
+#include "allocator.h"
+
+/**
+ * @file compression.h
+ *
+ * Lossless compression of sample blocks, for data that is kept in memory
+ * for a long time (snapshots).
+ *
+ * Codec is selected per block:
+ *
+ * - Integer samples (and floating point samples that are all integers,
+ *   which is common for ADC data) are stored as delta from previous sample,
+ *   zigzag encoded to a varint. Slowly changing data takes 1 byte per sample.
+ *
+ * - Other floating point samples are XOR'ed with the previous sample and
+ *   only the meaningful bits are stored (as in Facebook's Gorilla). If this
+ *   doesn't help, block is stored raw.
+ *
+ * A block is decoded as a whole, so blocks should be small enough to be
+ * decoded on demand.
+ */
+
+/// A compressed block of samples
+struct CompressedBlock
+{
+    unsigned char* data;  ///< encoded data, `nullptr` if empty
+    size_t size;          ///< size of `data` in bytes
+    unsigned numSamples;
+};
+
+/// Compresses `n` samples. Memory is accounted to `user`.
+template <typename T>
+CompressedBlock compressBlock(const T* data, unsigned n, MemoryUser user);
+
+/// Decompresses all samples of `block` to `out`.
+void decompressBlock(const CompressedBlock& block, double* out);
+
+/// Frees memory of a block that is returned by `compressBlock()`.
+void releaseBlock(CompressedBlock& block, MemoryUser user);
+
+#endif // COMPRESSION_H
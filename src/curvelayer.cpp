@@ -0,0 +1,103 @@
+/*
+  Copyright © 2022 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "curvelayer.h"
+
+/// Shifts that are this close to a whole number of pixels are exact enough
+static const double SHIFT_TOLERANCE = 1e-3;
+
+CurveLayer::CurveLayer()
+{
+    valid = false;
+}
+
+const QImage& CurveLayer::image() const
+{
+    return _image;
+}
+
+bool CurveLayer::isValid() const
+{
+    return valid;
+}
+
+void CurveLayer::invalidate(bool release)
+{
+    valid = false;
+    if (release) _image = QImage();
+}
+
+void CurveLayer::redraw(const QSize& size, qreal dpr, DrawFunc draw)
+{
+    if (_image.size() != size)
+    {
+        _image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    }
+    _image.setDevicePixelRatio(dpr);
+    valid = true;
+    redrawColumns(0, size.width(), draw);
+}
+
+bool CurveLayer::scroll(double dx, int margin, DrawFunc draw)
+{
+    Q_ASSERT(valid);
+
+    int shift = lround(dx);
+    int width = _image.width();
+    if (std::abs(dx - shift) > SHIFT_TOLERANCE || shift < 0 || shift >= width)
+    {
+        return false;
+    }
+
+    if (shift > 0)
+    {
+        for (int y = 0; y < _image.height(); y++)
+        {
+            auto line = reinterpret_cast<quint32*>(_image.scanLine(y));
+            memmove(line, line + shift, (width - shift) * sizeof(quint32));
+        }
+    }
+
+    // newest samples are drawn even if there is no shift
+    redrawColumns(width - shift - margin, width, draw);
+    return true;
+}
+
+void CurveLayer::redrawColumns(int start, int end, DrawFunc draw)
+{
+    start = std::max(0, start);
+    end = std::min(_image.width(), end);
+    if (start >= end) return;
+
+    for (int y = 0; y < _image.height(); y++)
+    {
+        auto line = reinterpret_cast<quint32*>(_image.scanLine(y));
+        memset(line + start, 0, (end - start) * sizeof(quint32));
+    }
+
+    qreal dpr = _image.devicePixelRatio();
+    QRectF clip(start / dpr, 0, (end - start) / dpr, _image.height() / dpr);
+    QPainter painter(&_image);
+    painter.setClipRect(clip);
+    draw(&painter, clip);
+}
@@ -0,0 +1,71 @@
+/*
+  Copyright © 2022 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CURVELAYER_H
+#define CURVELAYER_H
+
+#include <functional>
+#include <QImage>
+#include <QPainter>
+#include <QRectF>
+#include <QSize>
+
+/**
+ * An image of curves on transparent background that can be updated
+ * partially.
+ *
+ * When data scrolls, image is shifted and only the exposed columns are
+ * redrawn. An image can only be shifted exactly by whole pixels, after
+ * any other distance old columns would be off by a fraction of a pixel
+ * from a full redraw. So `scroll()` refuses those and layer must be
+ * redrawn fully.
+ */
+class CurveLayer
+{
+public:
+    /// Draws curves with `painter` in `clip`, which is in logical
+    /// coordinates of the layer. Painter is clipped to it.
+    typedef std::function<void(QPainter* painter, const QRectF& clip)> DrawFunc;
+
+    CurveLayer();
+
+    const QImage& image() const;
+    /// Returns false if layer must be redrawn fully
+    bool isValid() const;
+    /// Marks layer to be redrawn fully, image is freed if `release`
+    void invalidate(bool release = false);
+
+    /// Clears the layer and draws all of it, `size` is in device pixels
+    void redraw(const QSize& size, qreal dpr, DrawFunc draw);
+    /**
+     * Shifts the image left by `dx` device pixels and redraws the
+     * exposed columns and `margin` columns before them. Returns false
+     * without changing anything if `dx` isn't a whole number of pixels
+     * or it's out of the image.
+     */
+    bool scroll(double dx, int margin, DrawFunc draw);
+    /// Clears and redraws columns [start, end), in device pixels
+    void redrawColumns(int start, int end, DrawFunc draw);
+
+private:
+    QImage _image;
+    bool valid;
+};
+
+#endif // CURVELAYER_H
@@ -21,30 +21,40 @@
 #include "ui_dataformatpanel.h"
 
 #include <QRadioButton>
+#include <QThread>
 #include <QtDebug>
 
 #include "utils.h"
 #include "setting_defines.h"
 
-DataFormatPanel::DataFormatPanel(QSerialPort* port, QWidget *parent) :
+DataFormatPanel::DataFormatPanel(AsyncSerialPort* port, QWidget *parent) :
     QWidget(parent),
     ui(new Ui::DataFormatPanel),
-    bsReader(port, this),
-    asciiReader(port, this),
-    framedReader(port, this),
-    osReader(port,this),
+    bsReader(port),
+    asciiReader(port),
+    framedReader(port),
+    osReader(port),
     demoReader(port, this)
 {
     ui->setupUi(this);
 
     serialPort = port;
+    sink = nullptr;
     paused = false;
     readerBeforeDemo = nullptr;
     _bytesRead = 0;
 
+    // port readers decode data in I/O thread as it arrives, demo reader
+    // stays in GUI thread with its timer
+    portReaders << &bsReader << &asciiReader << &framedReader << &osReader;
+    for (auto reader : portReaders)
+    {
+        reader->moveToThread(port->ioThread());
+    }
+
     // initalize default reader
     currentReader = &bsReader;
-    bsReader.enable();
+    bsReader.runInReaderThread([this]() {bsReader.enable();});
     ui->rbBinary->setChecked(true);
     ui->horizontalLayout->addWidget(bsReader.settingsWidget(), 1);
 
@@ -76,12 +86,22 @@ DataFormatPanel::DataFormatPanel(QSerialPort* port, QWidget *parent) :
 
 DataFormatPanel::~DataFormatPanel()
 {
+    // readers are destroyed in this thread, stop and take them back
+    currentReader->runInReaderThread([this]() {currentReader->enable(false);});
+    QThread* guiThread = thread();
+    for (auto reader : portReaders)
+    {
+        reader->runInReaderThread([reader, guiThread]() {reader->moveToThread(guiThread);});
+    }
+
     delete ui;
 }
 
 unsigned DataFormatPanel::numChannels() const
 {
-    return currentReader->numChannels();
+    unsigned nc;
+    currentReader->runInReaderThread([this, &nc]() {nc = currentReader->numChannels();});
+    return nc;
 }
 
 Source* DataFormatPanel::activeSource()
@@ -89,10 +109,16 @@ Source* DataFormatPanel::activeSource()
     return currentReader;
 }
 
+void DataFormatPanel::setSink(Sink* s)
+{
+    sink = s;
+    currentReader->runInReaderThread([this]() {currentReader->connectSink(sink);});
+}
+
 void DataFormatPanel::pause(bool enabled)
 {
     paused = enabled;
-    currentReader->pause(enabled);
+    currentReader->runInReaderThread([this, enabled]() {currentReader->pause(enabled);});
     demoReader.pause(enabled);
 }
 
@@ -101,7 +127,7 @@ void DataFormatPanel::enableDemo(bool demoEnabled)
     if (demoEnabled)
     {
         readerBeforeDemo = currentReader;
-        demoReader.setNumChannels(readerBeforeDemo->numChannels());
+        demoReader.setNumChannels(numChannels());
         selectReader(&demoReader);
     }
     else
@@ -124,8 +150,16 @@ bool DataFormatPanel::isDemoEnabled() const
 
 void DataFormatPanel::selectReader(AbstractReader* reader)
 {
-    currentReader->enable(false);
-    reader->enable();
+    // old reader lets go of the sink before new one takes it, each in
+    // its own thread
+    AbstractReader* prevReader = currentReader;
+    prevReader->runInReaderThread([prevReader]() {prevReader->enable(false);});
+    reader->runInReaderThread([this, reader]()
+                              {
+                                  if (sink != nullptr) reader->connectSink(sink);
+                                  reader->pause(paused);
+                                  reader->enable();
+                              });
 
     // re-connect signals
     disconnect(currentReader, 0, this, 0);
@@ -136,8 +170,6 @@ void DataFormatPanel::selectReader(AbstractReader* reader)
     ui->horizontalLayout->addWidget(reader->settingsWidget(), 1);
     reader->settingsWidget()->show();
 
-    reader->pause(paused);
-
     currentReader = reader;
     emit sourceChanged(currentReader);
 }
@@ -29,6 +29,7 @@
 #include <QtGlobal>
 #include <QButtonGroup>
 
+#include "asyncserialport.h"
 #include "binarystreamreader.h"
 #include "omitstreamreader.h"
 #include "asciireader.h"
@@ -45,13 +46,16 @@ class DataFormatPanel : public QWidget
     Q_OBJECT
 
 public:
-    explicit DataFormatPanel(QSerialPort* port, QWidget* parent = 0);
+    explicit DataFormatPanel(AsyncSerialPort* port, QWidget* parent = 0);
     ~DataFormatPanel();
 
     /// Returns currently selected number of channels
     unsigned numChannels() const;
     /// Returns active source (reader)
     Source* activeSource();
+    /// Sets the sink that active reader feeds. Reader is connected to
+    /// it in its own thread.
+    void setSink(Sink* sink);
     /// Returns total number of bytes read
     uint64_t bytesRead();
     /// Stores data format panel settings into a `QSettings`
@@ -71,12 +75,15 @@ private:
     Ui::DataFormatPanel *ui;
     QButtonGroup readerSelectButtons;
 
-    QSerialPort* serialPort;
+    AsyncSerialPort* serialPort;
+    Sink* sink;                 ///< connected to active reader
 
     BinaryStreamReader bsReader;
     AsciiReader asciiReader;
     FramedReader framedReader;
     OmitStreamReader osReader;
+    /// Readers of the serial port, they live in its I/O thread
+    QList<AbstractReader*> portReaders;
 
     /// Currently selected reader
     AbstractReader* currentReader;
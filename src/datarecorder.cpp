@@ -32,13 +32,15 @@ DataRecorder::DataRecorder(QObject *parent) :
     disableBuffering = false;
     windowsLE = false;
     timestampOpt = TimestampOption::disabled;
+    _decimals = fileStream.realNumberPrecision();
 
     fileStream.setRealNumberNotation(QTextStream::FixedNotation);
 }
 
 void DataRecorder::setDecimals(unsigned decimals)
 {
-    fileStream.setRealNumberPrecision(decimals);
+    // stream may be in use by a worker thread
+    _decimals = decimals;
 }
 
 bool DataRecorder::startRecording(QString fileName, QString separator,
@@ -81,7 +83,7 @@ bool DataRecorder::startRecording(QString fileName, QString separator,
     return true;
 }
 
-void DataRecorder::feedIn(const SamplePack& data)
+void DataRecorder::feedIn(const SamplePackView& data)
 {
     Q_ASSERT(file.isOpen());    // recorder should be disconnected before stopping recording
     Q_ASSERT(!data.hasX());     // NYI
@@ -97,6 +99,7 @@ void DataRecorder::feedIn(const SamplePack& data)
     lastNumChannels = numChannels;
 
     // write data
+    fileStream.setRealNumberPrecision(_decimals);
     unsigned numSamples = data.numSamples();
     for (unsigned int i = 0; i < numSamples; i++)
     {
@@ -106,7 +109,7 @@ void DataRecorder::feedIn(const SamplePack& data)
         }
         for (unsigned ci = 0; ci < numChannels; ci++)
         {
-            fileStream << data.data(ci)[i];
+            fileStream << data.sample(ci, i);
             if (ci != numChannels-1) fileStream << _sep;
         }
         fileStream << le();
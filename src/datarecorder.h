@@ -20,6 +20,7 @@
 #ifndef DATARECORDER_H
 #define DATARECORDER_H
 
+#include <atomic>
 #include <QObject>
 #include <QFile>
 #include <QTextStream>
@@ -44,7 +45,7 @@ public:
     explicit DataRecorder(QObject *parent = 0);
 
     /// Disables file buffering
-    bool disableBuffering;
+    std::atomic<bool> disableBuffering;
 
     /**
      * Use CR+LF as line ending. `false` by default.
@@ -55,10 +56,14 @@ public:
     bool windowsLE;
 
     /**
-     * Set floating point number precision.
+     * Set floating point number precision. Applied starting with next
+     * incoming data.
      */
     void setDecimals(unsigned decimals);
 
+    /// Only touches the file, can be fed from a `SinkPool`
+    bool isThreadSafe() const override {return true;};
+
     /**
      * @brief Starts recording data to a file in CSV format.
      *
@@ -97,10 +102,11 @@ public:
     void stopRecording();
 
 protected:
-    virtual void feedIn(const SamplePack& data);
+    virtual void feedIn(const SamplePackView& data);
 
 private:
     unsigned lastNumChannels;   ///< used for error message only
+    std::atomic<unsigned> _decimals; ///< applied to `fileStream` in `feedIn`
     QFile file;
     QTextStream fileStream;
     QString _sep;
@@ -32,7 +32,7 @@ public:
     }
 
 protected:
-    virtual void feedIn(const SamplePack& data) override
+    virtual void feedIn(const SamplePackView& data) override
     {
         _textView->addData(data);
     };
@@ -77,14 +77,14 @@ DataTextView::~DataTextView()
     delete ui;
 }
 
-void DataTextView::addData(const SamplePack& data)
+void DataTextView::addData(const SamplePackView& data)
 {
     for (unsigned int i = 0; i < data.numSamples(); i++)
     {
         QString str;
         for (unsigned ci = 0; ci < data.numChannels(); ci++)
         {
-            str += QString::number(data.data(ci)[i], 'f', ui->spDecimals->value());
+            str += QString::number(data.sample(ci, i), 'f', ui->spDecimals->value());
             if (ci != data.numChannels()-1) str += " ";
         }
         ui->textView->appendPlainText(str);
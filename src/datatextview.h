@@ -44,7 +44,7 @@ public:
     void loadSettings(QSettings* settings);
 
 protected:
-    void addData(const SamplePack& data);
+    void addData(const SamplePackView& data);
 
     friend DataTextViewSink;
 
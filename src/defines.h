@@ -27,4 +27,12 @@ const char UPDATES_INFO_URL[] = "https://serialplot.ozderya.net/downloads/update
 /// Maximum number of channels that can be set by user
 const unsigned MAX_NUM_CHANNELS = 64;
 
+/// Maximum number of packs that wait to be plotted, the oldest is
+/// dropped when it's exceeded
+const unsigned PACK_QUEUE_SIZE = 16384;
+
+/// Maximum number of packs that wait for a parallel sink, data source
+/// waits for the sink when it's exceeded
+const unsigned SINK_POOL_DEPTH = 4096;
+
 #endif  // DEFINES_H
@@ -40,6 +40,30 @@ public:
     virtual double sample(unsigned i) const = 0;
     /// Returns minimum and maximum of the buffer values.
     virtual Range limits() const = 0;
+    /// Returns minimum and maximum of `n` samples starting from
+    /// `start`. Default implementation reads all samples, buffers
+    /// should re-implement this if they can do better.
+    virtual Range rangeLimits(unsigned start, unsigned n) const
+    {
+        Range r = {sample(start), sample(start)};
+        for (unsigned i = start+1; i < start+n; i++)
+        {
+            double v = sample(i);
+            if (v < r.start) r.start = v;
+            if (v > r.end) r.end = v;
+        }
+        return r;
+    }
+    /// Copies `n` samples starting from `start` to `out`. Default
+    /// implementation reads samples one by one, buffers should
+    /// re-implement this if they can do better.
+    virtual void copySamples(unsigned start, unsigned n, double* out) const
+    {
+        for (unsigned i = 0; i < n; i++)
+        {
+            out[i] = sample(start + i);
+        }
+    }
 };
 
 /// Common base class for index and writable frame buffers
@@ -55,8 +79,9 @@ public:
 /// Abstract base class for writable frame buffers
 class WFrameBuffer : public ResizableBuffer
 {
+public:
     /// Add samples to the buffer
-    virtual void addSamples(double* samples, unsigned n) = 0;
+    virtual void addSamples(const double* samples, unsigned n) = 0;
     /// Reset all data to 0
     virtual void clear() = 0;
 };
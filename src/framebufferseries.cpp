@@ -18,15 +18,28 @@
 */
 
 #include <math.h>
+#include <algorithm>
 #include "framebufferseries.h"
 
+/// Series is decimated when there are more samples than this many per pixel
+/// column. Note that decimation results in 4 samples per column.
+static const unsigned DECIMATION_RATIO = 4;
+
 FrameBufferSeries::FrameBufferSeries(const XFrameBuffer* x, const FrameBuffer* y)
 {
     _x = x;
     _y = y;
 
     int_index_start = 0;
-    int_index_end = _y->size();
+    int_index_end = _y->size() - 1;
+
+    hasVisibleRange = false;
+    visibleStart = 0;
+    visibleEnd = 0;
+
+    _resolution = 0;
+    usePoints = false;
+    decimated = false;
 }
 
 void FrameBufferSeries::setX(const XFrameBuffer* x)
@@ -34,13 +47,49 @@ void FrameBufferSeries::setX(const XFrameBuffer* x)
     _x = x;
 }
 
+void FrameBufferSeries::setY(const FrameBuffer* y)
+{
+    _y = y;
+}
+
+void FrameBufferSeries::setResolution(unsigned width)
+{
+    _resolution = width;
+}
+
+void FrameBufferSeries::setVisibleRange(double xStart, double xEnd)
+{
+    hasVisibleRange = true;
+    visibleStart = xStart;
+    visibleEnd = xEnd;
+}
+
+void FrameBufferSeries::clearVisibleRange()
+{
+    hasVisibleRange = false;
+}
+
+bool FrameBufferSeries::isDecimated() const
+{
+    return decimated;
+}
+
 size_t FrameBufferSeries::size() const
 {
+    if (usePoints)
+    {
+        return points.size();
+    }
     return int_index_end - int_index_start + 1;
 }
 
 QPointF FrameBufferSeries::sample(size_t i) const
 {
+    if (usePoints)
+    {
+        return points[i];
+    }
+
     i += int_index_start;
     return QPointF(_x->sample(i), _y->sample(i));
 }
@@ -48,8 +97,18 @@ QPointF FrameBufferSeries::sample(size_t i) const
 QRectF FrameBufferSeries::boundingRect() const
 {
     QRectF rect;
-    auto yLim = _y->limits();
     auto xLim = _x->limits();
+    Range yLim;
+    if (hasVisibleRange)
+    {
+        int start, end;
+        findIndexRange(visibleStart, visibleEnd, start, end);
+        yLim = _y->rangeLimits(start, end - start + 1);
+    }
+    else
+    {
+        yLim = _y->limits();
+    }
     rect.setBottom(yLim.start);
     rect.setTop(yLim.end);
     rect.setLeft(xLim.start);
@@ -58,26 +117,116 @@ QRectF FrameBufferSeries::boundingRect() const
     return rect.normalized();
 }
 
+void FrameBufferSeries::findIndexRange(double xStart, double xEnd, int& start, int& end) const
+{
+    start = _x->findIndex(xStart);
+    end = _x->findIndex(xEnd);
+
+    // when out of range, check which side of the data range is at
+    auto xLim = _x->limits();
+    if (start == XFrameBuffer::OUT_OF_RANGE)
+    {
+        start = xStart > xLim.end ? _x->size()-1 : 0;
+    }
+    else if (start > 0)
+    {
+        start -= 1;
+    }
+
+    if (end == XFrameBuffer::OUT_OF_RANGE)
+    {
+        end = xEnd < xLim.start ? 0 : _x->size()-1;
+    }
+    else if (end < (int)_x->size()-1)
+    {
+        end += 1;
+    }
+}
+
 void FrameBufferSeries::setRectOfInterest(const QRectF& rect)
 {
-    int_index_start = _x->findIndex(rect.left());
-    int_index_end = _x->findIndex(rect.right());
+    findIndexRange(rect.left(), rect.right(), int_index_start, int_index_end);
 
-    if (int_index_start == XFrameBuffer::OUT_OF_RANGE)
+    unsigned numPoints = int_index_end - int_index_start + 1;
+    usePoints = _resolution > 0;
+    decimated = usePoints && numPoints > DECIMATION_RATIO * _resolution;
+    if (!usePoints)
     {
-        int_index_start = 0;
+        points.clear();
     }
-    else if (int_index_start > 0)
+    else if (decimated)
     {
-        int_index_start -= 1;
+        decimate(rect.left(), rect.right());
     }
+    else
+    {
+        copyPoints();
+    }
+}
 
-    if (int_index_end == XFrameBuffer::OUT_OF_RANGE)
+void FrameBufferSeries::copyPoints()
+{
+    unsigned n = int_index_end - int_index_start + 1;
+    QVector<double> xs(n);
+    QVector<double> ys(n);
+    _x->copySamples(int_index_start, n, xs.data());
+    _y->copySamples(int_index_start, n, ys.data());
+
+    points.resize(n);
+    for (unsigned i = 0; i < n; i++)
     {
-        int_index_end = _x->size()-1;
+        points[i] = QPointF(xs[i], ys[i]);
     }
-    else if (int_index_end < (int)_x->size()-1)
+}
+
+void FrameBufferSeries::decimate(double xStart, double xEnd)
+{
+    points.clear();
+    points.reserve(DECIMATION_RATIO * _resolution);
+
+    // boundary values are clamped so that `findIndex` never fails
+    auto xLim = _x->limits();
+    double colWidth = (xEnd - xStart) / _resolution;
+
+    int prevEnd = int_index_start - 1; // last index of previous column
+    for (unsigned c = 0; c < _resolution; c++)
     {
-        int_index_end += 1;
+        // find the last sample of this column
+        int end;
+        if (c == _resolution - 1)
+        {
+            end = int_index_end;
+        }
+        else
+        {
+            double colEnd = xStart + (c + 1) * colWidth;
+            colEnd = std::min(std::max(colEnd, xLim.start), xLim.end);
+            end = std::min(std::max(_x->findIndex(colEnd), prevEnd), int_index_end);
+        }
+
+        int start = prevEnd + 1;
+        prevEnd = end;
+
+        int n = end - start + 1;
+        if (n <= 0) continue;   // empty column
+
+        if (n <= (int) DECIMATION_RATIO)
+        {
+            for (int i = start; i <= end; i++)
+            {
+                points.append(QPointF(_x->sample(i), _y->sample(i)));
+            }
+        }
+        else
+        {
+            // first and last samples keep the lines between columns exact,
+            // min and max cover everything in between
+            double x = _x->sample(start);
+            auto lim = _y->rangeLimits(start, n);
+            points.append(QPointF(x, _y->sample(start)));
+            points.append(QPointF(x, lim.start));
+            points.append(QPointF(x, lim.end));
+            points.append(QPointF(_x->sample(end), _y->sample(end)));
+        }
     }
 }
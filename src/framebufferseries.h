@@ -22,6 +22,7 @@
 
 #include <QPointF>
 #include <QRectF>
+#include <QVector>
 #include <qwt_series_data.h>
 
 #include "framebuffer.h"
@@ -31,6 +32,19 @@
  * object. That way we can keep our data structures relatively
  * isolated from Qwt. Otherwise QwtPlotCurve owns FrameBuffer
  * structures.
+ *
+ * When there are a lot more samples in the rectangle of interest than
+ * pixels to draw them on, series is decimated. For each pixel column
+ * only first, last, minimum and maximum samples are returned, which
+ * results in the same drawing as full resolution. Decimation is
+ * enabled by setting a resolution with `setResolution()`. Minimum and
+ * maximum are read with `FrameBuffer::rangeLimits()` for each column,
+ * buffers that keep data at multiple resolutions (`TieredHistory`)
+ * use the length of column to select the resolution.
+ *
+ * When resolution is set, samples of "rectangle of interest" are
+ * copied in bulk when it's set, instead of reading them one by one
+ * while drawing.
  */
 class FrameBufferSeries : public QwtSeriesData<QPointF>
 {
@@ -38,6 +52,20 @@ public:
     FrameBufferSeries(const XFrameBuffer* x, const FrameBuffer* y);
 
     void setX(const XFrameBuffer* x);
+    void setY(const FrameBuffer* y);
+
+    /// Sets the number of pixel columns that series is drawn on. Decimation
+    /// is disabled if set to 0 (default).
+    void setResolution(unsigned width);
+
+    /// Makes `boundingRect()` report Y limits of samples in X range
+    /// [xStart, xEnd] only, so that autoscale fits the visible part.
+    void setVisibleRange(double xStart, double xEnd);
+    /// Makes `boundingRect()` report limits of all samples (default).
+    void clearVisibleRange();
+
+    /// Returns true if samples of "rectangle of interest" are decimated
+    bool isDecimated() const;
 
     // QwtSeriesData implementations
     size_t size() const;
@@ -51,6 +79,26 @@ private:
 
     int int_index_start; ///< starting index of "rectangle of interest"
     int int_index_end;   ///< ending index of "rectangle of interest"
+
+    bool hasVisibleRange;        ///< `visibleStart` and `visibleEnd` are set
+    double visibleStart, visibleEnd;
+
+    unsigned _resolution;        ///< number of pixel columns, 0 if unknown
+    bool usePoints;              ///< `points` is in use
+    bool decimated;              ///< `points` are decimated samples
+    QVector<QPointF> points;     ///< copied or decimated samples of "rectangle of interest"
+
+    /**
+     * Finds indexes of samples for X range [xStart, xEnd]. One more
+     * sample on each side is included if available, so that lines to
+     * outside samples are drawn. When range is out of data, index of
+     * the closest sample is returned.
+     */
+    void findIndexRange(double xStart, double xEnd, int& start, int& end) const;
+    /// Fills `points` with decimated samples for X range [xStart, xEnd]
+    void decimate(double xStart, double xEnd);
+    /// Fills `points` with all samples of "rectangle of interest"
+    void copyPoints();
 };
 
 #endif // FRAMEBUFFERSERIES_H
@@ -19,6 +19,7 @@
 
 #include <QtDebug>
 #include <QtEndian>
+#include <QMetaObject>
 #include "byteswap.h"
 
 #include "framedreader.h"
@@ -36,28 +37,54 @@ FramedReader::FramedReader(QIODevice* device, QObject* parent) :
     frameSize = _settingsWidget.fixedFrameSize();
     syncWord = _settingsWidget.syncWord();
     checksumEnabled = _settingsWidget.isChecksumEnabled();
+    endianness = _settingsWidget.endianness();
     onNumberFormatChanged(_settingsWidget.numberFormat());
     debugModeEnabled = _settingsWidget.isDebugModeEnabled();
     checkSettings();
 
-    // init setting connections
+    // init setting connections, settings are applied in reader thread
+    // (see `AbstractReader`)
     connect(&_settingsWidget, &FramedReaderSettings::numberFormatChanged,
-            this, &FramedReader::onNumberFormatChanged);
+            [this](NumberFormat nf)
+            {
+                runInReaderThread([this, nf]() {onNumberFormatChanged(nf);});
+            });
+
+    connect(&_settingsWidget, &FramedReaderSettings::endiannessChanged,
+            [this](Endianness e)
+            {
+                runInReaderThread([this, e]() {endianness = e;});
+            });
 
     connect(&_settingsWidget, &FramedReaderSettings::numOfChannelsChanged,
-            this, &FramedReader::onNumOfChannelsChanged);
+            [this](unsigned value)
+            {
+                runInReaderThread([this, value]() {onNumOfChannelsChanged(value);});
+            });
 
     connect(&_settingsWidget, &FramedReaderSettings::syncWordChanged,
-            this, &FramedReader::onSyncWordChanged);
+            [this](QByteArray word)
+            {
+                runInReaderThread([this, word]() {onSyncWordChanged(word);});
+            });
 
     connect(&_settingsWidget, &FramedReaderSettings::sizeFieldChanged,
-            this, &FramedReader::onSizeFieldChanged);
+            [this](FramedReaderSettings::SizeFieldType type, unsigned size)
+            {
+                runInReaderThread([this, type, size]() {onSizeFieldChanged(type, size);});
+            });
 
     connect(&_settingsWidget, &FramedReaderSettings::checksumChanged,
-            [this](bool enabled){checksumEnabled = enabled; reset();});
+            [this](bool enabled)
+            {
+                runInReaderThread([this, enabled]() {checksumEnabled = enabled; reset();});
+            });
 
     connect(&_settingsWidget, &FramedReaderSettings::debugModeChanged,
-            [this](bool enabled){debugModeEnabled = enabled;});
+            [this](bool enabled)
+            {
+                runInReaderThread([this, enabled]() {debugModeEnabled = enabled;});
+            });
 
     // init reader state
     reset();
@@ -73,8 +100,14 @@ unsigned FramedReader::numChannels() const
     return _numChannels;
 }
 
+NumberFormat FramedReader::numberFormat() const
+{
+    return _numberFormat;
+}
+
 void FramedReader::onNumberFormatChanged(NumberFormat numberFormat)
 {
+    _numberFormat = numberFormat;
     switch(numberFormat)
     {
         case NumberFormat_uint8:
@@ -116,6 +149,7 @@ void FramedReader::onNumberFormatChanged(NumberFormat numberFormat)
 
     checkSettings();
     reset();
+    updateNumChannels();
 }
 
 void FramedReader::checkSettings()
@@ -143,7 +177,7 @@ void FramedReader::checkSettings()
     // show an error message
     if (settingsInvalid & SYNCWORD_INVALID)
     {
-        _settingsWidget.showMessage("Sync word is invalid!", true);
+        showMessage("Sync word is invalid!", true);
     }
     else if (settingsInvalid & FRAMESIZE_INVALID)
     {
@@ -151,14 +185,23 @@ void FramedReader::checkSettings()
             QString("Frame size must be multiple of %1 (#channels * sample size)!")\
             .arg(_numChannels * sampleSize);
 
-        _settingsWidget.showMessage(errorMessage, true);
+        showMessage(errorMessage, true);
     }
     else
     {
-        _settingsWidget.showMessage("All is well!");
+        showMessage("All is well!");
     }
 }
 
+void FramedReader::showMessage(QString message, bool error)
+{
+    // settings widget lives in GUI thread
+    QMetaObject::invokeMethod(&_settingsWidget, [this, message, error]()
+                              {
+                                  _settingsWidget.showMessage(message, error);
+                              });
+}
+
 void FramedReader::onNumOfChannelsChanged(unsigned value)
 {
     _numChannels = value;
@@ -232,7 +275,7 @@ unsigned FramedReader::readData()
                 _device->read((char*) &frameSize16, sizeof(frameSize16));
                 numBytesRead += sizeof(frameSize16);
 
-                if (_settingsWidget.endianness() == LittleEndian)
+                if (endianness == LittleEndian)
                 {
                     frameSize = qFromLittleEndian(frameSize16);
                 }
@@ -352,7 +395,7 @@ template<typename T> double FramedReader::readSampleAs()
         }
     }
 
-    if (_settingsWidget.endianness() == LittleEndian)
+    if (endianness == LittleEndian)
     {
         data = qFromLittleEndian(data);
     }
@@ -36,6 +36,7 @@ public:
     explicit FramedReader(QIODevice* device, QObject *parent = 0);
     QWidget* settingsWidget();
     unsigned numChannels() const;
+    NumberFormat numberFormat() const override;
     /// Stores settings into a `QSettings`
     void saveSettings(QSettings* settings);
     /// Loads settings from a `QSettings`.
@@ -52,6 +53,8 @@ private:
     // settings related members
     FramedReaderSettings _settingsWidget;
     unsigned _numChannels;
+    NumberFormat _numberFormat;
+    Endianness endianness;      ///< copy of selection in settings widget
     unsigned sampleSize;
     unsigned settingsInvalid;   /// settings are all valid if this is 0, if not no reading is done
     QByteArray syncWord;
@@ -65,6 +68,8 @@ private:
     /// error message. Also updates `settingsInvalid`. If settings are
     /// valid `settingsInvalid` should be `0`.
     void checkSettings();
+    /// Shows a message on settings widget from any thread
+    void showMessage(QString message, bool error = false);
 
     // read state related members
     unsigned sync_i; /// sync byte index to be read next
@@ -87,6 +87,8 @@ FramedReaderSettings::FramedReaderSettings(QWidget *parent) :
 
     connect(ui->nfBox, SIGNAL(selectionChanged(NumberFormat)),
             this, SIGNAL(numberFormatChanged(NumberFormat)));
+    connect(ui->endiBox, SIGNAL(selectionChanged(Endianness)),
+            this, SIGNAL(endiannessChanged(Endianness)));
 }
 
 FramedReaderSettings::~FramedReaderSettings()
@@ -71,6 +71,7 @@ signals:
     void checksumChanged(bool);
     void numOfChannelsChanged(unsigned);
     void numberFormatChanged(NumberFormat);
+    void endiannessChanged(Endianness);
     void debugModeChanged(bool);
 
 private:
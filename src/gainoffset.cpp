@@ -0,0 +1,144 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+
+#include "gainoffset.h"
+
+// see minmax.cpp for notes on the kernel selection
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GAINOFFSET_X86
+#include <immintrin.h>
+#if !defined(_WIN32)
+#define GAINOFFSET_AVX
+#endif
+#endif
+
+typedef void (*GainOffsetKernel)(const double* src, unsigned n,
+                                 double gain, double offset, double* dst);
+
+static void gainOffsetScalar(const double* src, unsigned n,
+                             double gain, double offset, double* dst)
+{
+    for (unsigned i = 0; i < n; i++)
+    {
+        dst[i] = src[i] * gain + offset;
+    }
+}
+
+#ifdef GAINOFFSET_X86
+
+__attribute__((target("sse2")))
+static void gainOffsetSSE2(const double* src, unsigned n,
+                           double gain, double offset, double* dst)
+{
+    __m128d g = _mm_set1_pd(gain);
+    __m128d o = _mm_set1_pd(offset);
+
+    unsigned i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d v = _mm_loadu_pd(src + i);
+        _mm_storeu_pd(dst + i, _mm_add_pd(_mm_mul_pd(v, g), o));
+    }
+    gainOffsetScalar(src + i, n - i, gain, offset, dst + i);
+}
+
+#endif // GAINOFFSET_X86
+
+#ifdef GAINOFFSET_AVX
+
+__attribute__((target("avx2,fma")))
+static void gainOffsetAVX2(const double* src, unsigned n,
+                           double gain, double offset, double* dst)
+{
+    __m256d g = _mm256_set1_pd(gain);
+    __m256d o = _mm256_set1_pd(offset);
+
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256d a = _mm256_loadu_pd(src + i);
+        __m256d b = _mm256_loadu_pd(src + i + 4);
+        _mm256_storeu_pd(dst + i, _mm256_fmadd_pd(a, g, o));
+        _mm256_storeu_pd(dst + i + 4, _mm256_fmadd_pd(b, g, o));
+    }
+    for (; i + 4 <= n; i += 4)
+    {
+        _mm256_storeu_pd(dst + i, _mm256_fmadd_pd(_mm256_loadu_pd(src + i), g, o));
+    }
+    gainOffsetScalar(src + i, n - i, gain, offset, dst + i);
+}
+
+__attribute__((target("avx512f")))
+static void gainOffsetAVX512(const double* src, unsigned n,
+                             double gain, double offset, double* dst)
+{
+    __m512d g = _mm512_set1_pd(gain);
+    __m512d o = _mm512_set1_pd(offset);
+
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm512_storeu_pd(dst + i, _mm512_fmadd_pd(_mm512_loadu_pd(src + i), g, o));
+    }
+    if (i < n)
+    {
+        // remaining samples are handled with a mask
+        __mmask8 mask = (__mmask8) ((1u << (n - i)) - 1);
+        __m512d v = _mm512_maskz_loadu_pd(mask, src + i);
+        _mm512_mask_storeu_pd(dst + i, mask, _mm512_fmadd_pd(v, g, o));
+    }
+}
+
+#endif // GAINOFFSET_AVX
+
+static GainOffsetKernel kernel(SimdLevel level)
+{
+    switch (level)
+    {
+#ifdef GAINOFFSET_X86
+        case SimdLevel::SSE2: return &gainOffsetSSE2;
+#endif
+#ifdef GAINOFFSET_AVX
+        case SimdLevel::AVX2:
+            // there are a few AVX2 CPUs without FMA
+            __builtin_cpu_init();
+            if (!__builtin_cpu_supports("fma")) return &gainOffsetSSE2;
+            return &gainOffsetAVX2;
+        case SimdLevel::AVX512: return &gainOffsetAVX512;
+#endif
+        default: return &gainOffsetScalar;
+    }
+}
+
+void gainOffset(SimdLevel level, const double* src, unsigned n,
+                double gain, double offset, double* dst)
+{
+    Q_ASSERT(isSimdLevelSupported(level));
+
+    kernel(level)(src, n, gain, offset, dst);
+}
+
+void gainOffset(const double* src, unsigned n, double gain, double offset, double* dst)
+{
+    // selected once, initialization of function statics is thread safe
+    static const GainOffsetKernel bestKernel = kernel(simdLevel());
+    bestKernel(src, n, gain, offset, dst);
+}
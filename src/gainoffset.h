@@ -0,0 +1,40 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAINOFFSET_H
+#define GAINOFFSET_H
+
+#include "minmax.h"
+
+/**
+ * Computes `dst[i] = src[i] * gain + offset` for `n` samples, as a
+ * fused multiply-add where the CPU supports it. `src` and `dst` may be
+ * the same array.
+ *
+ * Uses the fastest kernel supported by the running CPU, which is
+ * selected at first call.
+ */
+void gainOffset(const double* src, unsigned n, double gain, double offset, double* dst);
+
+/// Same as `gainOffset(src, n, gain, offset, dst)` but with given
+/// kernel. Given `level` must be supported.
+void gainOffset(SimdLevel level, const double* src, unsigned n,
+                double gain, double offset, double* dst);
+
+#endif // GAINOFFSET_H
@@ -0,0 +1,63 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "framebuffer.h"
+#include "samplepackview.h"
+
+/// How `Stream` keeps the data of a session
+enum HistoryMode
+{
+    HistoryMode_Off,            ///< only last `numSamples` are kept
+    HistoryMode_File,           ///< all samples are kept in a file
+    HistoryMode_Tiered          ///< old samples are kept at lower resolution
+};
+
+/**
+ * Interface for storage of all samples of a session.
+ *
+ * Channels are accessed through `FrameBuffer` views that are created
+ * with `makeChannel()`. Sample `i` of a channel is the i'th sample
+ * that is added.
+ */
+class History
+{
+public:
+    /// Placeholder virtual destructor
+    virtual ~History() {};
+
+    /// Returns number of channels.
+    virtual unsigned numChannels() const = 0;
+    /// Returns number of samples of each channel.
+    virtual unsigned numRows() const = 0;
+    /// Appends a pack. Pack must be planar and have the same number of
+    /// channels.
+    virtual void addSamples(const SamplePackView& pack) = 0;
+
+    /**
+     * Returns a new view of a channel. Caller takes ownership.
+     *
+     * @important View must be deleted before this history is deleted.
+     */
+    virtual FrameBuffer* makeChannel(unsigned ci) const = 0;
+};
+
+#endif // HISTORY_H
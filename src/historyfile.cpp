@@ -0,0 +1,261 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <QDir>
+#include <QtDebug>
+
+#include "historyfile.h"
+#include "minmax.h"
+
+/// A read only view of a channel of history
+class HistoryFile::Channel : public FrameBuffer
+{
+public:
+    Channel(const HistoryFile* history, unsigned ci) :
+        history(history), ci(ci) {}
+
+    unsigned size() const override
+    {
+        return history->numRows();
+    }
+    double sample(unsigned i) const override
+    {
+        return history->sample(ci, i);
+    }
+    Range limits() const override
+    {
+        return history->limits(ci);
+    }
+    Range rangeLimits(unsigned start, unsigned n) const override
+    {
+        return history->rangeLimits(ci, start, n);
+    }
+    void copySamples(unsigned start, unsigned n, double* out) const override
+    {
+        history->copySamples(ci, start, n, out);
+    }
+
+private:
+    const HistoryFile* history;
+    unsigned ci;                  ///< channel index
+};
+
+HistoryFile::HistoryFile(unsigned nc) :
+    file(QDir::tempPath() + "/serialplot-XXXXXX.history"),
+    blocks(nc), chunkLimits(nc), totals(nc, {0, 0})
+{
+    Q_ASSERT(nc > 0);
+
+    _numChannels = nc;
+    _numRows = 0;
+
+    if (!file.open())
+    {
+        qWarning() << "Couldn't create history file:" << file.errorString();
+    }
+}
+
+HistoryFile::~HistoryFile()
+{
+    for (auto chunk : chunks)
+    {
+        file.unmap(reinterpret_cast<uchar*>(chunk));
+    }
+}
+
+bool HistoryFile::isOpen() const
+{
+    return file.isOpen();
+}
+
+bool HistoryFile::isFull() const
+{
+    return _numRows == MAX_ROWS;
+}
+
+unsigned HistoryFile::numChannels() const
+{
+    return _numChannels;
+}
+
+unsigned HistoryFile::numRows() const
+{
+    return _numRows;
+}
+
+bool HistoryFile::addChunk()
+{
+    qint64 chunkSize = qint64(CHUNK_ROWS) * _numChannels * sizeof(double);
+    qint64 offset = chunks.size() * chunkSize;
+
+    if (!file.resize(offset + chunkSize))
+    {
+        qWarning() << "Couldn't grow history file:" << file.errorString();
+        return false;
+    }
+
+    uchar* chunk = file.map(offset, chunkSize);
+    if (chunk == nullptr)
+    {
+        qWarning() << "Couldn't map history file:" << file.errorString();
+        return false;
+    }
+
+    chunks.append(reinterpret_cast<double*>(chunk));
+    return true;
+}
+
+double* HistoryFile::samplePtr(unsigned ci, unsigned i) const
+{
+    return chunks[i / CHUNK_ROWS] + ci * CHUNK_ROWS + i % CHUNK_ROWS;
+}
+
+void HistoryFile::addSamples(const SamplePackView& pack)
+{
+    Q_ASSERT(pack.numChannels() == _numChannels);
+
+    if (!isOpen() || isFull()) return;
+
+    unsigned ns = pack.numSamples();
+    unsigned done = 0;
+    while (done < ns && !isFull())
+    {
+        unsigned offset = _numRows % CHUNK_ROWS;
+        if (offset == 0 && !addChunk()) return;
+
+        unsigned n = std::min(ns - done, CHUNK_ROWS - offset);
+        for (unsigned ci = 0; ci < _numChannels; ci++)
+        {
+            memcpy(samplePtr(ci, _numRows), pack.data(ci) + done, n * sizeof(double));
+            updateLimits(ci, _numRows, n);
+        }
+        _numRows += n;
+        done += n;
+    }
+
+    if (isFull())
+    {
+        qWarning() << "History file is full, recording stopped at" << _numRows << "samples";
+    }
+}
+
+void HistoryFile::updateLimits(unsigned ci, unsigned start, unsigned n)
+{
+    unsigned end = start + n;
+    for (unsigned i = start; i < end;)
+    {
+        unsigned block = i / BLOCK_ROWS;
+        unsigned segEnd = std::min((block + 1) * BLOCK_ROWS, end);
+        Range r = minMax(samplePtr(ci, i), segEnd - i);
+
+        if (i % BLOCK_ROWS == 0)
+        {
+            blocks[ci].append(r);
+        }
+        else
+        {
+            blocks[ci][block] = combineLimits(blocks[ci][block], r);
+        }
+
+        unsigned chunk = i / CHUNK_ROWS;
+        if (i % CHUNK_ROWS == 0)
+        {
+            chunkLimits[ci].append(r);
+        }
+        else
+        {
+            chunkLimits[ci][chunk] = combineLimits(chunkLimits[ci][chunk], r);
+        }
+        totals[ci] = (i == 0) ? r : combineLimits(totals[ci], r);
+
+        i = segEnd;
+    }
+}
+
+double HistoryFile::sample(unsigned ci, unsigned i) const
+{
+    Q_ASSERT(ci < _numChannels && i < _numRows);
+
+    return *samplePtr(ci, i);
+}
+
+void HistoryFile::copySamples(unsigned ci, unsigned start, unsigned n, double* out) const
+{
+    Q_ASSERT(ci < _numChannels && start + n <= _numRows);
+
+    // copy chunk by chunk
+    unsigned end = start + n;
+    for (unsigned i = start; i < end;)
+    {
+        unsigned segEnd = std::min((i / CHUNK_ROWS + 1) * CHUNK_ROWS, end);
+        memcpy(out, samplePtr(ci, i), (segEnd - i) * sizeof(double));
+        out += segEnd - i;
+        i = segEnd;
+    }
+}
+
+Range HistoryFile::limits(unsigned ci) const
+{
+    Q_ASSERT(ci < _numChannels);
+
+    return totals[ci];
+}
+
+Range HistoryFile::rangeLimits(unsigned ci, unsigned start, unsigned n) const
+{
+    Q_ASSERT(ci < _numChannels && n > 0 && start + n <= _numRows);
+
+    // full chunks and blocks are read from summaries, partial blocks
+    // are scanned
+    Range result = {0, 0};
+    unsigned end = start + n;
+    for (unsigned i = start; i < end;)
+    {
+        unsigned block = i / BLOCK_ROWS;
+        unsigned segEnd = std::min((block + 1) * BLOCK_ROWS, end);
+
+        Range r;
+        if (i % CHUNK_ROWS == 0 && end - i >= CHUNK_ROWS)
+        {
+            r = chunkLimits[ci][i / CHUNK_ROWS];
+            segEnd = i + CHUNK_ROWS;
+        }
+        else if (i % BLOCK_ROWS == 0 && segEnd - i == BLOCK_ROWS)
+        {
+            r = blocks[ci][block];
+        }
+        else
+        {
+            r = minMax(samplePtr(ci, i), segEnd - i);
+        }
+        result = (i == start) ? r : combineLimits(result, r);
+
+        i = segEnd;
+    }
+    return result;
+}
+
+FrameBuffer* HistoryFile::makeChannel(unsigned ci) const
+{
+    Q_ASSERT(ci < _numChannels);
+
+    return new Channel(this, ci);
+}
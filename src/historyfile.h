@@ -0,0 +1,107 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HISTORYFILE_H
+#define HISTORYFILE_H
+
+#include <QVector>
+#include <QTemporaryFile>
+
+#include "history.h"
+
+/**
+ * Append-only, disk backed storage for all samples of a session.
+ *
+ * Samples are stored in a temporary file that is removed when this
+ * object is deleted. File is grown in chunks and each chunk is memory
+ * mapped, so samples are accessed directly and only the recently used
+ * parts stay in memory (as page cache). Inside a chunk channels are
+ * placed one after another, so that a range of a channel is contiguous.
+ *
+ * Minimum and maximum of each block of `BLOCK_ROWS` samples and each
+ * chunk are kept in memory, this makes finding limits of long ranges
+ * cheap.
+ *
+ * Recording is capped at `MAX_ROWS` samples per channel. When the cap
+ * is reached a warning is logged once and further samples are dropped,
+ * already recorded samples stay accessible.
+ */
+class HistoryFile : public History
+{
+public:
+    /// Number of samples per channel in a file chunk
+    static const unsigned CHUNK_ROWS = 1 << 16;
+    /// Number of samples that a min/max summary is kept for
+    static const unsigned BLOCK_ROWS = 1024;
+    /// Maximum number of samples per channel. Samples are indexed with
+    /// `unsigned`, recording stops when the file is full.
+    static const unsigned MAX_ROWS = 0xFFFFFFFFu - CHUNK_ROWS + 1;
+
+    /// Creates an empty history file for `nc` channels.
+    explicit HistoryFile(unsigned nc);
+    ~HistoryFile();
+
+    /// Returns false if file couldn't be created
+    bool isOpen() const;
+    /// Returns true if `MAX_ROWS` samples are recorded
+    bool isFull() const;
+    unsigned numChannels() const override;
+    unsigned numRows() const override;
+
+    /**
+     * Appends a pack. Pack must have the same number of channels.
+     *
+     * Samples that can't be written (ex: disk is full) and samples
+     * after `MAX_ROWS` are dropped.
+     */
+    void addSamples(const SamplePackView& pack) override;
+
+    /// Returns sample `i` of channel `ci`.
+    double sample(unsigned ci, unsigned i) const;
+    /// Copies `n` samples of channel `ci` starting from `start` to `out`.
+    void copySamples(unsigned ci, unsigned start, unsigned n, double* out) const;
+    /// Returns minimum and maximum of all samples of channel `ci`.
+    Range limits(unsigned ci) const;
+    /// Returns minimum and maximum of `n` samples of channel `ci`
+    /// starting from `start`.
+    Range rangeLimits(unsigned ci, unsigned start, unsigned n) const;
+
+    FrameBuffer* makeChannel(unsigned ci) const override;
+
+private:
+    class Channel;
+
+    QTemporaryFile file;
+    unsigned _numChannels;
+    unsigned _numRows;
+    QVector<double*> chunks;        ///< mapped chunks of file
+    QVector<QVector<Range>> blocks; ///< limits of each block of channels
+    QVector<QVector<Range>> chunkLimits; ///< limits of each chunk of channels
+    QVector<Range> totals;          ///< limits of all samples of channels
+
+    /// Grows the file and maps the new chunk. Returns false on failure.
+    bool addChunk();
+    /// Returns address of sample `i` of channel `ci`. Following samples
+    /// are contiguous until the end of chunk.
+    double* samplePtr(unsigned ci, unsigned i) const;
+    /// Updates limits for newly written `n` samples of a channel.
+    void updateLimits(unsigned ci, unsigned start, unsigned n);
+};
+
+#endif // HISTORYFILE_H
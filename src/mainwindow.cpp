@@ -31,6 +31,8 @@
 #include <QtDebug>
 #include <QCommandLineParser>
 #include <QFileInfo>
+#include <QThread>
+#include <QTimer>
 #include <qwt_plot.h>
 #include <limits.h>
 #include <cmath>
@@ -67,18 +69,24 @@ MainWindow::MainWindow(QWidget *parent) :
     ui(new Ui::MainWindow),
     aboutDialog(this),
     portControl(&serialPort),
+    sinkPool(0, SINK_POOL_DEPTH, SinkPool::Block),
+    parallelSinks(false),
+    sinkFullWarned(false),
     secondaryPlot(NULL),
     snapshotMan(this, &stream),
+    packQueue(PACK_QUEUE_SIZE, PackQueue::DropOldest),
+    queueDropWarned(false),
     commandPanel(&serialPort),
     dataFormatPanel(&serialPort),
     recordPanel(&stream),
     textView(&stream),
     updateCheckDialog(this),
-    bpsLabel(&portControl, &dataFormatPanel, this)
+    bpsLabel(&portControl, &dataFormatPanel, this),
+    memoryLabel(this)
 {
     ui->setupUi(this);
 
-    plotMan = new PlotManager(ui->plotArea, &plotMenu, &stream);
+    plotMan = new PlotManager(ui->plotArea, &plotMenu, &stream, &renderScheduler);
 
     ui->tabWidget->insertTab(0, &portControl, "Port");
     ui->tabWidget->insertTab(1, &dataFormatPanel, "Data Format");
@@ -178,6 +186,9 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(&plotControlPanel, &PlotControlPanel::yScaleChanged,
             plotMan, &PlotManager::setYAxis);
 
+    connect(&plotControlPanel, &PlotControlPanel::autoScaleVisibleChanged,
+            plotMan, &PlotManager::setAutoScaleVisible);
+
     connect(&plotControlPanel, &PlotControlPanel::xScaleChanged,
             &stream, &Stream::setXAxis);
 
@@ -190,6 +201,22 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(&plotControlPanel, &PlotControlPanel::lineThicknessChanged,
             plotMan, &PlotManager::setLineThickness);
 
+    renderScheduler.setMaxFps(plotControlPanel.maxFps());
+    connect(&plotControlPanel, &PlotControlPanel::maxFpsChanged,
+            &renderScheduler, &RenderScheduler::setMaxFps);
+
+    // incoming data is passed to the stream once per frame
+    packQueue.setPendingCallback([this]()
+        {
+            QMetaObject::invokeMethod(&renderScheduler, "requestFrame",
+                                      Qt::QueuedConnection);
+        });
+    connect(&renderScheduler, &RenderScheduler::frameStarted,
+            [this]() {packQueue.drain();});
+
+    connect(&plotControlPanel, &PlotControlPanel::historyModeChanged,
+            &stream, &Stream::setHistoryMode);
+
     // plot toolbar signals
     QObject::connect(ui->actionClear, SIGNAL(triggered(bool)),
                      this, SLOT(clearPlot()));
@@ -233,9 +260,11 @@ MainWindow::MainWindow(QWidget *parent) :
     // init scales
     stream.setXAxis(plotControlPanel.xAxisAsIndex(),
                     plotControlPanel.xMin(), plotControlPanel.xMax());
+    stream.setHistoryMode(plotControlPanel.historyMode());
 
     plotMan->setYAxis(plotControlPanel.autoScale(),
                       plotControlPanel.yMin(), plotControlPanel.yMax());
+    plotMan->setAutoScaleVisible(plotControlPanel.autoScaleVisible());
     plotMan->setXAxis(plotControlPanel.xAxisAsIndex(),
                       plotControlPanel.xMin(), plotControlPanel.xMax());
     plotMan->setNumOfSamples(numOfSamples);
@@ -251,10 +280,15 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(&sampleCounter, &SampleCounter::spsChanged,
             this, &MainWindow::onSpsChanged);
 
+    // init memory usage display
+    ui->statusBar->addPermanentWidget(&memoryLabel);
+
     bpsLabel.setMinimumWidth(70);
     bpsLabel.setAlignment(Qt::AlignRight);
     spsLabel.setMinimumWidth(70);
     spsLabel.setAlignment(Qt::AlignRight);
+    memoryLabel.setMinimumWidth(70);
+    memoryLabel.setAlignment(Qt::AlignRight);
 
     // init demo
     QObject::connect(ui->actionDemoMode, &QAction::toggled,
@@ -263,10 +297,12 @@ MainWindow::MainWindow(QWidget *parent) :
     QObject::connect(ui->actionDemoMode, &QAction::toggled,
                      plotMan, &PlotManager::showDemoIndicator);
 
-    // init stream connections
-    connect(&dataFormatPanel, &DataFormatPanel::sourceChanged,
-            this, &MainWindow::onSourceChanged);
-    onSourceChanged(dataFormatPanel.activeSource());
+    // init stream connections, readers feed the queue from their own
+    // thread and sinks get configuration of the first reader from it
+    dataFormatPanel.setSink(&packQueue);
+    packQueue.drain();
+    packQueue.connectSink(&stream);
+    packQueue.connectSink(&sampleCounter);
 
     // load default settings
     QSettings settings(PROGRAM_NAME, PROGRAM_NAME);
@@ -297,6 +333,9 @@ MainWindow::~MainWindow()
         serialPort.close();
     }
 
+    // sinks shouldn't be destroyed while they are fed
+    sinkPool.flush();
+
     delete plotMan;
 
     delete ui;
@@ -382,14 +421,9 @@ void MainWindow::onPortToggled(bool open)
     }
 }
 
-void MainWindow::onSourceChanged(Source* source)
-{
-    source->connectSink(&stream);
-    source->connectSink(&sampleCounter);
-}
-
 void MainWindow::clearPlot()
 {
+    packQueue.clear();
     stream.clear();
     plotMan->replot();
 }
@@ -405,6 +439,57 @@ void MainWindow::onSpsChanged(float sps)
 {
     int precision = sps < 1. ? 3 : 0;
     spsLabel.setText(QString::number(sps, 'f', precision) + "sps");
+
+    QString toolTip = tr("samples per second (per channel)");
+
+    // queue is drained with frames, it overflows if frames are too rare
+    if (packQueue.droppedSamples())
+    {
+        if (!queueDropWarned)
+        {
+            qWarning() << "Data is coming faster than it's plotted, some samples are dropped."
+                       << "Try increasing Max FPS.";
+            queueDropWarned = true;
+        }
+        toolTip += "\n" + tr("dropped samples: %1").arg(packQueue.droppedSamples());
+    }
+
+    // a growing queue means that sink can't keep up
+    if (parallelSinks)
+    {
+        QStringList depths;
+        for (auto& st : sinkPool.stats())
+        {
+            QString name;
+            if (st.sink == &sampleCounter) name = tr("sample counter");
+            else if (dynamic_cast<const DataRecorder*>(st.sink)) name = tr("recorder");
+            else name = tr("sink");
+            QString depth = tr("%1: %2 (peak %3)").arg(name).arg(st.depth).arg(st.peakDepth);
+            // full queue makes the source wait, which may drop samples of plot
+            if (st.overflows)
+            {
+                if (!sinkFullWarned)
+                {
+                    qWarning() << "A parallel sink can't keep up with incoming data,"
+                               << "data source waits for it.";
+                    sinkFullWarned = true;
+                }
+                depth += " " + tr("full %1 times").arg(st.overflows);
+            }
+            depths << depth;
+        }
+        sinkPool.resetPeaks();
+        toolTip += "\n" + tr("queued packs:") + "\n" + depths.join("\n");
+    }
+    spsLabel.setToolTip(toolTip);
+}
+
+void MainWindow::enableParallelSinks(bool enabled)
+{
+    parallelSinks = enabled;
+    SinkPool* pool = enabled ? &sinkPool : nullptr;
+    packQueue.setSinkPool(pool);
+    stream.setFollowerPool(pool);
 }
 
 bool MainWindow::isDemoRunning()
@@ -460,7 +545,7 @@ void MainWindow::showBarPlot(bool show)
 {
     if (show)
     {
-        auto plot = new BarPlot(&stream, &plotMenu);
+        auto plot = new BarPlot(&stream, &plotMenu, &renderScheduler);
         plot->setYAxis(plotControlPanel.autoScale(),
                        plotControlPanel.yMin(),
                        plotControlPanel.yMax());
@@ -520,6 +605,16 @@ void MainWindow::messageHandler(QtMsgType type,
                                 const QString &logString,
                                 const QString &msg)
 {
+    // messages of worker threads (ex: sink pool) are shown by GUI thread
+    if (QThread::currentThread() != thread())
+    {
+        QTimer::singleShot(0, this, [this, type, logString, msg]()
+                           {
+                               messageHandler(type, logString, msg);
+                           });
+        return;
+    }
+
     if (ui != NULL)
         ui->ptLog->appendPlainText(logString);
 
@@ -644,11 +739,14 @@ void MainWindow::handleCommandLineOptions(const QCoreApplication &app)
     QCommandLineOption portOpt({"p", "port"}, "Set port name.", "port name");
     QCommandLineOption baudrateOpt({"b" ,"baudrate"}, "Set port baud rate.", "baud rate");
     QCommandLineOption openPortOpt({"o", "open"}, "Open serial port.");
+    QCommandLineOption parallelSinksOpt("parallel-sinks",
+                                        "Feed sample counter and recorder on worker threads.");
 
     parser.addOption(configOpt);
     parser.addOption(portOpt);
     parser.addOption(baudrateOpt);
     parser.addOption(openPortOpt);
+    parser.addOption(parallelSinksOpt);
 
     parser.process(app);
 
@@ -679,6 +777,11 @@ void MainWindow::handleCommandLineOptions(const QCoreApplication &app)
         portControl.selectBaudrate(parser.value(baudrateOpt));
     }
 
+    if (parser.isSet(parallelSinksOpt))
+    {
+        enableParallelSinks(true);
+    }
+
     if (parser.isSet(openPortOpt))
     {
         portControl.openPort();
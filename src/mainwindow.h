@@ -41,6 +41,9 @@
 #include "recordpanel.h"
 #include "ui_about_dialog.h"
 #include "stream.h"
+#include "sinkpool.h"
+#include "packqueue.h"
+#include "renderscheduler.h"
 #include "snapshotmanager.h"
 #include "plotmanager.h"
 #include "plotmenu.h"
@@ -48,6 +51,7 @@
 #include "samplecounter.h"
 #include "datatextview.h"
 #include "bpslabel.h"
+#include "memorylabel.h"
 
 namespace Ui {
 class MainWindow;
@@ -71,18 +75,29 @@ private:
     QDialog aboutDialog;
     void setupAboutDialog();
 
-    QSerialPort serialPort;
+    AsyncSerialPort serialPort;
     PortControl portControl;
 
     unsigned int numOfSamples;
 
     QList<QwtPlotCurve*> curves;
     // ChannelManager channelMan;
+    /// Feeds thread-safe sinks when `parallelSinks` is enabled. Declared
+    /// before all sources and sinks so that it outlives them.
+    SinkPool sinkPool;
+    bool parallelSinks;
+    bool sinkFullWarned;        ///< full sink queues are reported in log
     Stream stream;
+    RenderScheduler renderScheduler; ///< paces repaints of plots
     PlotManager* plotMan;
     QWidget* secondaryPlot;
     SnapshotManager snapshotMan;
     SampleCounter sampleCounter;
+    /// Packs of the active source wait here for the next frame of
+    /// `renderScheduler`. Declared before sources so that it outlives
+    /// them.
+    PackQueue packQueue;
+    bool queueDropWarned;       ///< dropped packs are reported in log
 
     QLabel spsLabel;
     CommandPanel commandPanel;
@@ -93,11 +108,14 @@ private:
     DataTextView textView;
     UpdateCheckDialog updateCheckDialog;
     BPSLabel bpsLabel;
+    MemoryLabel memoryLabel;
 
     void handleCommandLineOptions(const QCoreApplication &app);
 
     /// Returns true if demo is running
     bool isDemoRunning();
+    /// Feeds thread-safe sinks of active source and stream on `sinkPool`
+    void enableParallelSinks(bool enabled);
     /// Display a secondary plot in the splitter, removing and
     /// deleting previous one if it exists
     void showSecondary(QWidget* wid);
@@ -117,7 +135,6 @@ private:
 
 private slots:
     void onPortToggled(bool open);
-    void onSourceChanged(Source* source);
     void onNumOfSamplesChanged(int value);
 
     void clearPlot();
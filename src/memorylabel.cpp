@@ -0,0 +1,60 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "memorylabel.h"
+#include "allocator.h"
+
+/// Returns size in human readable form
+static QString formatBytes(size_t bytes)
+{
+    if (bytes < 1024 * 1024)
+    {
+        return QString("%1KB").arg(bytes / 1024.0, 0, 'f', 1);
+    }
+    else
+    {
+        return QString("%1MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+}
+
+MemoryLabel::MemoryLabel(QWidget *parent) :
+    QLabel(parent)
+{
+    connect(&updateTimer, &QTimer::timeout,
+            this, &MemoryLabel::onUpdateTimeout);
+
+    onUpdateTimeout();
+    updateTimer.start(1000);
+}
+
+void MemoryLabel::onUpdateTimeout()
+{
+    size_t total = 0;
+    QString tip = tr("memory reserved for data");
+    for (int i = 0; i < MemoryUser_NUM; i++)
+    {
+        auto user = static_cast<MemoryUser>(i);
+        size_t bytes = memoryReserved(user);
+        total += bytes;
+        tip += QString("\n%1: %2").arg(memoryUserName(user)).arg(formatBytes(bytes));
+    }
+
+    setText(formatBytes(total));
+    setToolTip(tip);
+}
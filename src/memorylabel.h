@@ -0,0 +1,46 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MEMORYLABEL_H
+#define MEMORYLABEL_H
+
+#include <QLabel>
+#include <QTimer>
+
+/**
+ * Displays memory reserved for sample data (see `allocator.h`).
+ *
+ * Total is displayed as text, reservations of each subsystem are listed in
+ * tooltip.
+ */
+class MemoryLabel : public QLabel
+{
+    Q_OBJECT
+
+public:
+    explicit MemoryLabel(QWidget *parent = 0);
+
+private:
+    QTimer updateTimer;
+
+private slots:
+    void onUpdateTimeout();
+};
+
+#endif // MEMORYLABEL_H
@@ -0,0 +1,273 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+
+#include "minmax.h"
+
+// SIMD kernels are built with GCC/Clang function target attributes, so
+// there is no need for special compiler flags. Note that AVX kernels
+// are disabled on Windows because GCC can't align the stack for 32/64
+// byte registers there.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MINMAX_X86
+#include <immintrin.h>
+#if !defined(_WIN32)
+#define MINMAX_AVX
+#endif
+#endif
+
+typedef Range (*MinMaxKernel)(const double* data, unsigned n);
+
+// Note on NaN handling: `x < min ? x : min` ignores `x` if it's NaN,
+// `_mm_min_pd(x, min)` does the same since it returns the second
+// operand when either of them is NaN. Order of operands is important!
+// Vector accumulators start with all lanes set to `data[0]`. Starting
+// them from the first loaded vectors would let a NaN in those vectors
+// stick in its lane.
+
+static Range minMaxScalar(const double* data, unsigned n)
+{
+    Range r = {data[0], data[0]};
+    for (unsigned i = 1; i < n; i++)
+    {
+        double v = data[i];
+        r.start = v < r.start ? v : r.start;
+        r.end = v > r.end ? v : r.end;
+    }
+    return r;
+}
+
+#ifdef MINMAX_X86
+
+__attribute__((target("sse2")))
+static Range minMaxSSE2(const double* data, unsigned n)
+{
+    if (n < 4) return minMaxScalar(data, n);
+
+    __m128d min0 = _mm_set1_pd(data[0]);
+    __m128d max0 = min0;
+    __m128d min1 = min0;
+    __m128d max1 = min0;
+
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128d a = _mm_loadu_pd(data + i);
+        __m128d b = _mm_loadu_pd(data + i + 2);
+        min0 = _mm_min_pd(a, min0);
+        max0 = _mm_max_pd(a, max0);
+        min1 = _mm_min_pd(b, min1);
+        max1 = _mm_max_pd(b, max1);
+    }
+
+    min0 = _mm_min_pd(min1, min0);
+    max0 = _mm_max_pd(max1, max0);
+
+    double mins[2], maxs[2];
+    _mm_storeu_pd(mins, min0);
+    _mm_storeu_pd(maxs, max0);
+
+    Range r = {mins[0], maxs[0]};
+    r.start = mins[1] < r.start ? mins[1] : r.start;
+    r.end = maxs[1] > r.end ? maxs[1] : r.end;
+
+    // remaining
+    for (; i < n; i++)
+    {
+        double v = data[i];
+        r.start = v < r.start ? v : r.start;
+        r.end = v > r.end ? v : r.end;
+    }
+    return r;
+}
+
+#endif // MINMAX_X86
+
+#ifdef MINMAX_AVX
+
+__attribute__((target("avx2")))
+static Range minMaxAVX2(const double* data, unsigned n)
+{
+    if (n < 8) return minMaxScalar(data, n);
+
+    __m256d min0 = _mm256_set1_pd(data[0]);
+    __m256d max0 = min0;
+    __m256d min1 = min0;
+    __m256d max1 = min0;
+
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256d a = _mm256_loadu_pd(data + i);
+        __m256d b = _mm256_loadu_pd(data + i + 4);
+        min0 = _mm256_min_pd(a, min0);
+        max0 = _mm256_max_pd(a, max0);
+        min1 = _mm256_min_pd(b, min1);
+        max1 = _mm256_max_pd(b, max1);
+    }
+
+    min0 = _mm256_min_pd(min1, min0);
+    max0 = _mm256_max_pd(max1, max0);
+
+    double mins[4], maxs[4];
+    _mm256_storeu_pd(mins, min0);
+    _mm256_storeu_pd(maxs, max0);
+
+    Range r = {mins[0], maxs[0]};
+    for (unsigned k = 1; k < 4; k++)
+    {
+        r.start = mins[k] < r.start ? mins[k] : r.start;
+        r.end = maxs[k] > r.end ? maxs[k] : r.end;
+    }
+
+    for (; i < n; i++)
+    {
+        double v = data[i];
+        r.start = v < r.start ? v : r.start;
+        r.end = v > r.end ? v : r.end;
+    }
+    return r;
+}
+
+__attribute__((target("avx512f")))
+static Range minMaxAVX512(const double* data, unsigned n)
+{
+    if (n < 16) return minMaxScalar(data, n);
+
+    __m512d min0 = _mm512_set1_pd(data[0]);
+    __m512d max0 = min0;
+    __m512d min1 = min0;
+    __m512d max1 = min0;
+
+    // masked forms with all lanes selected are used, because unmasked
+    // ones pass an undefined vector that GCC warns about
+    unsigned i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512d a = _mm512_loadu_pd(data + i);
+        __m512d b = _mm512_loadu_pd(data + i + 8);
+        min0 = _mm512_mask_min_pd(min0, 0xFF, a, min0);
+        max0 = _mm512_mask_max_pd(max0, 0xFF, a, max0);
+        min1 = _mm512_mask_min_pd(min1, 0xFF, b, min1);
+        max1 = _mm512_mask_max_pd(max1, 0xFF, b, max1);
+    }
+
+    min0 = _mm512_mask_min_pd(min0, 0xFF, min1, min0);
+    max0 = _mm512_mask_max_pd(max0, 0xFF, max1, max0);
+
+    double mins[8], maxs[8];
+    _mm512_storeu_pd(mins, min0);
+    _mm512_storeu_pd(maxs, max0);
+
+    Range r = {mins[0], maxs[0]};
+    for (unsigned k = 1; k < 8; k++)
+    {
+        r.start = mins[k] < r.start ? mins[k] : r.start;
+        r.end = maxs[k] > r.end ? maxs[k] : r.end;
+    }
+
+    for (; i < n; i++)
+    {
+        double v = data[i];
+        r.start = v < r.start ? v : r.start;
+        r.end = v > r.end ? v : r.end;
+    }
+    return r;
+}
+
+#endif // MINMAX_AVX
+
+bool isSimdLevelSupported(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::Scalar:
+            return true;
+#ifdef MINMAX_X86
+        case SimdLevel::SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+#endif
+#ifdef MINMAX_AVX
+        case SimdLevel::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        case SimdLevel::AVX512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+SimdLevel simdLevel()
+{
+    const SimdLevel levels[] = {SimdLevel::AVX512, SimdLevel::AVX2, SimdLevel::SSE2};
+    for (auto level : levels)
+    {
+        if (isSimdLevelSupported(level)) return level;
+    }
+    return SimdLevel::Scalar;
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::Scalar: return "Scalar";
+        case SimdLevel::SSE2: return "SSE2";
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::AVX512: return "AVX512";
+    }
+    return "";
+}
+
+static MinMaxKernel kernel(SimdLevel level)
+{
+    switch (level)
+    {
+#ifdef MINMAX_X86
+        case SimdLevel::SSE2: return &minMaxSSE2;
+#endif
+#ifdef MINMAX_AVX
+        case SimdLevel::AVX2: return &minMaxAVX2;
+        case SimdLevel::AVX512: return &minMaxAVX512;
+#endif
+        default: return &minMaxScalar;
+    }
+}
+
+Range minMax(SimdLevel level, const double* data, unsigned n)
+{
+    Q_ASSERT(n > 0);
+    Q_ASSERT(isSimdLevelSupported(level));
+
+    return kernel(level)(data, n);
+}
+
+Range minMax(const double* data, unsigned n)
+{
+    Q_ASSERT(n > 0);
+
+    // selected once, initialization of function statics is thread safe
+    static const MinMaxKernel bestKernel = kernel(simdLevel());
+    return bestKernel(data, n);
+}
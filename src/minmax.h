@@ -0,0 +1,80 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MINMAX_H
+#define MINMAX_H
+
+#include "framebuffer.h"
+
+/// Instruction set levels that min/max kernels are implemented for
+enum class SimdLevel
+{
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+/**
+ * Returns minimum and maximum of given array.
+ *
+ * Uses the fastest kernel supported by the running CPU, which is
+ * selected at first call. NaN values are ignored unless `data[0]`
+ * is NaN.
+ *
+ * @param data input array
+ * @param n number of elements, must be bigger than 0
+ */
+Range minMax(const double* data, unsigned n);
+
+/// Same as `minMax(data, n)` but with given kernel. Mainly for testing and
+/// benchmarking. Given `level` must be supported.
+Range minMax(SimdLevel level, const double* data, unsigned n);
+
+/// Scalar min/max for compact sample types (integers and `float`). Same
+/// rules as `minMax(data, n)` apply.
+template <typename T> Range minMax(const T* data, unsigned n)
+{
+    T min = data[0];
+    T max = data[0];
+    for (unsigned i = 1; i < n; i++)
+    {
+        if (data[i] < min) min = data[i];
+        if (data[i] > max) max = data[i];
+    }
+    return {(double) min, (double) max};
+}
+
+/// Returns the union of 2 ranges.
+inline Range combineLimits(Range a, Range b)
+{
+    return {b.start < a.start ? b.start : a.start,
+            b.end > a.end ? b.end : a.end};
+}
+
+/// Returns the highest level that is supported by both the build and the CPU.
+SimdLevel simdLevel();
+
+/// Returns true if given level is supported by both the build and the CPU.
+bool isSimdLevelSupported(SimdLevel level);
+
+/// Returns a printable name for given level.
+const char* simdLevelName(SimdLevel level);
+
+#endif // MINMAX_H
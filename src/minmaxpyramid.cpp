@@ -0,0 +1,151 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+#include <algorithm>
+#include <limits>
+
+#include "minmaxpyramid.h"
+#include "minmax.h"
+
+/// Used for padding nodes that doesn't cover any data
+static const Range EMPTY_RANGE = {std::numeric_limits<double>::infinity(),
+                                  -std::numeric_limits<double>::infinity()};
+
+MinMaxPyramid::MinMaxPyramid()
+{
+    _size = 0;
+    numLeaves = 0;
+    base = 1;
+    nodes = nullptr;
+}
+
+MinMaxPyramid::~MinMaxPyramid()
+{
+    delete[] nodes;
+}
+
+template <typename T>
+void MinMaxPyramid::build(const T* data, unsigned n)
+{
+    Q_ASSERT(n > 0);
+
+    _size = n;
+    numLeaves = (n + LEAF_SIZE - 1) / LEAF_SIZE;
+    base = 1;
+    while (base < numLeaves) base <<= 1;
+
+    delete[] nodes;
+    nodes = new Range[2 * base];
+    std::fill(nodes, nodes + 2 * base, EMPTY_RANGE);
+
+    update(data, 0, n);
+}
+
+template <typename T>
+void MinMaxPyramid::update(const T* data, unsigned start, unsigned end)
+{
+    Q_ASSERT(start < end && end <= _size);
+
+    unsigned first = start / LEAF_SIZE;
+    unsigned last = (end - 1) / LEAF_SIZE;
+
+    // leaves
+    for (unsigned li = first; li <= last; li++)
+    {
+        unsigned dstart = li * LEAF_SIZE;
+        unsigned dend = std::min(dstart + LEAF_SIZE, _size);
+        nodes[base + li] = minMax(&data[dstart], dend - dstart);
+    }
+
+    // upper levels
+    for (unsigned l = (base + first) / 2, h = (base + last) / 2; l > 0; l /= 2, h /= 2)
+    {
+        for (unsigned i = l; i <= h; i++)
+        {
+            nodes[i] = combineLimits(nodes[2*i], nodes[2*i+1]);
+        }
+    }
+}
+
+Range MinMaxPyramid::limits() const
+{
+    Q_ASSERT(nodes != nullptr);
+
+    return nodes[1];
+}
+
+template <typename T>
+Range MinMaxPyramid::limits(const T* data, unsigned start, unsigned end) const
+{
+    Q_ASSERT(start < end && end <= _size);
+
+    unsigned first = start / LEAF_SIZE;
+    unsigned last = (end - 1) / LEAF_SIZE;
+
+    // range is in a single leaf
+    if (first == last)
+    {
+        if (start == first * LEAF_SIZE && end == std::min((last + 1) * LEAF_SIZE, _size))
+        {
+            return nodes[base + first];
+        }
+        return minMax(&data[start], end - start);
+    }
+
+    Range r = EMPTY_RANGE;
+
+    // scan partially covered leaves at the edges
+    if (start != first * LEAF_SIZE)
+    {
+        r = minMax(&data[start], (first + 1) * LEAF_SIZE - start);
+        first++;
+    }
+    if (end != std::min((last + 1) * LEAF_SIZE, _size))
+    {
+        r = combineLimits(r, minMax(&data[last * LEAF_SIZE], end - last * LEAF_SIZE));
+    }
+    else
+    {
+        last++;
+    }
+
+    // fully covered leaves [first, last)
+    for (unsigned l = base + first, h = base + last; l < h; l /= 2, h /= 2)
+    {
+        if (l & 1) r = combineLimits(r, nodes[l++]);
+        if (h & 1) r = combineLimits(r, nodes[--h]);
+    }
+
+    return r;
+}
+
+#define INSTANTIATE_PYRAMID(T)                                          \
+    template void MinMaxPyramid::build(const T*, unsigned);             \
+    template void MinMaxPyramid::update(const T*, unsigned, unsigned);  \
+    template Range MinMaxPyramid::limits(const T*, unsigned, unsigned) const;
+
+INSTANTIATE_PYRAMID(quint8)
+INSTANTIATE_PYRAMID(quint16)
+INSTANTIATE_PYRAMID(quint32)
+INSTANTIATE_PYRAMID(qint8)
+INSTANTIATE_PYRAMID(qint16)
+INSTANTIATE_PYRAMID(qint32)
+INSTANTIATE_PYRAMID(float)
+INSTANTIATE_PYRAMID(double)
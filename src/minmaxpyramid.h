@@ -0,0 +1,71 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include "framebuffer.h"
+
+/**
+ * A multi resolution min/max summary of an array.
+ *
+ * Data is divided into `LEAF_SIZE` long leaf blocks. Every level above
+ * covers 2 nodes of the level below, up to the root that covers whole
+ * array (basically a segment tree of leaf blocks). This makes it
+ * possible to calculate limits of any range of the data in O(log n)
+ * time and to update it in O(updated samples) time.
+ *
+ * Pyramid doesn't store a reference to the data. Owner must provide the
+ * same data array in every call. Data can be any of the sample types that
+ * `RingBufferT` is instantiated with.
+ */
+class MinMaxPyramid
+{
+public:
+    /// Number of samples covered by a leaf node
+    static const unsigned LEAF_SIZE = 64;
+
+    MinMaxPyramid();
+    ~MinMaxPyramid();
+
+    /// (Re)builds the pyramid for given data.
+    template <typename T> void build(const T* data, unsigned n);
+
+    /// Re-calculates nodes covering range [start, end) of the data. Should be
+    /// called after data is modified.
+    template <typename T> void update(const T* data, unsigned start, unsigned end);
+
+    /// Returns limits of the whole data in O(1) time.
+    Range limits() const;
+
+    /// Returns limits of data in range [start, end).
+    template <typename T> Range limits(const T* data, unsigned start, unsigned end) const;
+
+private:
+    unsigned _size;     ///< size of the data
+    unsigned numLeaves; ///< number of leaf nodes in use
+    unsigned base;      ///< index of first leaf, a power of 2
+    Range* nodes;       ///< node storage, `nodes[1]` is root, children of `i` are `2i` and `2i+1`
+
+    // non-copyable
+    MinMaxPyramid(const MinMaxPyramid&);
+    MinMaxPyramid& operator=(const MinMaxPyramid&);
+};
+
+#endif // MINMAXPYRAMID_H
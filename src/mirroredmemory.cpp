@@ -0,0 +1,126 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+
+#include "mirroredmemory.h"
+
+#if defined(Q_OS_LINUX) || defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef SYS_memfd_create
+#define MIRROR_SUPPORTED
+#endif
+#endif
+
+#ifdef MIRROR_SUPPORTED
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+size_t mirrorGranularity()
+{
+    return sysconf(_SC_PAGESIZE);
+}
+
+void* allocMirrored(size_t blockSize, unsigned numBlocks)
+{
+    Q_ASSERT(blockSize > 0 && blockSize % mirrorGranularity() == 0);
+    Q_ASSERT(numBlocks > 0);
+
+    size_t total = blockSize * numBlocks;
+
+    // memfd_create is called directly, glibc wrapper is quite recent
+    int fd = syscall(SYS_memfd_create, "serialplot-ring", MFD_CLOEXEC);
+    if (fd < 0) return nullptr;
+
+    if (ftruncate(fd, total) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    // reserve address space for all blocks and their mirrors
+    void* base = mmap(NULL, 2 * total, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    char* mem = static_cast<char*>(base);
+    bool failed = false;
+    for (unsigned i = 0; i < numBlocks && !failed; i++)
+    {
+        for (unsigned m = 0; m < 2; m++)
+        {
+            void* addr = mem + (2 * i + m) * blockSize;
+            void* r = mmap(addr, blockSize, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_FIXED, fd, i * blockSize);
+            if (r != addr)
+            {
+                failed = true;
+                break;
+            }
+        }
+    }
+
+    // mappings keep the file alive
+    close(fd);
+
+    if (failed)
+    {
+        munmap(base, 2 * total);
+        return nullptr;
+    }
+
+    return base;
+}
+
+void freeMirrored(void* mem, size_t blockSize, unsigned numBlocks)
+{
+    munmap(mem, 2 * blockSize * numBlocks);
+}
+
+#else
+
+size_t mirrorGranularity()
+{
+    return 0;
+}
+
+void* allocMirrored(size_t blockSize, unsigned numBlocks)
+{
+    Q_UNUSED(blockSize);
+    Q_UNUSED(numBlocks);
+    return nullptr;
+}
+
+void freeMirrored(void* mem, size_t blockSize, unsigned numBlocks)
+{
+    Q_UNUSED(mem);
+    Q_UNUSED(blockSize);
+    Q_UNUSED(numBlocks);
+    Q_ASSERT(false);            // never allocated
+}
+
+#endif // MIRROR_SUPPORTED
@@ -0,0 +1,54 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MIRROREDMEMORY_H
+#define MIRROREDMEMORY_H
+
+#include <stddef.h>
+
+/**
+ * @file mirroredmemory.h
+ *
+ * Mirrored memory is a block of memory that is mapped twice, back to
+ * back, in virtual address space. Writing past the end of a block
+ * continues from its beginning, which makes any window of up to block
+ * size in a ring buffer a contiguous range.
+ *
+ * Currently only implemented for Linux (memfd + mmap).
+ */
+
+/// Returns the size that mirrored blocks must be a multiple of. Returns 0
+/// if mirroring isn't supported on this platform.
+size_t mirrorGranularity();
+
+/**
+ * Allocates `numBlocks` blocks of `blockSize` bytes, each mapped twice.
+ * Blocks are placed one after another, so block `i` starts at
+ * `i * 2 * blockSize` bytes. Memory is zero initialized.
+ *
+ * @param blockSize must be a multiple of `mirrorGranularity()`
+ * @param numBlocks number of blocks, must be bigger than 0
+ * @return `nullptr` if mirroring isn't supported or mapping fails
+ */
+void* allocMirrored(size_t blockSize, unsigned numBlocks);
+
+/// Frees memory that is allocated with `allocMirrored()` with same parameters.
+void freeMirrored(void* mem, size_t blockSize, unsigned numBlocks);
+
+#endif // MIRROREDMEMORY_H
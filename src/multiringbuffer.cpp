@@ -0,0 +1,731 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+#include <algorithm>
+#include <string.h>
+
+#include "multiringbuffer.h"
+#include "minmax.h"
+#include "mirroredmemory.h"
+#include "parallelfor.h"
+#include "allocator.h"
+#include "compression.h"
+
+/// Minimum size of a channel in bytes to use mirrored memory
+static const size_t MIN_MIRRORED_SIZE = 64 * 1024;
+/// Minimum size of all channels in bytes to move them in parallel
+static const size_t MIN_PARALLEL_SIZE = 4 * 1024 * 1024;
+
+/// View of a single channel of a `MultiRingBufferT`.
+template <typename T>
+class MultiRingBufferT<T>::Channel : public FrameBuffer
+{
+public:
+    Channel(const MultiRingBufferT<T>* buffer, unsigned ci);
+
+    unsigned size() const override;
+    double sample(unsigned i) const override;
+    Range limits() const override;
+    Range rangeLimits(unsigned start, unsigned n) const override;
+    void copySamples(unsigned start, unsigned n, double* out) const override;
+
+private:
+    const MultiRingBufferT<T>* buffer;
+    unsigned ci;                  ///< channel index
+};
+
+/// Data of a snapshot, shared by its channel views.
+template <typename T>
+struct MultiRingBufferT<T>::Pin
+{
+    MultiRingBufferT<T>* buffer;  ///< `nullptr` when all chunks are copied
+    const T* data;                ///< data of buffer, valid while `buffer` is set
+    unsigned numChannels;
+    unsigned size;
+    unsigned capacity;            ///< ring length
+    unsigned stride;              ///< distance between channels in `data`
+    unsigned headIndex;           ///< physical index of sample `0`
+    unsigned numChunks;
+    /// Compressed copies of chunks, `numChannels` entries per chunk. Empty
+    /// (`data` is `nullptr`) while chunk is shared with the buffer.
+    QVector<CompressedBlock> copies;
+    /// Limits of each chunk, `numChannels` entries per chunk
+    QVector<Range> chunkLimits;
+    unsigned numShared;           ///< number of chunks that are still shared
+    unsigned numViews;            ///< pin is deleted with its last view
+
+    /// Returns length of chunk `c`, last chunk may be shorter.
+    unsigned chunkLength(unsigned c) const
+    {
+        return std::min(SNAPSHOT_CHUNK, capacity - c * SNAPSHOT_CHUNK);
+    }
+    bool isShared(unsigned c) const
+    {
+        return copies[c * numChannels].data == nullptr;
+    }
+    /// Returns data of channel `ci` in a shared chunk `c`.
+    const T* sharedData(unsigned c, unsigned ci) const
+    {
+        return data + (size_t) ci * stride + (size_t) c * SNAPSHOT_CHUNK;
+    }
+};
+
+/// View of a channel of a snapshot, see `MultiRingBufferT::snapshot()`.
+template <typename T>
+class MultiRingBufferT<T>::SnapshotChannel : public FrameBuffer
+{
+public:
+    SnapshotChannel(Pin* pin, unsigned ci);
+    ~SnapshotChannel();
+
+    unsigned size() const override;
+    double sample(unsigned i) const override;
+    Range limits() const override;
+    Range rangeLimits(unsigned start, unsigned n) const override;
+    void copySamples(unsigned start, unsigned n, double* out) const override;
+
+private:
+    Pin* pin;
+    unsigned ci;                  ///< channel index
+
+    /// Decompressed data of `cachedChunk`, allocated at first use
+    mutable double* cache;
+    mutable int cachedChunk;      ///< -1 if cache is empty
+
+    /// Returns decompressed data of a copied chunk
+    const double* decompressed(unsigned c) const;
+
+    /**
+     * Calls `func(c, offset, length)` for each chunk piece covering samples
+     * in range [start, start+n), in order.
+     */
+    template <typename F> void forEachPiece(unsigned start, unsigned n, F func) const;
+};
+
+template <typename T>
+MultiRingBufferT<T>::MultiRingBufferT(unsigned nc, unsigned n)
+{
+    Q_ASSERT(nc > 0 && n > 0);
+
+    _numChannels = nc;
+    _size = n;
+    mem = allocate(nc, n);
+    headIndex = 0;
+    numWritten = 0;
+
+    for (unsigned ci = 0; ci < nc; ci++)
+    {
+        summaries.append(new Summary);
+        buildSummary(ci);
+    }
+}
+
+template <typename T>
+MultiRingBufferT<T>::~MultiRingBufferT()
+{
+    detachAll();
+    qDeleteAll(summaries);
+    release(mem, _numChannels);
+}
+
+template <typename T>
+typename MultiRingBufferT<T>::Storage MultiRingBufferT<T>::allocate(unsigned nc, unsigned n)
+{
+    Storage s;
+
+    // try mirrored memory for big buffers, for small ones rounding to
+    // page size would waste too much
+    size_t granularity = mirrorGranularity();
+    if (granularity && sizeof(T) * n >= MIN_MIRRORED_SIZE)
+    {
+        size_t blockSize = (sizeof(T) * n + granularity - 1) / granularity * granularity;
+        s.data = static_cast<T*>(allocMirrored(blockSize, nc));
+        if (s.data != nullptr)
+        {
+            countMemory(MemoryUser_Channels, blockSize * nc);
+            s.capacity = blockSize / sizeof(T);
+            s.stride = 2 * s.capacity;
+            s.mirrored = true;
+            return s;
+        }
+    }
+
+    // each channel starts at an aligned address
+    const unsigned align = MEMORY_ALIGNMENT / sizeof(T);
+    s.capacity = n;
+    s.stride = (n + align - 1) / align * align;
+    s.mirrored = false;
+
+    // big blocks are fresh pages from the system which are already zero,
+    // unlike memset it doesn't have to touch all of them
+    s.data = static_cast<T*>(allocAligned(sizeof(T) * s.stride * nc, MemoryUser_Channels));
+    return s;
+}
+
+template <typename T>
+void MultiRingBufferT<T>::release(const Storage& storage, unsigned nc)
+{
+    if (storage.mirrored)
+    {
+        freeMirrored(storage.data, sizeof(T) * storage.capacity, nc);
+        countMemory(MemoryUser_Channels, -(ptrdiff_t) (sizeof(T) * storage.capacity * nc));
+    }
+    else
+    {
+        freeAligned(storage.data, sizeof(T) * storage.stride * nc, MemoryUser_Channels);
+    }
+}
+
+template <typename T>
+void MultiRingBufferT<T>::relayout(unsigned nc, unsigned n)
+{
+    detachAll();
+
+    // data is placed at the end of each ring, beginning is left as 0
+    unsigned numKeep = std::min(n, _size);
+    unsigned numMove = std::min(nc, _numChannels);
+    Storage oldMem = mem;
+    unsigned oldSize = _size;
+    unsigned oldHead = headIndex;
+    Storage newMem = allocate(nc, n);
+
+    while ((unsigned) summaries.size() < nc) summaries.append(new Summary);
+    while ((unsigned) summaries.size() > nc) delete summaries.takeLast();
+
+    // Each channel is moved with at most 2 bulk copies (ring may wrap
+    // around) and its summary is re-built while its data is still in
+    // cache. Channels are independent so big buffers are moved in
+    // parallel.
+    auto move = [&](unsigned ci)
+    {
+        T* dst = newMem.data + (size_t) ci * newMem.stride;
+        if (ci < numMove)
+        {
+            const T* src = oldMem.data + (size_t) ci * oldMem.stride;
+            unsigned pstart = oldHead + (oldSize - numKeep);
+            if (pstart >= oldMem.capacity) pstart -= oldMem.capacity;
+            unsigned n1 = oldMem.mirrored ? numKeep : std::min(numKeep, oldMem.capacity - pstart);
+            memcpy(dst + (n - numKeep), src + pstart, sizeof(T) * n1);
+            memcpy(dst + (n - numKeep) + n1, src, sizeof(T) * (numKeep - n1));
+        }
+        summaries[ci]->pyramid.build(static_cast<const T*>(dst), newMem.capacity);
+        summaries[ci]->updatedAt = numWritten;
+    };
+
+    if (sizeof(T) * (size_t) n * nc >= MIN_PARALLEL_SIZE && nc > 1)
+    {
+        parallelFor(nc, move);
+    }
+    else
+    {
+        for (unsigned ci = 0; ci < nc; ci++) move(ci);
+    }
+
+    release(oldMem, _numChannels);
+    mem = newMem;
+    _numChannels = nc;
+    _size = n;
+    headIndex = 0;
+}
+
+template <typename T>
+const T* MultiRingBufferT<T>::channelData(unsigned ci) const
+{
+    return mem.data + (size_t) ci * mem.stride;
+}
+
+template <typename T>
+unsigned MultiRingBufferT<T>::physical(unsigned i) const
+{
+    unsigned index = headIndex + i;
+    if (index >= mem.capacity) index -= mem.capacity;
+    return index;
+}
+
+template <typename T>
+unsigned MultiRingBufferT<T>::numChannels() const
+{
+    return _numChannels;
+}
+
+template <typename T>
+unsigned MultiRingBufferT<T>::size() const
+{
+    return _size;
+}
+
+template <typename T>
+bool MultiRingBufferT<T>::isMirrored() const
+{
+    return mem.mirrored;
+}
+
+template <typename T>
+void MultiRingBufferT<T>::setNumChannels(unsigned nc)
+{
+    Q_ASSERT(nc > 0);
+    if (nc == _numChannels) return;
+
+    relayout(nc, _size);
+}
+
+template <typename T>
+void MultiRingBufferT<T>::resize(unsigned n)
+{
+    Q_ASSERT(n != _size);
+
+    relayout(_numChannels, n);
+}
+
+template <typename T>
+void MultiRingBufferT<T>::addSamples(const SamplePackView& pack)
+{
+    Q_ASSERT(pack.numChannels() == _numChannels);
+
+    unsigned ns = pack.numSamples();
+    // only the last `_size` samples fit
+    unsigned skip = ns > _size ? ns - _size : 0;
+    unsigned n = ns - skip;
+    // new samples are written after the last sample
+    unsigned writeIndex = physical(_size);
+    detach(writeIndex, n);
+    // if not mirrored, first part is written until end of array, rest
+    // continues from the beginning
+    unsigned n1 = mem.mirrored ? n : std::min(n, mem.capacity - writeIndex);
+
+    for (unsigned ci = 0; ci < _numChannels; ci++)
+    {
+        const double* src = pack.data(ci) + skip;
+        T* dst = mem.data + (size_t) ci * mem.stride;
+        std::copy(src, src + n1, dst + writeIndex);
+        std::copy(src + n1, src + n, dst);
+    }
+
+    headIndex = physical(n);
+    numWritten += ns;
+}
+
+template <typename T>
+void MultiRingBufferT<T>::clear()
+{
+    detachAll();
+    for (unsigned ci = 0; ci < _numChannels; ci++)
+    {
+        memset(mem.data + (size_t) ci * mem.stride, 0, sizeof(T) * mem.capacity);
+        buildSummary(ci);
+    }
+    headIndex = 0;
+}
+
+template <typename T>
+void MultiRingBufferT<T>::copySamples(unsigned ci, unsigned start, unsigned n,
+                                      double* out) const
+{
+    Q_ASSERT(ci < _numChannels);
+
+    copyTo(ci, start, n, out);
+}
+
+template <typename T>
+FrameBuffer* MultiRingBufferT<T>::makeChannel(unsigned ci) const
+{
+    Q_ASSERT(ci < _numChannels);
+
+    return new Channel(this, ci);
+}
+
+template <typename T> template <typename D>
+void MultiRingBufferT<T>::copyTo(unsigned ci, unsigned start, unsigned n, D* out) const
+{
+    Q_ASSERT(start + n <= _size);
+
+    const T* cdata = channelData(ci);
+    unsigned pstart = physical(start);
+
+    // first segment is until the end of ring, second one wraps around
+    unsigned n1 = mem.mirrored ? n : std::min(n, mem.capacity - pstart);
+    std::copy(cdata + pstart, cdata + pstart + n1, out);
+    std::copy(cdata, cdata + (n - n1), out + n1);
+}
+
+template <typename T>
+MultiRingBufferT<T>::Channel::Channel(const MultiRingBufferT<T>* buffer, unsigned ci)
+{
+    this->buffer = buffer;
+    this->ci = ci;
+}
+
+template <typename T>
+unsigned MultiRingBufferT<T>::Channel::size() const
+{
+    return buffer->_size;
+}
+
+template <typename T>
+double MultiRingBufferT<T>::Channel::sample(unsigned i) const
+{
+    return buffer->channelData(ci)[buffer->physical(i)];
+}
+
+template <typename T>
+Range MultiRingBufferT<T>::Channel::limits() const
+{
+    // pyramid covers the whole ring, which is longer than the data when
+    // mirrored
+    if (buffer->mem.capacity != buffer->_size)
+    {
+        return rangeLimits(0, buffer->_size);
+    }
+
+    buffer->updateSummary(ci);
+    return buffer->summaries[ci]->pyramid.limits();
+}
+
+template <typename T>
+Range MultiRingBufferT<T>::Channel::rangeLimits(unsigned start, unsigned n) const
+{
+    Q_ASSERT(n > 0 && start + n <= buffer->_size);
+
+    buffer->updateSummary(ci);
+    const MinMaxPyramid& pyramid = buffer->summaries[ci]->pyramid;
+
+    // pyramid doesn't know about mirroring, range is split at the wrap point
+    const T* cdata = buffer->channelData(ci);
+    unsigned capacity = buffer->mem.capacity;
+    unsigned pstart = buffer->physical(start);
+
+    if (pstart + n <= capacity) // no wrap around
+    {
+        return pyramid.limits(cdata, pstart, pstart + n);
+    }
+    else
+    {
+        return combineLimits(pyramid.limits(cdata, pstart, capacity),
+                             pyramid.limits(cdata, 0, pstart + n - capacity));
+    }
+}
+
+template <typename T>
+void MultiRingBufferT<T>::Channel::copySamples(unsigned start, unsigned n, double* out) const
+{
+    buffer->copyTo(ci, start, n, out);
+}
+
+template <typename T>
+void MultiRingBufferT<T>::buildSummary(unsigned ci) const
+{
+    summaries[ci]->pyramid.build(channelData(ci), mem.capacity);
+    summaries[ci]->updatedAt = numWritten;
+}
+
+template <typename T>
+void MultiRingBufferT<T>::updateSummary(unsigned ci) const
+{
+    Summary* summary = summaries[ci];
+    const T* cdata = channelData(ci);
+    unsigned capacity = mem.capacity;
+
+    quint64 numDirty = numWritten - summary->updatedAt;
+    if (numDirty == 0) return;
+
+    if (numDirty >= capacity)
+    {
+        summary->pyramid.update(cdata, 0, capacity);
+    }
+    else
+    {
+        // dirty samples are in range [dirtyStart, dirtyEnd) (may wrap around)
+        unsigned dirtyEnd = headIndex + _size;
+        if (dirtyEnd > capacity) dirtyEnd -= capacity;
+        unsigned dirtyStart = dirtyEnd >= numDirty ?
+            dirtyEnd - numDirty : dirtyEnd + capacity - numDirty;
+
+        if (dirtyStart < dirtyEnd) // no wrap around
+        {
+            summary->pyramid.update(cdata, dirtyStart, dirtyEnd);
+        }
+        else
+        {
+            summary->pyramid.update(cdata, dirtyStart, capacity);
+            summary->pyramid.update(cdata, 0, dirtyEnd);
+        }
+    }
+
+    summary->updatedAt = numWritten;
+}
+
+template <typename T>
+QVector<FrameBuffer*> MultiRingBufferT<T>::snapshot()
+{
+    auto pin = new Pin;
+    pin->buffer = this;
+    pin->data = mem.data;
+    pin->numChannels = _numChannels;
+    pin->size = _size;
+    pin->capacity = mem.capacity;
+    pin->stride = mem.stride;
+    pin->headIndex = headIndex;
+    unsigned numChunks = (mem.capacity + SNAPSHOT_CHUNK - 1) / SNAPSHOT_CHUNK;
+    pin->numChunks = numChunks;
+    pin->copies.fill({nullptr, 0, 0}, numChunks * _numChannels);
+    pin->numShared = numChunks;
+    pin->numViews = _numChannels;
+
+    // limits of chunks are taken from summaries, data isn't scanned
+    pin->chunkLimits.resize(numChunks * _numChannels);
+    for (unsigned ci = 0; ci < _numChannels; ci++)
+    {
+        updateSummary(ci);
+        const T* cdata = channelData(ci);
+        for (unsigned c = 0; c < numChunks; c++)
+        {
+            unsigned start = c * SNAPSHOT_CHUNK;
+            pin->chunkLimits[c * _numChannels + ci] =
+                summaries[ci]->pyramid.limits(cdata, start, start + pin->chunkLength(c));
+        }
+    }
+    pins.append(pin);
+
+    QVector<FrameBuffer*> views;
+    for (unsigned ci = 0; ci < _numChannels; ci++)
+    {
+        views.append(new SnapshotChannel(pin, ci));
+    }
+    return views;
+}
+
+template <typename T>
+void MultiRingBufferT<T>::copyChunk(Pin* pin, unsigned c) const
+{
+    Q_ASSERT(pin->isShared(c));
+
+    // snapshots live long, copies are kept compressed
+    for (unsigned ci = 0; ci < pin->numChannels; ci++)
+    {
+        pin->copies[c * pin->numChannels + ci] =
+            compressBlock(pin->sharedData(c, ci), pin->chunkLength(c), MemoryUser_Snapshots);
+    }
+    pin->numShared--;
+}
+
+template <typename T>
+void MultiRingBufferT<T>::detach(unsigned start, unsigned n)
+{
+    if (pins.isEmpty() || n == 0) return;
+
+    // chunks covering the range, it may wrap around
+    unsigned numChunks = (mem.capacity + SNAPSHOT_CHUNK - 1) / SNAPSHOT_CHUNK;
+    unsigned first = start / SNAPSHOT_CHUNK;
+    unsigned count;
+    if (n >= mem.capacity)
+    {
+        count = numChunks;
+    }
+    else
+    {
+        unsigned end = start + n - 1;
+        if (end >= mem.capacity) end -= mem.capacity;
+        unsigned last = end / SNAPSHOT_CHUNK;
+        count = last >= first ? last - first + 1 : numChunks - first + last + 1;
+        // range may start and end in the same chunk after wrapping around
+        if (last == first && end < start) count = numChunks;
+    }
+
+    for (int i = pins.size() - 1; i >= 0; i--)
+    {
+        Pin* pin = pins[i];
+        for (unsigned k = 0, c = first; k < count; k++)
+        {
+            if (pin->isShared(c)) copyChunk(pin, c);
+            if (++c == numChunks) c = 0;
+        }
+
+        if (pin->numShared == 0)
+        {
+            pin->buffer = nullptr;
+            pins.removeAt(i);
+        }
+    }
+}
+
+template <typename T>
+void MultiRingBufferT<T>::detachAll()
+{
+    for (auto pin : pins)
+    {
+        for (unsigned c = 0; c < pin->numChunks; c++)
+        {
+            if (pin->isShared(c)) copyChunk(pin, c);
+        }
+        pin->buffer = nullptr;
+    }
+    pins.clear();
+}
+
+template <typename T>
+MultiRingBufferT<T>::SnapshotChannel::SnapshotChannel(Pin* pin, unsigned ci)
+{
+    this->pin = pin;
+    this->ci = ci;
+    cache = nullptr;
+    cachedChunk = -1;
+}
+
+template <typename T>
+MultiRingBufferT<T>::SnapshotChannel::~SnapshotChannel()
+{
+    freeAligned(cache, sizeof(double) * SNAPSHOT_CHUNK, MemoryUser_Snapshots);
+    if (--pin->numViews) return;
+
+    if (pin->buffer != nullptr)
+    {
+        pin->buffer->pins.removeOne(pin);
+    }
+    for (auto& block : pin->copies)
+    {
+        if (block.data != nullptr) releaseBlock(block, MemoryUser_Snapshots);
+    }
+    delete pin;
+}
+
+template <typename T>
+const double* MultiRingBufferT<T>::SnapshotChannel::decompressed(unsigned c) const
+{
+    if (cachedChunk != (int) c)
+    {
+        if (cache == nullptr)
+        {
+            cache = static_cast<double*>(allocAligned(sizeof(double) * SNAPSHOT_CHUNK,
+                                                      MemoryUser_Snapshots));
+        }
+        decompressBlock(pin->copies[c * pin->numChannels + ci], cache);
+        cachedChunk = c;
+    }
+    return cache;
+}
+
+template <typename T>
+unsigned MultiRingBufferT<T>::SnapshotChannel::size() const
+{
+    return pin->size;
+}
+
+template <typename T>
+double MultiRingBufferT<T>::SnapshotChannel::sample(unsigned i) const
+{
+    unsigned p = pin->headIndex + i;
+    if (p >= pin->capacity) p -= pin->capacity;
+
+    unsigned c = p / SNAPSHOT_CHUNK;
+    if (pin->isShared(c))
+    {
+        return pin->sharedData(c, ci)[p % SNAPSHOT_CHUNK];
+    }
+    return decompressed(c)[p % SNAPSHOT_CHUNK];
+}
+
+template <typename T> template <typename F>
+void MultiRingBufferT<T>::SnapshotChannel::forEachPiece(unsigned start, unsigned n, F func) const
+{
+    Q_ASSERT(start + n <= pin->size);
+
+    unsigned p = pin->headIndex + start;
+    if (p >= pin->capacity) p -= pin->capacity;
+
+    while (n > 0)
+    {
+        unsigned c = p / SNAPSHOT_CHUNK;
+        unsigned offset = p % SNAPSHOT_CHUNK;
+        unsigned length = std::min(n, pin->chunkLength(c) - offset);
+        func(c, offset, length);
+
+        n -= length;
+        p += length;
+        if (p == pin->capacity) p = 0;
+    }
+}
+
+template <typename T>
+Range MultiRingBufferT<T>::SnapshotChannel::limits() const
+{
+    return rangeLimits(0, pin->size);
+}
+
+template <typename T>
+Range MultiRingBufferT<T>::SnapshotChannel::rangeLimits(unsigned start, unsigned n) const
+{
+    Q_ASSERT(n > 0 && start + n <= pin->size);
+
+    Range result = {0, 0};
+    bool first = true;
+    forEachPiece(start, n, [this, &result, &first](unsigned c, unsigned offset, unsigned length)
+        {
+            // only partial chunks at the ends are scanned
+            Range r;
+            if (length == pin->chunkLength(c))
+            {
+                r = pin->chunkLimits[c * pin->numChannels + ci];
+            }
+            else if (pin->isShared(c))
+            {
+                r = minMax(pin->sharedData(c, ci) + offset, length);
+            }
+            else
+            {
+                r = minMax(decompressed(c) + offset, length);
+            }
+            result = first ? r : combineLimits(result, r);
+            first = false;
+        });
+    return result;
+}
+
+template <typename T>
+void MultiRingBufferT<T>::SnapshotChannel::copySamples(unsigned start, unsigned n, double* out) const
+{
+    forEachPiece(start, n, [this, &out](unsigned c, unsigned offset, unsigned length)
+        {
+            if (pin->isShared(c))
+            {
+                const T* src = pin->sharedData(c, ci) + offset;
+                std::copy(src, src + length, out);
+            }
+            else if (length == pin->chunkLength(c) && (int) c != cachedChunk)
+            {
+                // whole chunk is decompressed directly to output
+                decompressBlock(pin->copies[c * pin->numChannels + ci], out);
+            }
+            else
+            {
+                const double* src = decompressed(c) + offset;
+                std::copy(src, src + length, out);
+            }
+            out += length;
+        });
+}
+
+template class MultiRingBufferT<quint8>;
+template class MultiRingBufferT<quint16>;
+template class MultiRingBufferT<quint32>;
+template class MultiRingBufferT<qint8>;
+template class MultiRingBufferT<qint16>;
+template class MultiRingBufferT<qint32>;
+template class MultiRingBufferT<float>;
+template class MultiRingBufferT<double>;
@@ -0,0 +1,189 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MULTIRINGBUFFER_H
+#define MULTIRINGBUFFER_H
+
+#include <QtGlobal>
+#include <QList>
+#include <QVector>
+
+#include "framebuffer.h"
+#include "samplepackview.h"
+#include "minmaxpyramid.h"
+
+/**
+ * Storage for all channels of a stream in a single allocation.
+ *
+ * Every channel is a ring of the same size and they all share the
+ * same head index, so adding a pack of samples moves the head only
+ * once. Channels are laid out one after another (not interleaved) and
+ * each of them starts at a cache line aligned address, so that per
+ * channel operations (limits, plotting) still work on contiguous data.
+ *
+ * Channels are accessed through `FrameBuffer` views that are created
+ * with `makeChannel()`.
+ *
+ * Where supported (see `mirroredmemory.h`) big buffers are placed in
+ * mirrored memory. Then every window of a channel is a single contiguous
+ * range, so writes and copies don't have to be split at the wrap
+ * point. If mirroring fails regular memory is used.
+ *
+ * Resizing doesn't stall on big buffers: new storage is zeroed lazily by
+ * the system, only the kept samples are copied (in bulk) and channels are
+ * moved in parallel. Limit summaries are re-built during the move, so
+ * they stay valid after a resize.
+ */
+class MultiRingBuffer
+{
+public:
+    /// Length of chunks that snapshots share with the buffer, see `snapshot()`
+    static const unsigned SNAPSHOT_CHUNK = 4096;
+
+    /// Placeholder virtual destructor
+    virtual ~MultiRingBuffer() {};
+
+    /// Returns number of channels.
+    virtual unsigned numChannels() const = 0;
+    /// Returns size of each channel.
+    virtual unsigned size() const = 0;
+
+    /// Changes number of channels. Data of remaining channels is kept.
+    virtual void setNumChannels(unsigned nc) = 0;
+    /// Resizes all channels, keeping the end values.
+    virtual void resize(unsigned n) = 0;
+    /// Adds a sample pack. Pack must be planar and have the same number
+    /// of channels.
+    virtual void addSamples(const SamplePackView& pack) = 0;
+    /// Reset all data to 0
+    virtual void clear() = 0;
+    /// Returns true if data is in mirrored memory
+    virtual bool isMirrored() const = 0;
+    /// Copies `n` samples of channel `ci` starting from `start` to `out`.
+    virtual void copySamples(unsigned ci, unsigned start, unsigned n,
+                             double* out) const = 0;
+
+    /**
+     * Returns a new view of a channel. Caller takes ownership.
+     *
+     * @important View must be deleted before its channel is removed or
+     * this buffer is deleted.
+     */
+    virtual FrameBuffer* makeChannel(unsigned ci) const = 0;
+
+    /**
+     * Returns views of all channels that keep their current data even
+     * if the buffer is modified later. Caller takes ownership.
+     *
+     * Data isn't copied right away. Rings are divided into
+     * `SNAPSHOT_CHUNK` long chunks and views refer to data of the buffer
+     * until a chunk is about to be overwritten (or buffer is
+     * cleared, resized or deleted). Only then the chunk is copied to
+     * views, compressed (see `compression.h`). Taking a snapshot is
+     * O(chunks) and memory only grows by the compressed size of what
+     * is overwritten.
+     */
+    virtual QVector<FrameBuffer*> snapshot() = 0;
+};
+
+/// `MultiRingBuffer` that stores samples as `T`. See `RingBufferT`.
+template <typename T>
+class MultiRingBufferT : public MultiRingBuffer
+{
+public:
+    MultiRingBufferT(unsigned nc, unsigned n);
+    ~MultiRingBufferT();
+
+    unsigned numChannels() const override;
+    unsigned size() const override;
+    void setNumChannels(unsigned nc) override;
+    void resize(unsigned n) override;
+    void addSamples(const SamplePackView& pack) override;
+    void clear() override;
+    bool isMirrored() const override;
+    void copySamples(unsigned ci, unsigned start, unsigned n,
+                     double* out) const override;
+    FrameBuffer* makeChannel(unsigned ci) const override;
+    QVector<FrameBuffer*> snapshot() override;
+
+private:
+    class Channel;
+    class SnapshotChannel;
+    struct Pin;
+
+    /// Memory of all channels
+    struct Storage
+    {
+        T* data;
+        /// Length of each ring. Same as `size()` unless mirrored, in that case
+        /// it's rounded up to `mirrorGranularity()`.
+        unsigned capacity;
+        unsigned stride;       ///< distance between starts of channels
+        bool mirrored;         ///< each ring is followed by its mirror
+    };
+
+    /// Min/max summary of a channel, shared by all views of it
+    struct Summary
+    {
+        MinMaxPyramid pyramid;
+        quint64 updatedAt;     ///< `numWritten` at last pyramid update
+    };
+
+    unsigned _numChannels;
+    unsigned _size;            ///< size of each channel
+    Storage mem;
+    unsigned headIndex;        ///< physical index of sample `0` of all rings
+
+    /// Number of samples written to each channel, used to find the
+    /// modified part of data.
+    quint64 numWritten;
+    /// Summaries are updated lazily when limits are requested, except
+    /// after a resize or clear, in that case they are re-built right away.
+    mutable QList<Summary*> summaries;
+    /// Snapshots that still share chunks with this buffer
+    QList<Pin*> pins;
+
+    /// Allocates zeroed storage for `nc` channels of `n` samples. See
+    /// `allocAligned()`.
+    static Storage allocate(unsigned nc, unsigned n);
+    /// Frees storage allocated for `nc` channels.
+    static void release(const Storage& storage, unsigned nc);
+    /// Moves data to a new storage for `nc` channels of `n` samples.
+    void relayout(unsigned nc, unsigned n);
+    /// Returns start of a channels data.
+    const T* channelData(unsigned ci) const;
+    /// Returns physical index of sample `i`. `i` can be up to `size()`.
+    unsigned physical(unsigned i) const;
+    /// Copies `n` samples of channel `ci` starting from `start` to `out`.
+    template <typename D> void copyTo(unsigned ci, unsigned start,
+                                      unsigned n, D* out) const;
+    /// Re-builds summary of a channel from scratch.
+    void buildSummary(unsigned ci) const;
+    /// Updates summary of a channel for samples written since last update.
+    void updateSummary(unsigned ci) const;
+    /// Copies chunks in physical range [start, start+n) (may wrap around) to
+    /// snapshots that still share them. Called before they are overwritten.
+    void detach(unsigned start, unsigned n);
+    /// Copies all shared chunks to snapshots, they don't refer to buffer after this.
+    void detachAll();
+    /// Copies chunk `c` of the buffer to `pin`.
+    void copyChunk(Pin* pin, unsigned c) const;
+};
+
+#endif // MULTIRINGBUFFER_H
@@ -25,7 +25,8 @@
 #include "portcontrol.h"
 
 OmitStreamReader::OmitStreamReader(QIODevice* device, QObject* parent) :
-    AbstractReader(device, parent)
+    AbstractReader(device, parent),
+    _datastreamtimer(this)      // moves to reader thread with the reader
 {
     paused = false;
     skipByteRequested = false;
@@ -41,27 +42,44 @@ OmitStreamReader::OmitStreamReader(QIODevice* device, QObject* parent) :
 
     connect(&_datastreamtimer,&QTimer::timeout,this,&OmitStreamReader::into_data_head);
 
+    // settings are applied in reader thread, see `AbstractReader`
     connect(&_settingsWidget, &OmitStreamReaderSettings::numOfChannelsChanged,
-                     this, &OmitStreamReader::onNumOfChannelsChanged);
+            [this](unsigned value)
+            {
+                runInReaderThread([this, value]() {onNumOfChannelsChanged(value);});
+            });
 
     _numOmitByte = _settingsWidget.numOfOmitByte();
     connect(&_settingsWidget, &OmitStreamReaderSettings::numOfOmitByteChanged,
-                     this, &OmitStreamReader::onNumOfOmitByteChanged);
+            [this](unsigned value)
+            {
+                runInReaderThread([this, value]() {onNumOfOmitByteChanged(value);});
+            });
     // initial number format selection
     onNumberFormatChanged(_settingsWidget.numberFormat());
     connect(&_settingsWidget, &OmitStreamReaderSettings::numberFormatChanged,
-            this, &OmitStreamReader::onNumberFormatChanged);
+            [this](NumberFormat nf)
+            {
+                runInReaderThread([this, nf]() {onNumberFormatChanged(nf);});
+            });
+
+    endianness = _settingsWidget.endianness();
+    connect(&_settingsWidget, &OmitStreamReaderSettings::endiannessChanged,
+            [this](Endianness e)
+            {
+                runInReaderThread([this, e]() {endianness = e;});
+            });
 
     // enable skip byte and sample buttons
     connect(&_settingsWidget, &OmitStreamReaderSettings::skipByteRequested,
             [this]()
             {
-                skipByteRequested = true;
+                runInReaderThread([this]() {skipByteRequested = true;});
             });
     connect(&_settingsWidget, &OmitStreamReaderSettings::skipSampleRequested,
             [this]()
             {
-                skipSampleRequested = true;
+                runInReaderThread([this]() {skipSampleRequested = true;});
             });
 }
 
@@ -80,6 +98,7 @@ unsigned OmitStreamReader::numOmitByte() const
 }
 void OmitStreamReader::onNumberFormatChanged(NumberFormat numberFormat)
 {
+    _numberFormat = numberFormat;
     switch(numberFormat)
     {
         case NumberFormat_uint8:
@@ -149,7 +168,7 @@ template<typename T> double OmitStreamReader::readSampleAs()
 {
     T data;
     QByteArray data2num;
-    switch (_settingsWidget.numberFormat()) {
+    switch (_numberFormat) {
         case NumberFormat_uint8:
             data2num = Read_Buff.left(1);
             Read_Buff = Read_Buff.right(Read_Buff.length() - 1);
@@ -187,7 +206,7 @@ template<typename T> double OmitStreamReader::readSampleAs()
             break;
     }
     memcpy(&data,data2num,data2num.size());
-    if (_settingsWidget.endianness() == LittleEndian)
+    if (endianness == LittleEndian)
     {
         data = qFromLittleEndian(data);
     }
@@ -51,6 +51,8 @@ private:
 
     unsigned _numChannels;
     unsigned _numOmitByte;
+    NumberFormat _numberFormat;  ///< copy of selection in settings widget
+    Endianness endianness;      ///< copy of selection in settings widget
     unsigned sampleSize;
     bool skipByteRequested;
     bool skipSampleRequested;
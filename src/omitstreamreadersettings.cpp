@@ -46,6 +46,8 @@ OmitStreamReaderSettings::OmitStreamReaderSettings(QWidget *parent) :
             });
     connect(ui->nfBox, SIGNAL(selectionChanged(NumberFormat)),
             this, SIGNAL(numberFormatChanged(NumberFormat)));
+    connect(ui->endiBox, SIGNAL(selectionChanged(Endianness)),
+            this, SIGNAL(endiannessChanged(Endianness)));
 
 
 }
@@ -52,6 +52,7 @@ signals:
     void numOfChannelsChanged(unsigned);
     void numOfOmitByteChanged(unsigned);
     void numberFormatChanged(NumberFormat);
+    void endiannessChanged(Endianness);
     void skipByteRequested();
     void skipSampleRequested();
 
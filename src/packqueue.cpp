@@ -0,0 +1,304 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "packqueue.h"
+
+bool PackQueue::Config::operator==(const Config& other) const
+{
+    return numChannels == other.numChannels && hasX == other.hasX &&
+        numberFormat == other.numberFormat;
+}
+
+PackQueue::PackQueue(unsigned capacity, OverflowPolicy policy)
+{
+    Q_ASSERT(capacity > 0);
+
+    _capacity = capacity;
+    _policy = policy;
+    applied = {0, false, NumberFormat_double};
+    fed = applied;
+    latest = applied;
+    configSeq = 0;
+    appliedSeq = 0;
+
+    // packs are empty, their storage is allocated with the first data
+    for (unsigned i = 0; i < capacity; i++)
+    {
+        ring.append({new SamplePack, false, applied});
+    }
+
+    consumerThread = std::this_thread::get_id();
+    head = 0;
+    tail = 0;
+    notified = false;
+    _overflows = 0;
+    _droppedPacks = 0;
+    _droppedSamples = 0;
+}
+
+PackQueue::~PackQueue()
+{
+    for (auto& slot : ring)
+    {
+        delete slot.pack;
+    }
+}
+
+unsigned PackQueue::capacity() const
+{
+    return _capacity;
+}
+
+PackQueue::OverflowPolicy PackQueue::policy() const
+{
+    return static_cast<OverflowPolicy>(_policy.load());
+}
+
+void PackQueue::setPolicy(OverflowPolicy policy)
+{
+    _policy = policy;
+}
+
+quint64 PackQueue::overflows() const
+{
+    return _overflows;
+}
+
+quint64 PackQueue::droppedPacks() const
+{
+    return _droppedPacks;
+}
+
+quint64 PackQueue::droppedSamples() const
+{
+    return _droppedSamples;
+}
+
+void PackQueue::setPendingCallback(std::function<void()> callback)
+{
+    pendingCallback = callback;
+}
+
+unsigned PackQueue::pending() const
+{
+    return head.load(std::memory_order_acquire) -
+        (tail.load(std::memory_order_acquire) & ~CLAIMED);
+}
+
+bool PackQueue::hasX() const
+{
+    return applied.hasX;
+}
+
+unsigned PackQueue::numChannels() const
+{
+    return applied.numChannels;
+}
+
+NumberFormat PackQueue::numberFormat() const
+{
+    return applied.numberFormat;
+}
+
+void PackQueue::setNumChannels(unsigned nc, bool x)
+{
+    // format of the source is read while it's known to be in this configuration
+    auto source = connectedSource();
+    fed = {nc, x, source == nullptr ? NumberFormat_double : source->numberFormat()};
+
+    {
+        std::lock_guard<std::mutex> guard(configLock);
+        latest = fed;
+        configSeq++;
+    }
+    notify();
+}
+
+void PackQueue::notify()
+{
+    if (pendingCallback && !notified.exchange(true))
+    {
+        pendingCallback();
+    }
+}
+
+void PackQueue::feedIn(const SamplePackView& data)
+{
+    Q_ASSERT(data.numChannels() == fed.numChannels && data.hasX() == fed.hasX);
+
+    quint64 h = head.load(std::memory_order_relaxed);
+    if (h - (tail.load(std::memory_order_acquire) & ~CLAIMED) >= _capacity)
+    {
+        _overflows++;
+        if (!makeSpace(h))
+        {
+            _droppedPacks++;
+            _droppedSamples += data.numSamples();
+            return;
+        }
+    }
+
+    copyToSlot(h % _capacity, data);
+    head.store(h + 1, std::memory_order_release);
+    notify();
+}
+
+bool PackQueue::makeSpace(quint64 h)
+{
+    while (true)
+    {
+        quint64 t = tail.load(std::memory_order_acquire);
+        if (h - (t & ~CLAIMED) < _capacity) return true;
+
+        if (policy() == Block)
+        {
+            if (std::this_thread::get_id() == consumerThread)
+            {
+                drain();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+        else // DropOldest
+        {
+            // consumer is reading the oldest pack, which is also the
+            // slot we would write to
+            if (t & CLAIMED) return false;
+
+            if (tail.compare_exchange_weak(t, t + 1, std::memory_order_acq_rel))
+            {
+                _droppedPacks++;
+                _droppedSamples += ring[t % _capacity].pack->numSamples();
+                return true;
+            }
+        }
+    }
+}
+
+void PackQueue::copyToSlot(unsigned i, const SamplePackView& data)
+{
+    Slot& slot = ring[i];
+    slot.config = fed;
+
+    SamplePack* pack = slot.pack;
+    unsigned ns = data.numSamples();
+    if (pack->numSamples() != ns ||
+        pack->numChannels() != data.numChannels() ||
+        pack->hasX() != data.hasX())
+    {
+        *pack = SamplePack(ns, data.numChannels(), data.hasX());
+    }
+
+    // block of the pack is the same size for rows, layout of `data` is kept
+    slot.interleaved = !data.isPlanar();
+    if (slot.interleaved)
+    {
+        data.copyRows(pack->data(0));
+        return;
+    }
+
+    if (data.hasX())
+    {
+        data.copyX(0, ns, pack->xData());
+    }
+    for (unsigned ci = 0; ci < data.numChannels(); ci++)
+    {
+        data.copyChannel(ci, 0, ns, pack->data(ci));
+    }
+}
+
+SamplePackView PackQueue::slotView(unsigned i) const
+{
+    const Slot& slot = ring.at(i);
+    const SamplePack* pack = slot.pack;
+    if (slot.interleaved)
+    {
+        // X is at the start of block when stored as rows
+        return SamplePackView::interleaved(pack->numSamples(), pack->numChannels(),
+                                           pack->data(0), pack->hasX());
+    }
+    return SamplePackView(*pack);
+}
+
+void PackQueue::apply(const Config& config)
+{
+    if (config == applied) return;
+
+    applied = config;
+    Sink::setNumChannels(config.numChannels, config.hasX);
+    updateNumChannels();
+}
+
+unsigned PackQueue::drain()
+{
+    Q_ASSERT(std::this_thread::get_id() == consumerThread);
+
+    // anything fed from now on needs another drain
+    notified = false;
+
+    unsigned n = 0;
+    while (true)
+    {
+        quint64 t = tail.load(std::memory_order_acquire);
+        while (t != head.load(std::memory_order_acquire))
+        {
+            // claim the slot so that producer doesn't drop it while reading
+            if (!tail.compare_exchange_strong(t, t | CLAIMED, std::memory_order_acq_rel))
+            {
+                continue;       // dropped by producer, `t` is updated
+            }
+
+            unsigned i = t % _capacity;
+            apply(ring[i].config);
+            feedOut(slotView(i));
+            tail.store(t + 1, std::memory_order_release);
+            t++;
+            n++;
+        }
+
+        if (configSeq.load(std::memory_order_acquire) == appliedSeq) break;
+
+        Config config;
+        quint64 seq;
+        {
+            std::lock_guard<std::mutex> guard(configLock);
+            config = latest;
+            seq = configSeq;
+        }
+        // packs that are fed before the change must be passed first
+        if (head.load(std::memory_order_acquire) !=
+            (tail.load(std::memory_order_acquire) & ~CLAIMED)) continue;
+
+        appliedSeq = seq;
+        apply(config);
+        break;
+    }
+    return n;
+}
+
+void PackQueue::clear()
+{
+    Q_ASSERT(std::this_thread::get_id() == consumerThread);
+
+    quint64 t = tail.load(std::memory_order_acquire);
+    while (!tail.compare_exchange_weak(t, head.load(std::memory_order_acquire),
+                                       std::memory_order_acq_rel));
+}
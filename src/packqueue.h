@@ -0,0 +1,164 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PACKQUEUE_H
+#define PACKQUEUE_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <QtGlobal>
+#include <QVector>
+
+#include "source.h"
+#include "sink.h"
+
+/**
+ * A lock-free single producer, single consumer queue of sample packs.
+ *
+ * Sits between a `Source` (producer) and its sinks (consumers). Packs
+ * that are fed in are copied into preallocated packs, they are passed
+ * to connected sinks when `drain()` is called. Interleaved data stays
+ * interleaved, so sinks that read rows don't get a transposed copy.
+ * This way consumers handle everything that is pending in one pass
+ * instead of per pack.
+ *
+ * `drain()` must be called from the thread that created the queue
+ * (consumer thread). `feedIn` and `setNumChannels` may be called from
+ * any single thread (producer thread). Channel configuration travels
+ * with the packs, sinks are updated when the consumer reaches the
+ * first pack of a new configuration.
+ */
+class PackQueue : public Source, public Sink
+{
+public:
+    /// What to do when a pack is fed while the queue is full
+    enum OverflowPolicy
+    {
+        /// Wait until there is space. If producer is the consumer
+        /// thread, queue is drained instead.
+        Block,
+        /// Drop the oldest pending pack. If consumer is reading it at
+        /// the moment, incoming pack is dropped instead.
+        DropOldest
+    };
+
+    /**
+     * @param capacity maximum number of pending packs
+     * @param policy overflow policy
+     */
+    explicit PackQueue(unsigned capacity = 1024, OverflowPolicy policy = Block);
+    ~PackQueue();
+
+    /// Feeds all pending packs to connected sinks. Returns number of
+    /// packs fed.
+    unsigned drain();
+    /// Drops all pending packs without feeding them
+    void clear();
+    /// Number of pending packs
+    unsigned pending() const;
+
+    unsigned capacity() const;
+    OverflowPolicy policy() const;
+    void setPolicy(OverflowPolicy policy);
+
+    /// Number of times a pack was fed while the queue was full
+    quint64 overflows() const;
+    /// Number of dropped packs, only with `DropOldest` policy
+    quint64 droppedPacks() const;
+    /// Number of samples in dropped packs
+    quint64 droppedSamples() const;
+
+    /**
+     * Sets a function that is called from producer thread when there
+     * is something new to drain. It's called once until the next
+     * `drain()`, so it can post a drain request to the consumer.
+     */
+    void setPendingCallback(std::function<void()> callback);
+
+    // implementations for `Source`
+    bool hasX() const override;
+    unsigned numChannels() const override;
+    NumberFormat numberFormat() const override;
+
+protected:
+    // implementations for `Sink`
+    void feedIn(const SamplePackView& data) override;
+    /// New configuration is passed to sinks by `drain()`, after the
+    /// packs that are fed before it.
+    void setNumChannels(unsigned nc, bool x) override;
+
+private:
+    /// Set on `tail` while consumer is reading the slot
+    static const quint64 CLAIMED = quint64(1) << 63;
+
+    /// Channel configuration of the source
+    struct Config
+    {
+        unsigned numChannels;
+        bool hasX;
+        NumberFormat numberFormat;
+
+        bool operator==(const Config& other) const;
+    };
+
+    struct Slot
+    {
+        SamplePack* pack;
+        bool interleaved;       ///< data is stored as rows in `pack`
+        Config config;          ///< configuration when pack is fed
+    };
+
+    unsigned _capacity;
+    std::atomic<int> _policy;
+    std::thread::id consumerThread;
+
+    Config applied;             ///< configuration of sinks, consumer only
+    Config fed;                 ///< configuration of producer, producer only
+    std::mutex configLock;      ///< guards `latest`
+    Config latest;              ///< last configuration set by producer
+    std::atomic<quint64> configSeq; ///< incremented with each `latest` change
+    quint64 appliedSeq;         ///< `configSeq` of `applied`, consumer only
+
+    QVector<Slot> ring;
+    std::atomic<quint64> head; ///< next slot to write, only producer changes
+    std::atomic<quint64> tail; ///< next slot to read, may have `CLAIMED` bit
+
+    std::function<void()> pendingCallback;
+    std::atomic<bool> notified; ///< `pendingCallback` is called since last drain
+
+    std::atomic<quint64> _overflows;
+    std::atomic<quint64> _droppedPacks;
+    std::atomic<quint64> _droppedSamples;
+
+    /// Tries to make space for one pack. Returns false if incoming
+    /// pack should be dropped.
+    bool makeSpace(quint64 h);
+    /// Copies `data` into slot `i`, reusing its pack when possible
+    void copyToSlot(unsigned i, const SamplePackView& data);
+    /// Returns a view of the data in slot `i`
+    SamplePackView slotView(unsigned i) const;
+    /// Passes configuration to sinks if it's different from `applied`
+    void apply(const Config& config);
+    /// Calls `pendingCallback` if it's not called since last drain
+    void notify();
+};
+
+#endif // PACKQUEUE_H
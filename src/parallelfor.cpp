@@ -0,0 +1,51 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "parallelfor.h"
+
+void parallelFor(unsigned n, const std::function<void(unsigned)>& func)
+{
+    unsigned numThreads = std::min(n, std::max(1u, std::thread::hardware_concurrency()));
+
+    // every thread takes the next index until all are taken
+    std::atomic<unsigned> next(0);
+    auto work = [&next, n, &func]()
+    {
+        for (unsigned i = next++; i < n; i = next++)
+        {
+            func(i);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < numThreads; t++)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+}
@@ -0,0 +1,35 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <functional>
+
+/**
+ * Calls `func(i)` for every `i` in range [0, n), distributing the calls
+ * to worker threads. Calling thread also takes part. Returns when all
+ * calls are finished.
+ *
+ * Threads are created for each call, so this is only worth it for big
+ * jobs (ex: moving channel data while resizing).
+ */
+void parallelFor(unsigned n, const std::function<void(unsigned)>& func);
+
+#endif // PARALLELFOR_H
@@ -20,13 +20,16 @@
 #include <QRectF>
 #include <QKeySequence>
 #include <QColor>
+#include <QPainter>
 #include <qwt_symbol.h>
+#include <qwt_plot_canvas.h>
 #include <qwt_plot_curve.h>
 #include <qwt_scale_map.h>
 #include <math.h>
 #include <algorithm>
 
 #include "plot.h"
+#include "framebufferseries.h"
 #include "utils.h"
 
 static const int SYMBOL_SHOW_AT_WIDTH = 5;
@@ -38,10 +41,15 @@ Plot::Plot(QWidget* parent) :
     sZoomer(this, &zoomer)
 {
     isAutoScaled = true;
+    autoScaleVisible = false;
     symbolSize = 0;
     numOfSamples = 1;
     plotWidth = 1;
     showSymbols = Plot::ShowSymbolsAuto;
+    incremental = true;
+    incrementalNext = false;
+    pendingScroll = 0;
+    layerDecimated = false;
 
     QObject::connect(&zoomer, &Zoomer::unzoomed, this, &Plot::unzoomed);
 
@@ -49,6 +57,13 @@ Plot::Plot(QWidget* parent) :
     grid.attach(this);
     legend.attach(this);
 
+    // gap in front of the newest sample, hides curves like a blank
+    sweepCursor.setOrientation(Qt::Vertical);
+    sweepCursor.setZ(21); // curves are at 20
+    sweepCursor.setPen(QPen(Qt::gray));
+    sweepCursor.hide();
+    sweepCursor.attach(this);
+
     showGrid(false);
     darkBackground(false);
 
@@ -64,6 +79,7 @@ Plot::Plot(QWidget* parent) :
             [this](QwtPlotItem *plotItem, bool on)
             {
                 if (symbolSize) updateSymbols();
+                if (on) updateResolution();
             });
 
     // init demo indicator
@@ -111,6 +127,270 @@ void Plot::setYAxis(bool autoScaled, double yAxisMin, double yAxisMax)
     resetAxes();
 }
 
+void Plot::setAutoScaleVisible(bool enabled)
+{
+    autoScaleVisible = enabled;
+
+    if (!enabled)
+    {
+        for (auto item : itemList(QwtPlotItem::Rtti_PlotCurve))
+        {
+            auto curve = static_cast<QwtPlotCurve*>(item);
+            auto series = dynamic_cast<FrameBufferSeries*>(curve->data());
+            if (series != nullptr) series->clearVisibleRange();
+        }
+    }
+    replot();
+}
+
+void Plot::replot()
+{
+    // X axis is set by the zoomer, autoscale should use its range
+    if (autoScaleVisible)
+    {
+        auto rect = zoomer.zoomRect();
+        for (auto item : itemList(QwtPlotItem::Rtti_PlotCurve))
+        {
+            auto curve = static_cast<QwtPlotCurve*>(item);
+            auto series = dynamic_cast<FrameBufferSeries*>(curve->data());
+            if (series != nullptr) series->setVisibleRange(rect.left(), rect.right());
+        }
+    }
+
+    // only scrolled or updated data can be drawn incrementally, anything else may have changed
+    if (!incrementalNext) curveLayer.invalidate();
+    incrementalNext = false;
+
+    QwtPlot::replot();
+}
+
+void Plot::setIncremental(bool enabled)
+{
+    if (enabled == incremental) return;
+
+    incremental = enabled;
+    curveLayer.invalidate(!enabled);
+    replot();
+}
+
+void Plot::scrollData(double dx)
+{
+    pendingScroll += dx;
+    incrementalNext = true;
+}
+
+void Plot::updateData(double xStart, double xEnd)
+{
+    // spans are only used (and cleared) while drawing curve layer
+    if (!incremental || isHidden()) return;
+
+    dirtySpans.append(QwtInterval(xStart, xEnd));
+    incrementalNext = true;
+}
+
+void Plot::setSweepCursor(double xStart, double xEnd)
+{
+    sweepCursor.setInterval(xStart, xEnd);
+    sweepCursor.show();
+}
+
+void Plot::hideSweepCursor()
+{
+    sweepCursor.hide();
+}
+
+void Plot::showEvent(QShowEvent* event)
+{
+    curveLayer.invalidate();
+    QwtPlot::showEvent(event);
+}
+
+bool Plot::CurveStyle::operator==(const CurveStyle& other) const
+{
+    return curve == other.curve && visible == other.visible && pen == other.pen &&
+        symbol == other.symbol && symbolSize == other.symbolSize;
+}
+
+QVector<Plot::CurveStyle> Plot::curveStyles() const
+{
+    QVector<CurveStyle> styles;
+    for (auto item : itemList(QwtPlotItem::Rtti_PlotCurve))
+    {
+        auto curve = static_cast<const QwtPlotCurve*>(item);
+        auto symbol = curve->symbol();
+        styles.append({item, item->isVisible(), curve->pen(), symbol,
+                       symbol == nullptr ? 0 : symbol->size().width()});
+    }
+    return styles;
+}
+
+void Plot::drawItems(QPainter* painter, const QRectF& canvasRect,
+                     const QwtScaleMap maps[axisCnt]) const
+{
+    // only the canvas on screen is drawn incrementally, not exports
+    auto plotCanvas = qobject_cast<const QwtPlotCanvas*>(canvas());
+    bool onScreen = plotCanvas != nullptr &&
+        (painter->device() == canvas() ||
+         painter->device() == static_cast<const QPaintDevice*>(plotCanvas->backingStore()));
+    if (!incremental || !onScreen)
+    {
+        QwtPlot::drawItems(painter, canvasRect, maps);
+        return;
+    }
+
+    updateCurveLayer(canvasRect, maps[QwtPlot::xBottom], maps[QwtPlot::yLeft]);
+
+    // same as `QwtPlot::drawItems` except curves are drawn from layer
+    bool layerDrawn = false;
+    for (auto item : itemList())
+    {
+        if (item->rtti() == QwtPlotItem::Rtti_PlotCurve)
+        {
+            if (!layerDrawn)
+            {
+                painter->drawImage(canvasRect.topLeft(), curveLayer.image());
+                layerDrawn = true;
+            }
+            continue;
+        }
+        if (!item->isVisible()) continue;
+
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing,
+                               item->testRenderHint(QwtPlotItem::RenderAntialiased));
+        item->draw(painter, maps[item->xAxis()], maps[item->yAxis()], canvasRect);
+        painter->restore();
+    }
+}
+
+/**
+ * Returns index of the first sample with X greater than `x`, or equal
+ * to `x` if not `strict`. Returns `size()` if there is none. X of
+ * samples must be increasing.
+ */
+static int firstSampleAfter(const QwtSeriesData<QPointF>* data, double x, bool strict)
+{
+    int lo = 0, hi = data->size();
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        double mx = data->sample(mid).x();
+        if (mx < x || (strict && mx == x)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/// Returns true if maps transform the same way
+static bool sameMap(const QwtScaleMap& a, const QwtScaleMap& b)
+{
+    return a.s1() == b.s1() && a.s2() == b.s2() && a.p1() == b.p1() && a.p2() == b.p2();
+}
+
+void Plot::updateCurveLayer(const QRectF& canvasRect,
+                            const QwtScaleMap& xMap, const QwtScaleMap& yMap) const
+{
+    int dpr = canvas()->devicePixelRatio();
+    QSize size = (canvasRect.size() * dpr).toSize();
+    auto styles = curveStyles();
+    bool decimated = isDecimated();
+
+    // scroll in device pixels
+    double pixelsPerUnit = (xMap.p2() - xMap.p1()) / (xMap.s2() - xMap.s1());
+    bool scrolled = pendingScroll != 0;
+    double dx = pendingScroll * pixelsPerUnit * dpr;
+    pendingScroll = 0;
+
+    // decimated samples are grouped into columns from the left of the
+    // plot, when they scroll old columns aren't the same anymore
+    bool full = !curveLayer.isValid() || curveLayer.image().size() != size ||
+        styles != layerStyles || !sameMap(xMap, layerXMap) || !sameMap(yMap, layerYMap) ||
+        decimated || layerDecimated;
+
+    layerXMap = xMap;
+    layerYMap = yMap;
+    layerStyles = styles;
+    layerDecimated = decimated;
+
+    // layer is in device pixels from canvas origin, curves are drawn in canvas coordinates
+    auto draw = [this, &canvasRect, &xMap, &yMap](QPainter* painter, const QRectF& clip)
+        {
+            painter->translate(-canvasRect.topLeft());
+            drawCurves(painter, canvasRect, clip.translated(canvasRect.topLeft()), xMap, yMap);
+        };
+
+    // line from the last unchanged sample and wide pens/symbols need some margin
+    int margin = 2;
+    for (auto& s : styles)
+    {
+        margin = std::max(margin, int(ceil(s.pen.widthF())) + s.symbolSize + 2);
+    }
+    margin *= dpr;
+
+    // image can only be scrolled by whole pixels
+    if (full || (scrolled && !curveLayer.scroll(dx, margin, draw)))
+    {
+        dirtySpans.clear();
+        curveLayer.redraw(size, dpr, draw);
+        return;
+    }
+
+    for (auto& span : dirtySpans)
+    {
+        double start = (xMap.transform(span.minValue()) - canvasRect.left()) * dpr;
+        double end = (xMap.transform(span.maxValue()) - canvasRect.left()) * dpr;
+        curveLayer.redrawColumns(floor(start) - margin, ceil(end) + margin, draw);
+    }
+    dirtySpans.clear();
+}
+
+bool Plot::isDecimated() const
+{
+    for (auto item : itemList(QwtPlotItem::Rtti_PlotCurve))
+    {
+        if (!item->isVisible()) continue;
+
+        auto curve = static_cast<const QwtPlotCurve*>(item);
+        auto series = dynamic_cast<const FrameBufferSeries*>(curve->data());
+        if (series != nullptr && series->isDecimated()) return true;
+    }
+    return false;
+}
+
+void Plot::drawCurves(QPainter* painter, const QRectF& canvasRect, const QRectF& clip,
+                      const QwtScaleMap& xMap, const QwtScaleMap& yMap) const
+{
+    // X range of samples that can touch the clip
+    double clipStart = xMap.invTransform(clip.left());
+    double clipEnd = xMap.invTransform(clip.right());
+    bool partial = clip.left() > canvasRect.left() || clip.right() < canvasRect.right();
+
+    for (auto item : itemList(QwtPlotItem::Rtti_PlotCurve))
+    {
+        if (!item->isVisible()) continue;
+
+        auto curve = static_cast<const QwtPlotCurve*>(item);
+        auto data = curve->data();
+        int n = data->size();
+        if (n == 0) continue;
+
+        // skip samples outside of clip if X is increasing (not an XY
+        // plot), lines to the closest outside samples are kept
+        int from = 0, to = n - 1;
+        if (partial && data->sample(0).x() <= data->sample(n-1).x())
+        {
+            from = std::max(0, firstSampleAfter(data, clipStart, false) - 1);
+            to = std::min(n - 1, firstSampleAfter(data, clipEnd, true));
+        }
+
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing,
+                               item->testRenderHint(QwtPlotItem::RenderAntialiased));
+        curve->drawSeries(painter, xMap, yMap, canvasRect, from, to);
+        painter->restore();
+    }
+}
+
 void Plot::setXAxis(double xMin, double xMax)
 {
     _xMin = xMin;
@@ -132,6 +412,13 @@ void Plot::setXAxis(double xMin, double xMax)
     onXScaleChanged();
 }
 
+void Plot::extendXAxis(double xMax)
+{
+    _xMax = xMax;
+    numOfSamples = xMax - _xMin;
+    zoomer.extendXLimits(xMax);
+}
+
 void Plot::resetAxes()
 {
     // reset y axis
@@ -198,6 +485,7 @@ void Plot::darkBackground(bool enabled)
     if (enabled)
     {
         setCanvasBackground(QBrush(Qt::black));
+        sweepCursor.setBrush(QBrush(Qt::black));
 
         gridColor.setHsvF(0, 0, 0.30);
         grid.setMajorPen(gridColor);
@@ -213,6 +501,7 @@ void Plot::darkBackground(bool enabled)
     else
     {
         setCanvasBackground(QBrush(Qt::white));
+        sweepCursor.setBrush(QBrush(Qt::white));
 
         gridColor.setHsvF(0, 0, 0.75);
         grid.setMajorPen(gridColor);
@@ -332,9 +621,22 @@ void Plot::updateSymbols()
     }
 }
 
+void Plot::updateResolution()
+{
+    unsigned width = canvas()->width() * canvas()->devicePixelRatio();
+
+    for (auto item : itemList(QwtPlotItem::Rtti_PlotCurve))
+    {
+        auto curve = static_cast<QwtPlotCurve*>(item);
+        auto series = dynamic_cast<FrameBufferSeries*>(curve->data());
+        if (series != nullptr) series->setResolution(width);
+    }
+}
+
 void Plot::resizeEvent(QResizeEvent * event)
 {
     QwtPlot::resizeEvent(event);
+    updateResolution();
     onXScaleChanged();
 }
 
@@ -23,16 +23,25 @@
 #include <QColor>
 #include <QList>
 #include <QAction>
+#include <QPainter>
+#include <QPen>
+#include <QVector>
 #include <qwt_plot.h>
+#include <qwt_scale_map.h>
+#include <qwt_interval.h>
+#include <qwt_plot_zoneitem.h>
 #include <qwt_plot_grid.h>
 #include <qwt_plot_shapeitem.h>
 #include <qwt_plot_legenditem.h>
 #include <qwt_plot_textlabel.h>
 
+#include "curvelayer.h"
 #include "zoomer.h"
 #include "scalezoomer.h"
 #include "plotsnapshotoverlay.h"
 
+class QwtSymbol;
+
 class Plot : public QwtPlot
 {
     Q_OBJECT
@@ -62,7 +71,11 @@ public slots:
     void unzoom();
     void darkBackground(bool enabled = true);
     void setYAxis(bool autoScaled, double yMin = 0, double yMax = 1);
+    /// When enabled autoscale fits Y axis to samples in visible X range
+    void setAutoScaleVisible(bool enabled);
     void setXAxis(double xMin, double xMax);
+    /// Moves end of X axis without resetting the zoom. X axis should be index.
+    void extendXAxis(double xMax);
     void setSymbols(ShowSymbols shown);
     void setLegendPosition(Qt::AlignmentFlag alignment);
 
@@ -77,12 +90,50 @@ public slots:
 
     void setPlotWidth(double width);
 
+    /// Re-implemented to update visible ranges of curves before autoscale
+    void replot() override;
+
+    /**
+     * Enables incremental rendering of curves. Curves are kept in an
+     * image, when data scrolls (see `scrollData()`) by whole pixels
+     * image is shifted and only the newly exposed strip is drawn. Any
+     * other replot (zoom, resize, style changes, decimated curves
+     * etc.) redraws curves fully.
+     */
+    void setIncremental(bool enabled);
+
+    /**
+     * Tells that curves moved left by `dx` (in X axis units), because
+     * new samples are added to the end and old samples are dropped from
+     * the start. Must be called right before `replot()`, which then can
+     * shift the previous image of curves.
+     */
+    void scrollData(double dx);
+
+    /**
+     * Tells that samples in X range [xStart, xEnd] are overwritten in
+     * place (sweep display). Can be called multiple times before
+     * `replot()`, which then only redraws these ranges of curves.
+     */
+    void updateData(double xStart, double xEnd);
+
+    /// Shows the sweep gap over X range [xStart, xEnd], it hides curves
+    void setSweepCursor(double xStart, double xEnd);
+    void hideSweepCursor();
+
 protected:
     /// update the display of symbols depending on `symbolSize`
     void updateSymbols();
 
+    /// Re-implemented to draw curves from `curveLayer` when incremental
+    void drawItems(QPainter* painter, const QRectF& canvasRect,
+                   const QwtScaleMap maps[axisCnt]) const override;
+    /// Re-implemented to redraw curves fully, they are not updated while hidden
+    void showEvent(QShowEvent* event) override;
+
 private:
     bool isAutoScaled;
+    bool autoScaleVisible;
     double yMin, yMax;
     double _xMin, _xMax;
     unsigned numOfSamples;
@@ -97,8 +148,48 @@ private:
     QwtPlotTextLabel noChannelIndicator;
     ShowSymbols showSymbols;
 
+    /// Properties of a curve that affect its drawing
+    struct CurveStyle
+    {
+        const QwtPlotItem* curve;
+        bool visible;
+        QPen pen;
+        const QwtSymbol* symbol;
+        int symbolSize;
+
+        bool operator==(const CurveStyle& other) const;
+        bool operator!=(const CurveStyle& other) const {return !(*this == other);}
+    };
+
+    bool incremental;
+    bool incrementalNext;              ///< next `replot()` is due to `scrollData()` or `updateData()`
+    mutable CurveLayer curveLayer;
+    mutable double pendingScroll;      ///< scroll that isn't applied to `curveLayer` yet
+    mutable bool layerDecimated;       ///< `curveLayer` is drawn from decimated series
+    mutable QwtScaleMap layerXMap, layerYMap; ///< maps `curveLayer` is drawn with
+    mutable QVector<CurveStyle> layerStyles;  ///< styles `curveLayer` is drawn with
+    mutable QVector<QwtInterval> dirtySpans;  ///< X ranges set with `updateData()`
+    QwtPlotZoneItem sweepCursor;
+
+    /// Returns current styles of curves
+    QVector<CurveStyle> curveStyles() const;
+    /// Brings `curveLayer` up to date, by redrawing fully or just the changed parts
+    void updateCurveLayer(const QRectF& canvasRect,
+                          const QwtScaleMap& xMap, const QwtScaleMap& yMap) const;
+    /**
+     * Draws curves for `curveLayer`.
+     *
+     * @param clip part of canvas to draw, in canvas coordinates
+     */
+    void drawCurves(QPainter* painter, const QRectF& canvasRect, const QRectF& clip,
+                    const QwtScaleMap& xMap, const QwtScaleMap& yMap) const;
+    /// Returns true if a visible curve is drawn from decimated samples
+    bool isDecimated() const;
+
     void resetAxes();
     void resizeEvent(QResizeEvent * event);
+    /// Updates the decimation resolution of curves for canvas width
+    void updateResolution();
     void calcSymbolSize();
 
 private slots:
@@ -20,6 +20,7 @@
 #include <QVariant>
 #include <QMessageBox>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QStyledItemDelegate>
 #include <QColorDialog>
 
@@ -102,6 +103,9 @@ PlotControlPanel::PlotControlPanel(QWidget *parent) :
     connect(ui->cbAutoScale, &QCheckBox::toggled,
             this, &PlotControlPanel::onAutoScaleChecked);
 
+    connect(ui->cbAutoScaleVisible, &QCheckBox::toggled,
+            this, &PlotControlPanel::autoScaleVisibleChanged);
+
     connect(ui->spYmax, SIGNAL(valueChanged(double)),
             this, SLOT(onYScaleChanged()));
 
@@ -111,6 +115,12 @@ PlotControlPanel::PlotControlPanel(QWidget *parent) :
     connect(ui->cbIndex, &QCheckBox::toggled,
             this, &PlotControlPanel::onIndexChecked);
 
+    connect(ui->cbHistory, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            [this](int index)
+            {
+                emit historyModeChanged(HistoryMode(index));
+            });
+
     connect(ui->spXmax, SIGNAL(valueChanged(double)),
             this, SLOT(onXScaleChanged()));
 
@@ -142,6 +152,12 @@ PlotControlPanel::PlotControlPanel(QWidget *parent) :
                 emit lineThicknessChanged(thickness);
             });
 
+    connect(ui->spMaxFps, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this](int fps)
+            {
+                emit maxFpsChanged(fps);
+            });
+
     // init scale range preset list
     for (int nbits = 8; nbits <= 24; nbits++) // signed binary formats
     {
@@ -279,6 +295,7 @@ void PlotControlPanel::onAutoScaleChecked(bool checked)
         ui->lYmax->setEnabled(false);
         ui->spYmin->setEnabled(false);
         ui->spYmax->setEnabled(false);
+        ui->cbAutoScaleVisible->setEnabled(true);
 
         emit yScaleChanged(true); // autoscale
     }
@@ -288,6 +305,7 @@ void PlotControlPanel::onAutoScaleChecked(bool checked)
         ui->lYmax->setEnabled(true);
         ui->spYmin->setEnabled(true);
         ui->spYmax->setEnabled(true);
+        ui->cbAutoScaleVisible->setEnabled(false);
 
         emit yScaleChanged(false, ui->spYmin->value(), ui->spYmax->value());
     }
@@ -306,6 +324,11 @@ bool PlotControlPanel::autoScale() const
     return ui->cbAutoScale->isChecked();
 }
 
+bool PlotControlPanel::autoScaleVisible() const
+{
+    return ui->cbAutoScaleVisible->isChecked();
+}
+
 double PlotControlPanel::yMax() const
 {
     return ui->spYmax->value();
@@ -385,6 +408,16 @@ double PlotControlPanel::plotWidth() const
     return value;
 }
 
+HistoryMode PlotControlPanel::historyMode() const
+{
+    return HistoryMode(ui->cbHistory->currentIndex());
+}
+
+unsigned PlotControlPanel::maxFps() const
+{
+    return ui->spMaxFps->value();
+}
+
 void PlotControlPanel::onPlotWidthChanged()
 {
     emit plotWidthChanged(plotWidth());
@@ -457,9 +490,12 @@ void PlotControlPanel::saveSettings(QSettings* settings)
     settings->setValue(SG_Plot_XMax, xMax());
     settings->setValue(SG_Plot_XMin, xMin());
     settings->setValue(SG_Plot_AutoScale, autoScale());
+    settings->setValue(SG_Plot_AutoScaleVisible, autoScaleVisible());
     settings->setValue(SG_Plot_YMax, yMax());
     settings->setValue(SG_Plot_YMin, yMin());
     settings->setValue(SG_Plot_LineThickness, ui->spLineThickness->value());
+    settings->setValue(SG_Plot_MaxFps, maxFps());
+    settings->setValue(SG_Plot_History, historyMode());
     settings->endGroup();
 }
 
@@ -476,9 +512,14 @@ void PlotControlPanel::loadSettings(QSettings* settings)
     ui->spXmin->setValue(settings->value(SG_Plot_XMin, xMin()).toDouble());
     ui->cbAutoScale->setChecked(
         settings->value(SG_Plot_AutoScale, autoScale()).toBool());
+    ui->cbAutoScaleVisible->setChecked(
+        settings->value(SG_Plot_AutoScaleVisible, autoScaleVisible()).toBool());
     ui->spYmax->setValue(settings->value(SG_Plot_YMax, yMax()).toDouble());
     ui->spYmin->setValue(settings->value(SG_Plot_YMin, yMin()).toDouble());
     ui->spLineThickness->setValue(
         settings->value(SG_Plot_LineThickness, ui->spLineThickness->value()).toInt());
+    ui->spMaxFps->setValue(settings->value(SG_Plot_MaxFps, maxFps()).toInt());
+    ui->cbHistory->setCurrentIndex(
+        settings->value(SG_Plot_History, historyMode()).toInt());
     settings->endGroup();
 }
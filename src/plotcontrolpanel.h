@@ -27,6 +27,7 @@
 #include <QStyledItemDelegate>
 
 #include "channelinfomodel.h"
+#include "history.h"
 
 namespace Ui {
 class PlotControlPanel;
@@ -42,6 +43,7 @@ public:
 
     unsigned numOfSamples();
     bool   autoScale() const;
+    bool   autoScaleVisible() const;
     double yMax() const;
     double yMin() const;
     bool   xAxisAsIndex() const;
@@ -49,6 +51,10 @@ public:
     double xMin() const;
     /// Returns the plot width adjusted for x axis scaling.
     double plotWidth() const;
+    /// Returns selected history mode
+    HistoryMode historyMode() const;
+    /// Returns maximum plot redraws per second
+    unsigned maxFps() const;
 
     void setChannelInfoModel(ChannelInfoModel* model);
 
@@ -60,9 +66,12 @@ public:
 signals:
     void numOfSamplesChanged(int value);
     void yScaleChanged(bool autoScaled, double yMin = 0, double yMax = 1);
+    void autoScaleVisibleChanged(bool enabled);
     void xScaleChanged(bool asIndex, double xMin = 0, double xMax = 1);
     void plotWidthChanged(double width);
     void lineThicknessChanged(int thickness);
+    void maxFpsChanged(unsigned fps);
+    void historyModeChanged(HistoryMode mode);
 
 private:
     Ui::PlotControlPanel *ui;
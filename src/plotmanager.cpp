@@ -29,7 +29,8 @@
 #include "setting_defines.h"
 
 PlotManager::PlotManager(QWidget* plotArea, PlotMenu* menu,
-                         const Stream* stream, QObject* parent) :
+                         const Stream* stream, RenderScheduler* scheduler,
+                         QObject* parent) :
     QObject(parent)
 {
     _stream = stream;
@@ -49,13 +50,27 @@ PlotManager::PlotManager(QWidget* plotArea, PlotMenu* menu,
             });
 
     connect(stream, &Stream::numChannelsChanged, this, &PlotManager::onNumChannelsChanged);
-    connect(stream, &Stream::dataAdded, this, &PlotManager::replot);
+    if (scheduler != nullptr)
+    {
+        // bursts of data are rendered once per frame
+        scheduler->add(this, plotArea, [this]() {onDataAdded();});
+        connect(stream, &Stream::dataAdded, this,
+                [this, scheduler]() {scheduler->markDirty(this);});
+    }
+    else
+    {
+        connect(stream, &Stream::dataAdded, this, &PlotManager::onDataAdded);
+    }
+    connect(stream, &Stream::xDataChanged, this, &PlotManager::onXDataChanged);
+    connect(stream, &Stream::yDataChanged, this, &PlotManager::onYDataChanged);
+    connect(stream, &Stream::historyChanged, this, &PlotManager::onHistoryChanged);
 
     // add initial curves if any?
     for (unsigned int i = 0; i < stream->numChannels(); i++)
     {
         addCurve(stream->channel(i)->name(), stream->channel(i)->xData(), stream->channel(i)->yData());
     }
+    updateYData();
 }
 
 PlotManager::PlotManager(QWidget* plotArea, PlotMenu* menu,
@@ -86,6 +101,7 @@ void PlotManager::construct(QWidget* plotArea, PlotMenu* menu)
     _menu = menu;
     _plotArea = plotArea;
     _autoScaled = true;
+    _autoScaleVisible = false;
     _yMin = 0;
     _yMax = 1;
     _xAxisAsIndex = true;
@@ -96,6 +112,9 @@ void PlotManager::construct(QWidget* plotArea, PlotMenu* menu)
     emptyPlot = NULL;
     inScaleSync = false;
     lineThickness = 1;
+    renderedSequence = 0;
+    sweep = menu->sweepAction.isChecked();
+    sweepSize = 0;
 
     // initalize layout and single widget
     isMulti = false;
@@ -118,6 +137,10 @@ void PlotManager::construct(QWidget* plotArea, PlotMenu* menu)
     connect(&menu->showLegendAction, SELECT<bool>::OVERLOAD_OF(&QAction::toggled),
             this, &PlotManager::showLegend);
     connect(menu, &PlotMenu::legendPosChanged, this, &PlotManager::setLegendPosition);
+    connect(&menu->incrementalAction, SELECT<bool>::OVERLOAD_OF(&QAction::toggled),
+            this, &PlotManager::setIncremental);
+    connect(&menu->sweepAction, SELECT<bool>::OVERLOAD_OF(&QAction::toggled),
+            this, &PlotManager::setSweep);
 
     // initial settings from menu actions
     showGrid(menu->showGridAction.isChecked());
@@ -134,6 +157,7 @@ PlotManager::~PlotManager()
     {
         delete curves.takeLast();
     }
+    qDeleteAll(sweepBuffers);
 
     // remove all widgets
     while (plotWidgets.size())
@@ -163,9 +187,198 @@ void PlotManager::onNumChannelsChanged(unsigned value)
         removeCurves(oldNum - numOfChannels);
     }
 
+    updateYData();
+    replot();
+}
+
+void PlotManager::onXDataChanged()
+{
+    if (_stream == nullptr) return;
+
+    int ci = 0;
+    for (auto curve : curves)
+    {
+        FrameBufferSeries* series = static_cast<FrameBufferSeries*>(curve->data());
+        series->setX(_stream->channel(ci)->xData());
+        ci++;
+    }
+    // sweep isn't possible when X is provided by source
+    updateYData();
+}
+
+void PlotManager::onYDataChanged()
+{
+    updateYData();
+}
+
+void PlotManager::onDataAdded()
+{
+    // while recording history X axis grows with the data
+    auto history = _stream->history();
+    if (history != nullptr)
+    {
+        for (auto plot : plotWidgets)
+        {
+            plot->extendXAxis(history->numRows());
+        }
+    }
+    else if (!sweepBuffers.isEmpty())
+    {
+        sweepData();
+    }
+    else if (!_stream->hasX())
+    {
+        // samples scroll left by one X step for each new sample,
+        // plots can shift their previous drawing instead of redrawing
+        quint64 seq = _stream->sequence();
+        quint64 added = seq > renderedSequence ? seq - renderedSequence : 0;
+        double step = 0;
+        if (_stream->numChannels() > 0)
+        {
+            auto xData = _stream->channel(0)->xData();
+            if (xData->size() > 1) step = xData->sample(1) - xData->sample(0);
+        }
+        if (added > 0 && step > 0)
+        {
+            for (auto plot : plotWidgets)
+            {
+                plot->scrollData(added * step);
+            }
+        }
+        renderedSequence = seq;
+    }
+    replot();
+}
+
+/// Length of the sweep gap as a ratio of buffer size
+static const double SWEEP_GAP = 0.02;
+
+void PlotManager::sweepData()
+{
+    auto xData = _stream->channel(0)->xData();
+    unsigned n = xData->size();
+    if (n == 0) return;
+
+    // each sample is displayed at its sequence number modulo buffer size
+    quint64 seq = _stream->sequence();
+    unsigned phase = seq % n;
+    for (auto buf : sweepBuffers)
+    {
+        buf->setPhase(phase);
+    }
+
+    // only overwritten part is redrawn, including lines from neighbor samples
+    quint64 added = seq > renderedSequence ? seq - renderedSequence : 0;
+    if (added > 0 && added < n && n == sweepSize)
+    {
+        unsigned start = (renderedSequence + n - 1) % n;
+        for (auto plot : plotWidgets)
+        {
+            if (start < phase)
+            {
+                plot->updateData(xData->sample(start), xData->sample(phase));
+            }
+            else // wraps around
+            {
+                plot->updateData(xData->sample(start), xData->sample(n - 1));
+                plot->updateData(xData->sample(0), xData->sample(phase));
+            }
+        }
+    }
+
+    // gap starts at the newest sample, it also hides the line to the oldest sample
+    unsigned gap = std::max(1u, unsigned(n * SWEEP_GAP));
+    double gapStart = xData->sample(phase == 0 ? 0 : phase - 1);
+    double gapEnd = xData->sample(std::min(n - 1, phase + gap));
+    for (auto plot : plotWidgets)
+    {
+        plot->setSweepCursor(gapStart, gapEnd);
+    }
+
+    renderedSequence = seq;
+    sweepSize = n;
+}
+
+void PlotManager::updateYData()
+{
+    if (_stream == nullptr) return;
+
+    bool sweepActive = sweep && _stream->history() == nullptr && !_stream->hasX();
+
+    // old sweep buffers are deleted after curves stop referring them
+    auto oldBuffers = sweepBuffers;
+    sweepBuffers.clear();
+
+    int ci = 0;
+    for (auto curve : curves)
+    {
+        const FrameBuffer* yData = _stream->channel(ci)->yData();
+        if (sweepActive)
+        {
+            auto buf = new SweepBuffer(yData);
+            sweepBuffers.append(buf);
+            yData = buf;
+        }
+        FrameBufferSeries* series = static_cast<FrameBufferSeries*>(curve->data());
+        series->setY(yData);
+        ci++;
+    }
+    qDeleteAll(oldBuffers);
+
+    sweepSize = 0; // first sweep is drawn fully
+    if (!sweepBuffers.isEmpty())
+    {
+        sweepData();
+    }
+    else
+    {
+        for (auto plot : plotWidgets)
+        {
+            plot->hideSweepCursor();
+        }
+    }
+}
+
+void PlotManager::setSweep(bool enabled)
+{
+    sweep = enabled;
+    updateYData();
+    replot();
+}
+
+void PlotManager::onHistoryChanged()
+{
+    // sweep isn't possible while recording history
+    updateYData();
+    for (auto plot : plotWidgets)
+    {
+        resetXAxis(plot);
+    }
     replot();
 }
 
+void PlotManager::resetXAxis(Plot* plot) const
+{
+    auto history = (_stream == nullptr) ? nullptr : _stream->history();
+    if (history != nullptr)
+    {
+        plot->setNumOfSamples(history->numRows());
+        plot->setXAxis(0, history->numRows());
+    }
+    else
+    {
+        plot->setNumOfSamples(_numOfSamples);
+        if (_xAxisAsIndex)
+        {
+            plot->setXAxis(0, _numOfSamples);
+        }
+        else
+        {
+            plot->setXAxis(_xMin, _xMax);
+        }
+    }
+}
+
 void PlotManager::onChannelInfoChanged(const QModelIndex &topLeft,
                                        const QModelIndex &bottomRight,
                                        const QVector<int> &roles)
@@ -336,20 +549,13 @@ Plot* PlotManager::addPlotWidget()
     plot->showLegend(_menu->showLegendAction.isChecked());
     plot->setLegendPosition(_menu->legendPosition());
     plot->setSymbols(_menu->showSymbols());
+    plot->setIncremental(_menu->incrementalAction.isChecked());
 
     plot->showDemoIndicator(isDemoShown);
     plot->setYAxis(_autoScaled, _yMin, _yMax);
-    plot->setNumOfSamples(_numOfSamples);
-
+    plot->setAutoScaleVisible(_autoScaleVisible);
     plot->setPlotWidth(_plotWidth);
-    if (_xAxisAsIndex)
-    {
-        plot->setXAxis(0, _numOfSamples);
-    }
-    else
-    {
-        plot->setXAxis(_xMin, _xMax);
-    }
+    resetXAxis(plot);
 
     if (isMulti)
     {
@@ -369,30 +575,31 @@ void PlotManager::syncScales()
 
     // find maximum extent
     double maxExtent = 0;
+    QVector<double> prevExtents;
     for (auto plot : plotWidgets)
     {
-        if (!plot->isVisible()) continue;
-
         QwtScaleWidget* scaleWidget = plot->axisWidget(QwtPlot::yLeft);
         QwtScaleDraw* scaleDraw = scaleWidget->scaleDraw();
-        scaleDraw->setMinimumExtent(0);
+        prevExtents.append(scaleDraw->minimumExtent());
 
+        if (!plot->isVisible()) continue;
+
+        scaleDraw->setMinimumExtent(0);
         const double extent = scaleDraw->extent(scaleWidget->font());
         if (extent > maxExtent)
             maxExtent = extent;
     }
 
-    // apply maximum extent
-    for (auto plot : plotWidgets)
+    // apply maximum extent, only plots with a changed extent need a replot
+    for (int i = 0; i < plotWidgets.size(); i++)
     {
-        QwtScaleWidget* scaleWidget = plot->axisWidget(QwtPlot::yLeft);
+        QwtScaleWidget* scaleWidget = plotWidgets[i]->axisWidget(QwtPlot::yLeft);
         scaleWidget->scaleDraw()->setMinimumExtent(maxExtent);
-        scaleWidget->updateGeometry();
-    }
-
-    for (auto plot : plotWidgets)
-    {
-        plot->replot();
+        if (prevExtents[i] != maxExtent)
+        {
+            scaleWidget->updateGeometry();
+            plotWidgets[i]->replot();
+        }
     }
 
     inScaleSync = false;
@@ -491,10 +698,15 @@ Plot* PlotManager::plotWidget(unsigned curveIndex)
 
 void PlotManager::replot()
 {
+    // scale changes of plots are synced once, after all are replotted
+    bool syncing = inScaleSync;
+    inScaleSync = true;
     for (auto plot : plotWidgets)
     {
-        plot->replot();
+        // hidden plots are replotted when they are shown
+        if (!plot->isHidden()) plot->replot();
     }
+    inScaleSync = syncing;
     if (isMulti) syncScales();
 }
 
@@ -555,6 +767,14 @@ void PlotManager::darkBackground(bool enabled)
     }
 }
 
+void PlotManager::setIncremental(bool enabled)
+{
+    for (auto plot : plotWidgets)
+    {
+        plot->setIncremental(enabled);
+    }
+}
+
 void PlotManager::setSymbols(Plot::ShowSymbols shown)
 {
     showSymbols = shown;
@@ -575,29 +795,25 @@ void PlotManager::setYAxis(bool autoScaled, double yAxisMin, double yAxisMax)
     }
 }
 
+void PlotManager::setAutoScaleVisible(bool enabled)
+{
+    _autoScaleVisible = enabled;
+    for (auto plot : plotWidgets)
+    {
+        plot->setAutoScaleVisible(enabled);
+    }
+}
+
 void PlotManager::setXAxis(bool asIndex, double xMin, double xMax)
 {
     _xAxisAsIndex = asIndex;
     _xMin = xMin;
     _xMax = xMax;
 
-    int ci = 0;
-    for (auto curve : curves)
-    {
-        FrameBufferSeries* series = static_cast<FrameBufferSeries*>(curve->data());
-        series->setX(_stream->channel(ci)->xData());
-        ci++;
-    }
+    onXDataChanged();
     for (auto plot : plotWidgets)
     {
-        if (asIndex)
-        {
-            plot->setXAxis(0, _numOfSamples);
-        }
-        else
-        {
-            plot->setXAxis(xMin, xMax);
-        }
+        resetXAxis(plot);
     }
     replot();
 }
@@ -613,6 +829,9 @@ void PlotManager::flashSnapshotOverlay()
 void PlotManager::setNumOfSamples(unsigned value)
 {
     _numOfSamples = value;
+    // history length doesn't depend on buffer size
+    if (_stream != nullptr && _stream->history() != nullptr) return;
+
     for (auto plot : plotWidgets)
     {
         plot->setNumOfSamples(value);
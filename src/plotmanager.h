@@ -34,14 +34,21 @@
 #include "stream.h"
 #include "snapshot.h"
 #include "plotmenu.h"
+#include "renderscheduler.h"
+#include "sweepbuffer.h"
 
 class PlotManager : public QObject
 {
     Q_OBJECT
 
 public:
+    /**
+     * @param scheduler if given, new data is rendered with its frames,
+     * otherwise with every `Stream::dataAdded`
+     */
     explicit PlotManager(QWidget* plotArea, PlotMenu* menu,
                          const Stream* stream = nullptr,
+                         RenderScheduler* scheduler = nullptr,
                          QObject *parent = 0);
     explicit PlotManager(QWidget* plotArea, PlotMenu* menu,
                          Snapshot* snapshot,
@@ -65,6 +72,8 @@ public slots:
     void showDemoIndicator(bool show = true);
     /// Set the Y axis
     void setYAxis(bool autoScaled, double yMin = 0, double yMax = 1);
+    /// Fit autoscaled Y axis to the visible X range instead of all data
+    void setAutoScaleVisible(bool enabled);
     /// Set the X axis
     void setXAxis(bool asIndex, double xMin = 0 , double xMax = 1);
     /// Display an animation for snapshot
@@ -89,6 +98,7 @@ private:
     const ChannelInfoModel* infoModel;
     bool isDemoShown;
     bool _autoScaled;
+    bool _autoScaleVisible;
     double _yMin;
     double _yMax;
     bool _xAxisAsIndex;
@@ -98,6 +108,10 @@ private:
     double _plotWidth;
     Plot::ShowSymbols showSymbols;
     bool inScaleSync; ///< scaleSync is in progress
+    quint64 renderedSequence; ///< stream sequence at last `onDataAdded()`
+    bool sweep;               ///< sweep display is selected
+    QList<SweepBuffer*> sweepBuffers; ///< Y data of curves while sweep is active
+    unsigned sweepSize;       ///< buffer size at last `sweepData()`, 0 for full redraw
     int lineThickness;
 
     /// Common constructor
@@ -112,6 +126,16 @@ private:
     void _addCurve(QwtPlotCurve* curve);
     /// Check and make sure "no visible channels" text is shown
     void checkNoVisChannels();
+    /// Sets X axis of a plot from settings or history length
+    void resetXAxis(Plot* plot) const;
+    /**
+     * Sets Y data of curves from stream. Data is wrapped with
+     * `SweepBuffer`s if sweep is selected and possible (no history and
+     * X isn't provided by source).
+     */
+    void updateYData();
+    /// Updates sweep phase, redrawn parts and gap of plots for new data
+    void sweepData();
 
 private slots:
     void showGrid(bool show = true);
@@ -121,8 +145,18 @@ private slots:
     void unzoom();
     void darkBackground(bool enabled = true);
     void setSymbols(Plot::ShowSymbols shown);
+    void setIncremental(bool enabled);
+    void setSweep(bool enabled);
 
     void onNumChannelsChanged(unsigned value);
+    /// Replots and extends X axes while recording history
+    void onDataAdded();
+    /// Resets X axes when history recording starts or stops
+    void onHistoryChanged();
+    /// Points curves to new X buffers of the stream
+    void onXDataChanged();
+    /// Points curves to new data buffers of the stream
+    void onYDataChanged();
     void onChannelInfoChanged(const QModelIndex & topLeft,
                               const QModelIndex & bottomRight,
                               const QVector<int> & roles = QVector<int> ());
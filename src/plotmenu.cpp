@@ -32,6 +32,8 @@ PlotMenu::PlotMenu(QWidget* parent) :
     darkBackgroundAction("&Dark Background", this),
     showLegendAction("&Legend", this),
     showMultiAction("Multi &Plot", this),
+    incrementalAction("&Incremental Rendering", this),
+    sweepAction("S&weep Display", this),
     setSymbolsAction("&Symbols", this),
     setSymbolsAutoAct("Show When &Zoomed", this),
     setSymbolsShowAct("Always &Show", this),
@@ -49,6 +51,8 @@ PlotMenu::PlotMenu(QWidget* parent) :
     darkBackgroundAction.setToolTip("Enable Dark Plot Background");
     showLegendAction.setToolTip("Display the Legend on Plot");
     showMultiAction.setToolTip("Display All Channels Separately");
+    incrementalAction.setToolTip("Only Draw the New Part of Curves While Data Scrolls");
+    sweepAction.setToolTip("Overwrite Plot From Left to Right Instead of Scrolling");
     setSymbolsAction.setToolTip("Show/Hide symbols");
 
     showGridAction.setShortcut(QKeySequence("G"));
@@ -59,12 +63,16 @@ PlotMenu::PlotMenu(QWidget* parent) :
     darkBackgroundAction.setCheckable(true);
     showLegendAction.setCheckable(true);
     showMultiAction.setCheckable(true);
+    incrementalAction.setCheckable(true);
+    sweepAction.setCheckable(true);
 
     showGridAction.setChecked(false);
     showMinorGridAction.setChecked(false);
     darkBackgroundAction.setChecked(false);
     showLegendAction.setChecked(true);
     showMultiAction.setChecked(false);
+    incrementalAction.setChecked(true);
+    sweepAction.setChecked(false);
 
     // minor grid is only enabled when _major_ grid is enabled
     showMinorGridAction.setEnabled(false);
@@ -145,6 +153,8 @@ PlotMenu::PlotMenu(QWidget* parent) :
     addAction(&setLegendPosAction);
     addAction(&showMultiAction);
     addAction(&setSymbolsAction);
+    addAction(&sweepAction);
+    addAction(&incrementalAction);
 }
 
 PlotMenu::PlotMenu(PlotViewSettings s, QWidget* parent) :
@@ -211,6 +221,8 @@ void PlotMenu::saveSettings(QSettings* settings)
     settings->setValue(SG_Plot_MinorGrid, showMinorGridAction.isChecked());
     settings->setValue(SG_Plot_Legend, showLegendAction.isChecked());
     settings->setValue(SG_Plot_MultiPlot, showMultiAction.isChecked());
+    settings->setValue(SG_Plot_Incremental, incrementalAction.isChecked());
+    settings->setValue(SG_Plot_Sweep, sweepAction.isChecked());
 
     // save symbol option
     QString showSymbolsStr;
@@ -265,6 +277,10 @@ void PlotMenu::loadSettings(QSettings* settings)
         settings->value(SG_Plot_Legend, showLegendAction.isChecked()).toBool());
     showMultiAction.setChecked(
         settings->value(SG_Plot_MultiPlot, showMultiAction.isChecked()).toBool());
+    incrementalAction.setChecked(
+        settings->value(SG_Plot_Incremental, incrementalAction.isChecked()).toBool());
+    sweepAction.setChecked(
+        settings->value(SG_Plot_Sweep, sweepAction.isChecked()).toBool());
 
     // load symbol option
     QString showSymbolsStr = settings->value(SG_Plot_Symbols, QString()).toString();
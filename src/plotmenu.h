@@ -51,6 +51,8 @@ public:
     QAction darkBackgroundAction;
     QAction showLegendAction;
     QAction showMultiAction;
+    QAction incrementalAction;
+    QAction sweepAction;
 
     /// Returns a bundle of current view settings (menu selections)
     PlotViewSettings viewSettings() const;
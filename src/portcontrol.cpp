@@ -39,7 +39,7 @@ const QMap<QSerialPort::Parity, QString> paritySettingMap({
         {QSerialPort::EvenParity, "even"},
     });
 
-PortControl::PortControl(QSerialPort* port, QWidget* parent) :
+PortControl::PortControl(AsyncSerialPort* port, QWidget* parent) :
     QWidget(parent),
     ui(new Ui::PortControl),
     portToolBar("Port Toolbar"),
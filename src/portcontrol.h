@@ -30,6 +30,7 @@
 #include <QSettings>
 #include <QTimer>
 
+#include "asyncserialport.h"
 #include "portlist.h"
 extern quint32  CurrentBaudRate;
 namespace Ui {
@@ -41,10 +42,10 @@ class PortControl : public QWidget
     Q_OBJECT
 
 public:
-    explicit PortControl(QSerialPort* port, QWidget* parent = 0);
+    explicit PortControl(AsyncSerialPort* port, QWidget* parent = 0);
     ~PortControl();
 
-    QSerialPort* serialPort;
+    AsyncSerialPort* serialPort;
 
     QToolBar* toolBar();
 
@@ -329,8 +329,9 @@ bool RecordPanel::startRecording(QString fileName)
 
 void RecordPanel::stopRecording(void)
 {
-    recorder.stopRecording();
+    // disconnecting waits for pending data to be written
     _stream->disconnectFollower(&recorder);
+    recorder.stopRecording();
 }
 
 void RecordPanel::onPortClose()
@@ -0,0 +1,203 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <QEvent>
+#include <QtGlobal>
+
+#include "renderscheduler.h"
+
+RenderScheduler::RenderScheduler(QObject* parent) :
+    QObject(parent)
+{
+    _maxFps = 60;
+    starting = false;
+    frameTimer.setSingleShot(true);
+    connect(&frameTimer, &QTimer::timeout, this, &RenderScheduler::renderFrame);
+    sinceFrame.start();
+}
+
+void RenderScheduler::add(QObject* target, QWidget* view, std::function<void()> render)
+{
+    Q_ASSERT(target != nullptr && view != nullptr);
+
+    // catch up when view is shown again
+    if (!isWatched(view))
+    {
+        view->installEventFilter(this);
+        connect(view, &QObject::destroyed, this, &RenderScheduler::removeView);
+    }
+
+    targets.append({target, view, nullptr, render, false});
+    connect(target, &QObject::destroyed, this, &RenderScheduler::remove);
+}
+
+void RenderScheduler::remove(QObject* target)
+{
+    for (int i = 0; i < targets.size(); i++)
+    {
+        if (targets[i].target == target)
+        {
+            unwatch(targets.takeAt(i));
+            return;
+        }
+    }
+}
+
+void RenderScheduler::removeView(QObject* view)
+{
+    for (int i = 0; i < targets.size();)
+    {
+        if (targets[i].view == view)
+        {
+            disconnect(targets[i].target, &QObject::destroyed,
+                       this, &RenderScheduler::remove);
+            unwatch(targets.takeAt(i));
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+bool RenderScheduler::isWatched(const QObject* obj) const
+{
+    for (auto& t : targets)
+    {
+        if (t.view == obj || t.window == obj) return true;
+    }
+    return false;
+}
+
+void RenderScheduler::watchWindow(Target& t)
+{
+    QWidget* window = t.view->window();
+    if (t.window == window) return;
+
+    // view may be re-parented after `add()`, stop watching its old window
+    QWidget* old = t.window;
+    t.window = nullptr;
+    if (old != nullptr) unwatch(old);
+
+    if (!isWatched(window)) window->installEventFilter(this);
+    t.window = window;
+}
+
+void RenderScheduler::unwatch(QObject* obj)
+{
+    if (!isWatched(obj)) obj->removeEventFilter(this);
+}
+
+void RenderScheduler::unwatch(const Target& t)
+{
+    if (!isWatched(t.view))
+    {
+        disconnect(t.view, &QObject::destroyed, this, &RenderScheduler::removeView);
+    }
+    unwatch(t.view);
+    if (t.window != nullptr) unwatch(t.window.data());
+}
+
+unsigned RenderScheduler::maxFps() const
+{
+    return _maxFps;
+}
+
+void RenderScheduler::setMaxFps(unsigned fps)
+{
+    Q_ASSERT(fps > 0);
+    _maxFps = fps;
+}
+
+void RenderScheduler::markDirty(QObject* target)
+{
+    for (auto& t : targets)
+    {
+        if (t.target == target)
+        {
+            t.dirty = true;
+            scheduleFrame();
+            return;
+        }
+    }
+    Q_ASSERT_X(false, "RenderScheduler::markDirty", "unknown target");
+}
+
+void RenderScheduler::requestFrame()
+{
+    scheduleFrame();
+}
+
+void RenderScheduler::scheduleFrame()
+{
+    // targets marked while starting are rendered with current frame
+    if (starting || frameTimer.isActive()) return;
+
+    // render right away if last frame is old enough
+    qint64 interval = 1000 / _maxFps;
+    qint64 wait = interval - sinceFrame.elapsed();
+    frameTimer.start(std::max(qint64(0), wait));
+}
+
+bool RenderScheduler::isShown(const Target& t) const
+{
+    return t.view->isVisible() && !t.view->window()->isMinimized();
+}
+
+void RenderScheduler::renderFrame()
+{
+    sinceFrame.start();
+    starting = true;
+    emit frameStarted();
+    starting = false;
+
+    // index based, render functions may add or remove targets
+    for (int i = 0; i < targets.size(); i++)
+    {
+        if (!targets[i].dirty) continue;
+
+        if (isShown(targets[i]))
+        {
+            targets[i].dirty = false;
+            auto render = targets[i].render;
+            render();
+        }
+        else
+        {
+            watchWindow(targets[i]);
+        }
+    }
+}
+
+bool RenderScheduler::eventFilter(QObject* obj, QEvent* event)
+{
+    if (event->type() == QEvent::Show || event->type() == QEvent::WindowStateChange)
+    {
+        for (auto& t : targets)
+        {
+            if (t.dirty && (t.view == obj || t.view->window() == obj))
+            {
+                scheduleFrame();
+                break;
+            }
+        }
+    }
+    return QObject::eventFilter(obj, event);
+}
@@ -0,0 +1,123 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+#include <functional>
+#include <QObject>
+#include <QPointer>
+#include <QWidget>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QList>
+
+/**
+ * Coalesces repaint requests of plots into frames.
+ *
+ * Plots register a render function with `add()` and call `markDirty()`
+ * whenever their data changes, instead of repainting right away. Dirty
+ * targets are rendered together at most `maxFps()` times per second, so
+ * bursts of incoming data result in a single repaint.
+ *
+ * Data that is queued for plots can be handed over with the
+ * `frameStarted()` signal, a frame for it is requested with
+ * `requestFrame()`.
+ *
+ * Targets whose view is hidden (or in a minimized window) aren't
+ * rendered, they stay dirty and are rendered when they are shown. To
+ * notice that, views and their windows are event filtered; each is
+ * filtered once, until its last target is removed.
+ */
+class RenderScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RenderScheduler(QObject* parent = 0);
+
+    /**
+     * Registers a render target. Target is removed when it or its view
+     * is destroyed.
+     *
+     * @param target identifies the target for `markDirty()`
+     * @param view widget that is checked for visibility
+     * @param render called to repaint the target
+     */
+    void add(QObject* target, QWidget* view, std::function<void()> render);
+    /// Removes a target, it's not rendered even if it's dirty.
+    void remove(QObject* target);
+
+    /// Returns the maximum number of frames per second
+    unsigned maxFps() const;
+
+signals:
+    /// Emitted at the start of each frame before targets are
+    /// rendered. Targets that are marked dirty by its receivers are
+    /// rendered with this frame.
+    void frameStarted();
+
+public slots:
+    /// Requests a repaint of `target` with the next frame
+    void markDirty(QObject* target);
+    /// Requests a frame even if no target is dirty
+    void requestFrame();
+    /// Sets the maximum number of frames per second, must be > 0
+    void setMaxFps(unsigned fps);
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* event) override;
+
+private:
+    struct Target
+    {
+        QObject* target;
+        QWidget* view;
+        QPointer<QWidget> window; ///< watched window of view, see `watchWindow()`
+        std::function<void()> render;
+        bool dirty;
+    };
+
+    QList<Target> targets;
+    unsigned _maxFps;
+    QTimer frameTimer;
+    QElapsedTimer sinceFrame;   ///< time since last frame is rendered
+    bool starting;              ///< `frameStarted()` is being emitted
+
+    /// Starts the frame timer if it's not already running
+    void scheduleFrame();
+    /// Returns true if view of target can be seen
+    bool isShown(const Target& t) const;
+    /// Returns true if `obj` is the view or watched window of a target
+    bool isWatched(const QObject* obj) const;
+    /// Starts filtering events of current window of target's view
+    void watchWindow(Target& t);
+    /// Stops filtering events of `obj` if no target watches it anymore
+    void unwatch(QObject* obj);
+    /// Stops filtering events of a removed target's view and window
+    void unwatch(const Target& t);
+
+private slots:
+    /// Renders all dirty targets that are shown
+    void renderFrame();
+    /// Removes targets of a destroyed view
+    void removeView(QObject* view);
+};
+
+#endif // RENDERSCHEDULER_H
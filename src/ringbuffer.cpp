@@ -18,79 +18,127 @@
 */
 
 #include <QtGlobal>
+#include <algorithm>
+#include <string.h>
 
 #include "ringbuffer.h"
+#include "minmax.h"
+#include "allocator.h"
 
-RingBuffer::RingBuffer(unsigned n)
+template <typename T>
+RingBufferT<T>::RingBufferT(unsigned n)
 {
     _size = n;
-    data = new double[_size]();
+    data = static_cast<T*>(allocAligned(sizeof(T) * _size, MemoryUser_Channels));
     headIndex = 0;
 
-    limInvalid = false;
-    limCache = {0, 0};
+    pyramid.build(data, _size);
+    numDirty = 0;
 }
 
-RingBuffer::~RingBuffer()
+template <typename T>
+RingBufferT<T>::~RingBufferT()
 {
-    delete[] data;
+    freeAligned(data, sizeof(T) * _size, MemoryUser_Channels);
 }
 
-unsigned RingBuffer::size() const
+template <typename T>
+unsigned RingBufferT<T>::size() const
 {
     return _size;
 }
 
-double RingBuffer::sample(unsigned i) const
+template <typename T>
+double RingBufferT<T>::sample(unsigned i) const
 {
     unsigned index = headIndex + i;
     if (index >= _size) index -= _size;
     return data[index];
 }
 
-Range RingBuffer::limits() const
+template <typename T>
+Range RingBufferT<T>::limits() const
 {
-    if (limInvalid) updateLimits();
-    return limCache;
+    updateLimits();
+    return pyramid.limits();
 }
 
-void RingBuffer::resize(unsigned n)
+template <typename T>
+Range RingBufferT<T>::rangeLimits(unsigned start, unsigned n) const
 {
-    Q_ASSERT(n != _size);
-
-    int offset = (int) n - (int) _size;
-    if (offset == 0) return;
+    Q_ASSERT(n > 0 && start + n <= _size);
 
-    double* newData = new double[n];
+    updateLimits();
 
-    // move data to new array
-    int fill_start = offset > 0 ? offset : 0;
+    unsigned pstart = headIndex + start;
+    if (pstart >= _size) pstart -= _size;
 
-    for (int i = fill_start; i < int(n); i++)
+    if (pstart + n <= _size) // no wrap around
     {
-        newData[i] = sample(i - offset);
+        return pyramid.limits(data, pstart, pstart + n);
     }
-
-    // fill the beginning of the new data
-    if (fill_start > 0)
+    else
     {
-        for (int i = 0; i < fill_start; i++)
-        {
-            newData[i] = 0;
-        }
+        return combineLimits(pyramid.limits(data, pstart, _size),
+                             pyramid.limits(data, 0, pstart + n - _size));
     }
+}
+
+template <typename T>
+void RingBufferT<T>::copySamples(unsigned start, unsigned n, double* out) const
+{
+    copyTo(start, n, out);
+}
+
+template <typename T> template <typename D>
+void RingBufferT<T>::copyTo(unsigned start, unsigned n, D* out) const
+{
+    Q_ASSERT(start + n <= _size);
+
+    unsigned pstart = headIndex + start;
+    if (pstart >= _size) pstart -= _size;
+
+    // first segment is until the end of array, second one wraps around
+    unsigned n1 = std::min(n, _size - pstart);
+    std::copy(data + pstart, data + pstart + n1, out);
+    std::copy(data, data + (n - n1), out + n1);
+}
+
+template <typename T>
+void RingBufferT<T>::resize(unsigned n)
+{
+    Q_ASSERT(n != _size);
+
+    int offset = (int) n - (int) _size;
+    if (offset == 0) return;
+
+    // new array is zero initialized (lazily for big arrays), so the
+    // beginning is already filled when growing
+    T* newData = static_cast<T*>(allocAligned(sizeof(T) * n, MemoryUser_Channels));
+
+    // move data to new array in at most 2 bulk copies
+    int fill_start = offset > 0 ? offset : 0;
+    unsigned start = fill_start - offset;
+    unsigned numKeep = n - fill_start;
+    unsigned pstart = headIndex + start;
+    if (pstart >= _size) pstart -= _size;
+    unsigned n1 = std::min(numKeep, _size - pstart);
+    memcpy(newData + fill_start, data + pstart, sizeof(T) * n1);
+    memcpy(newData + fill_start + n1, data, sizeof(T) * (numKeep - n1));
 
     // data is ready, clean up and re-point
-    delete data;
+    freeAligned(data, sizeof(T) * _size, MemoryUser_Channels);
     data = newData;
     headIndex = 0;
     _size = n;
 
-    // invalidate bounding rectangle
-    limInvalid = true;
+    // re-build the limits pyramid for new layout
+    pyramid.build(data, _size);
+    numDirty = 0;
 }
 
-void RingBuffer::addSamples(double* samples, unsigned n)
+template <typename T>
+void RingBufferT<T>::addSamples(const double* samples, unsigned n)
 {
     unsigned shift = n;
     if (shift < _size)
@@ -136,37 +184,57 @@ void RingBuffer::addSamples(double* samples, unsigned n)
         headIndex = 0;
     }
 
-    // invalidate cache
-    limInvalid = true;
+    // invalidate limits
+    numDirty = std::min(_size, numDirty + n);
 }
 
-void RingBuffer::clear()
+template <typename T>
+void RingBufferT<T>::clear()
 {
     for (unsigned i=0; i < _size; i++)
     {
-        data[i] = 0.;
+        data[i] = 0;
     }
 
-    limCache = {0, 0};
-    limInvalid = false;
+    pyramid.build(data, _size);
+    numDirty = 0;
 }
 
-void RingBuffer::updateLimits() const
+template <typename T>
+void RingBufferT<T>::updateLimits() const
 {
-    limCache.start = data[0];
-    limCache.end = data[0];
+    if (numDirty == 0) return;
 
-    for (unsigned i = 0; i < _size; i++)
+    if (numDirty >= _size)
     {
-        if (data[i] > limCache.end)
+        pyramid.update(data, 0, _size);
+    }
+    else
+    {
+        // dirty samples are in range [dirtyStart, headIndex) (may wrap around)
+        unsigned dirtyStart = headIndex >= numDirty ?
+            headIndex - numDirty : headIndex + _size - numDirty;
+        unsigned dirtyEnd = headIndex == 0 ? _size : headIndex;
+
+        if (dirtyStart < dirtyEnd) // no wrap around
         {
-            limCache.end = data[i];
+            pyramid.update(data, dirtyStart, dirtyEnd);
         }
-        else if (data[i] < limCache.start)
+        else
         {
-            limCache.start = data[i];
+            pyramid.update(data, dirtyStart, _size);
+            pyramid.update(data, 0, dirtyEnd);
         }
     }
 
-    limInvalid = false;
+    numDirty = 0;
 }
+
+template class RingBufferT<quint8>;
+template class RingBufferT<quint16>;
+template class RingBufferT<quint32>;
+template class RingBufferT<qint8>;
+template class RingBufferT<qint16>;
+template class RingBufferT<qint32>;
+template class RingBufferT<float>;
+template class RingBufferT<double>;
@@ -21,29 +21,51 @@
 #define RINGBUFFER_H
 
 #include "framebuffer.h"
+#include "minmaxpyramid.h"
 
-/// A fast buffer implementation for storing data.
-class RingBuffer : public WFrameBuffer
+/**
+ * A fast buffer implementation for storing data.
+ *
+ * Samples are stored as `T` which can be a more compact type than
+ * `double` (ex: `qint16` for data that is read as 16 bits
+ * integers). Samples are converted when written and read. It's up to
+ * the user to select a type that can represent the written samples.
+ */
+template <typename T>
+class RingBufferT : public WFrameBuffer
 {
 public:
-    RingBuffer(unsigned n);
-    ~RingBuffer();
+    RingBufferT(unsigned n);
+    ~RingBufferT();
 
     virtual unsigned size() const;
     virtual double sample(unsigned i) const;
     virtual Range limits() const;
+    virtual Range rangeLimits(unsigned start, unsigned n) const;
+    virtual void copySamples(unsigned start, unsigned n, double* out) const;
     virtual void resize(unsigned n);
-    virtual void addSamples(double* samples, unsigned n);
+    virtual void addSamples(const double* samples, unsigned n);
     virtual void clear();
 
 private:
     unsigned _size;            ///< size of `data`
-    double* data;              ///< storage
+    T* data;                   ///< storage
     unsigned headIndex;        ///< indicates the actual `0` index of the ring buffer
 
-    mutable bool limInvalid;   ///< Indicates that limits needs to be re-calculated
-    mutable Range limCache;    ///< Cache for limits()
-    void updateLimits() const; ///< Updates limits cache
+    /// Min/max summary of `data`. Only the parts that are written since
+    /// last query are re-calculated.
+    mutable MinMaxPyramid pyramid;
+    /// Number of samples written since last pyramid update. These samples
+    /// end at `headIndex`. If it's equal to `_size` whole pyramid is updated.
+    mutable unsigned numDirty;
+    /// Updates the pyramid for samples written since last update
+    void updateLimits() const;
+    /// Copies `n` samples starting from `start` to `out`, converting them
+    /// to `D`. Data is copied as at most 2 contiguous segments.
+    template <typename D> void copyTo(unsigned start, unsigned n, D* out) const;
 };
 
+/// Ring buffer that stores samples as `double`
+typedef RingBufferT<double> RingBuffer;
+
 #endif
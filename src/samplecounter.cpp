@@ -28,7 +28,7 @@ SampleCounter::SampleCounter()
 
 #include <QtDebug>
 
-void SampleCounter::feedIn(const SamplePack& data)
+void SampleCounter::feedIn(const SamplePackView& data)
 {
     count += data.numSamples();
 
@@ -31,9 +31,12 @@ class SampleCounter : public QObject, public Sink
 public:
     SampleCounter();
 
+    /// Only emits a queued signal, can be fed from a `SinkPool`
+    bool isThreadSafe() const override {return true;};
+
 protected:
     // implementations for `Sink`
-    virtual void feedIn(const SamplePack& data);
+    virtual void feedIn(const SamplePackView& data);
 
 signals:
     /// Emitted per second if SPS value has changed.
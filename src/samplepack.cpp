@@ -18,9 +18,19 @@
 */
 
 #include <cstring>
+#include <utility>
 #include <QtGlobal>
 
 #include "samplepack.h"
+#include "allocator.h"
+
+SamplePack::SamplePack()
+{
+    _numSamples = 0;
+    _numChannels = 0;
+    _xData = nullptr;
+    _yData = nullptr;
+}
 
 SamplePack::SamplePack(unsigned ns, unsigned nc, bool x)
 {
@@ -29,35 +39,56 @@ SamplePack::SamplePack(unsigned ns, unsigned nc, bool x)
     _numSamples = ns;
     _numChannels = nc;
 
-    _yData = new double[_numSamples * _numChannels]();
-    if (x)
-    {
-        _xData = new double[_numSamples]();
-    }
-    else
-    {
-        _xData = nullptr;
-    }
+    // packs are short lived, they are taken from pool; X is stored
+    // after channels in the same block
+    size_t bytes = sizeof(double) * ns * (nc + (x ? 1 : 0));
+    _yData = static_cast<double*>(allocPooled(bytes, MemoryUser_Packs));
+    _xData = x ? _yData + ns * nc : nullptr;
+    memset(_yData, 0, bytes);
 }
 
 SamplePack::SamplePack(const SamplePack& other) :
     SamplePack(other.numSamples(), other.numChannels(), other.hasX())
 {
-    size_t dataSize = sizeof(double) * numSamples();
-    if (hasX())
-        memcpy(xData(), other.xData(), dataSize);
-    memcpy(_yData, other._yData, dataSize * numChannels());
+    memcpy(_yData, other._yData, blockSize());
+}
+
+SamplePack::SamplePack(SamplePack&& other) :
+    SamplePack()
+{
+    *this = std::move(other);
 }
 
 SamplePack::~SamplePack()
 {
-    delete[] _yData;
-    if (_xData != nullptr)
+    if (_yData != nullptr)
     {
-        delete[] _xData;
+        freePooled(_yData, blockSize(), MemoryUser_Packs);
     }
 }
 
+SamplePack& SamplePack::operator=(SamplePack&& other)
+{
+    if (this != &other)
+    {
+        if (_yData != nullptr)
+        {
+            freePooled(_yData, blockSize(), MemoryUser_Packs);
+        }
+
+        _numSamples = other._numSamples;
+        _numChannels = other._numChannels;
+        _xData = other._xData;
+        _yData = other._yData;
+
+        other._numSamples = 0;
+        other._numChannels = 0;
+        other._xData = nullptr;
+        other._yData = nullptr;
+    }
+    return *this;
+}
+
 bool SamplePack::hasX() const
 {
     return _xData != nullptr;
@@ -96,3 +127,8 @@ double* SamplePack::data(unsigned channel)
 {
     return const_cast<double*>(static_cast<const SamplePack&>(*this).data(channel));
 }
+
+size_t SamplePack::blockSize() const
+{
+    return sizeof(double) * _numSamples * (_numChannels + (hasX() ? 1 : 0));
+}
@@ -20,9 +20,21 @@
 #ifndef SAMPLEPACK_H
 #define SAMPLEPACK_H
 
+#include <stddef.h>
+
+/**
+ * Samples of all channels that are read from device at once.
+ *
+ * Data of X and all channels are kept in a single block from the pool
+ * (see `allocPooled()`), so creating packs of similar sizes repeatedly
+ * doesn't allocate from the system. Packs can be moved, a moved-from
+ * pack is empty.
+ */
 class SamplePack
 {
 public:
+    /// Creates an empty pack, it has no channels and no samples.
+    SamplePack();
     /**
      * @param ns number of samples
      * @param nc number of channels
@@ -30,8 +42,11 @@ public:
      */
     SamplePack(unsigned ns, unsigned nc, bool x = false);
     SamplePack(const SamplePack& other);
+    SamplePack(SamplePack&& other);
     ~SamplePack();
 
+    SamplePack& operator=(SamplePack&& other);
+
     bool hasX() const;
     unsigned numChannels() const;
     unsigned numSamples() const;
@@ -43,8 +58,11 @@ public:
 
 private:
     unsigned _numSamples, _numChannels;
-    double* _xData;
+    double* _xData;             ///< points into `_yData` block
     double* _yData;
+
+    /// Size of the data block in bytes
+    size_t blockSize() const;
 };
 
 #endif // SAMPLEPACK_H
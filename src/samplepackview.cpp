@@ -0,0 +1,141 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+
+#include "samplepackview.h"
+
+SamplePackView::SamplePackView(const SamplePack& pack) :
+    SamplePackView(pack.numSamples(), pack.numChannels(),
+                   pack.numChannels() ? pack.data(0) : nullptr,
+                   pack.numSamples(), 1,
+                   pack.hasX() ? pack.xData() : nullptr, 1)
+{
+}
+
+SamplePackView::SamplePackView(unsigned ns, unsigned nc, const double* data,
+                               size_t channelStride, size_t sampleStride,
+                               const double* xData, size_t xStride)
+{
+    _numSamples = ns;
+    _numChannels = nc;
+    _data = data;
+    _channelStride = channelStride;
+    _sampleStride = sampleStride;
+    _xData = xData;
+    _xStride = xStride;
+}
+
+SamplePackView SamplePackView::planar(unsigned ns, unsigned nc, const double* data,
+                                      const double* xData)
+{
+    return SamplePackView(ns, nc, data, ns, 1, xData, 1);
+}
+
+SamplePackView SamplePackView::interleaved(unsigned ns, unsigned nc, const double* data,
+                                           bool x)
+{
+    size_t rowSize = nc + (x ? 1 : 0);
+    return x ?
+        SamplePackView(ns, nc, data + 1, 1, rowSize, data, rowSize) :
+        SamplePackView(ns, nc, data, 1, rowSize);
+}
+
+bool SamplePackView::isPlanar() const
+{
+    return (_sampleStride == 1 || _numSamples <= 1) &&
+        (!hasX() || _xStride == 1 || _numSamples <= 1);
+}
+
+bool SamplePackView::isInterleaved() const
+{
+    size_t rowSize = _numChannels + (hasX() ? 1 : 0);
+    return (_channelStride == 1 || _numChannels <= 1) &&
+        (_sampleStride == rowSize || _numSamples <= 1) &&
+        (!hasX() || (_xData + 1 == _data && (_xStride == rowSize || _numSamples <= 1)));
+}
+
+const double* SamplePackView::data(unsigned ci) const
+{
+    Q_ASSERT(ci < _numChannels);
+    Q_ASSERT(isPlanar());
+
+    return _data + ci * _channelStride;
+}
+
+const double* SamplePackView::xData() const
+{
+    Q_ASSERT(hasX());
+    Q_ASSERT(isPlanar());
+
+    return _xData;
+}
+
+void SamplePackView::copyChannel(unsigned ci, unsigned i, unsigned n, double* out) const
+{
+    Q_ASSERT(ci < _numChannels && i + n <= _numSamples);
+
+    const double* src = _data + ci * _channelStride + i * _sampleStride;
+    if (_sampleStride == 1)
+    {
+        memcpy(out, src, n * sizeof(double));
+        return;
+    }
+    for (unsigned j = 0; j < n; j++)
+    {
+        out[j] = src[j * _sampleStride];
+    }
+}
+
+void SamplePackView::copyX(unsigned i, unsigned n, double* out) const
+{
+    Q_ASSERT(hasX() && i + n <= _numSamples);
+
+    const double* src = _xData + i * _xStride;
+    if (_xStride == 1)
+    {
+        memcpy(out, src, n * sizeof(double));
+        return;
+    }
+    for (unsigned j = 0; j < n; j++)
+    {
+        out[j] = src[j * _xStride];
+    }
+}
+
+void SamplePackView::copyRows(double* out) const
+{
+    size_t rowSize = _numChannels + (hasX() ? 1 : 0);
+    if (isInterleaved())
+    {
+        memcpy(out, hasX() ? _xData : _data, _numSamples * rowSize * sizeof(double));
+        return;
+    }
+
+    unsigned first = hasX() ? 1 : 0;
+    for (unsigned i = 0; i < _numSamples; i++)
+    {
+        double* row = out + i * rowSize;
+        if (hasX()) row[0] = x(i);
+        for (unsigned ci = 0; ci < _numChannels; ci++)
+        {
+            row[first + ci] = sample(ci, i);
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SAMPLEPACKVIEW_H
+#define SAMPLEPACKVIEW_H
+
+#include <stddef.h>
+#include <QtGlobal>
+
+#include "samplepack.h"
+
+/**
+ * A non-owning view of samples that are laid out in memory with
+ * strides. Both planar data (channels are contiguous, like
+ * `SamplePack`) and interleaved rows (samples of all channels are next
+ * to each other) can be described.
+ *
+ * Viewed memory is borrowed, it must stay valid while the view is
+ * used. Views that are fed to sinks are valid only during the
+ * `Sink::feedIn` call.
+ */
+class SamplePackView
+{
+public:
+    /// Planar view of all data of `pack`
+    SamplePackView(const SamplePack& pack);
+    /**
+     * @param ns number of samples
+     * @param nc number of channels
+     * @param data first sample of first channel
+     * @param channelStride distance of channels in number of elements
+     * @param sampleStride distance of consecutive samples of a channel
+     * @param xData first X sample, `nullptr` if there is no X
+     * @param xStride distance of consecutive X samples
+     */
+    SamplePackView(unsigned ns, unsigned nc, const double* data,
+                   size_t channelStride, size_t sampleStride,
+                   const double* xData = nullptr, size_t xStride = 1);
+
+    /// Returns a view of `nc` channels of `ns` samples stored one after another
+    static SamplePackView planar(unsigned ns, unsigned nc, const double* data,
+                                 const double* xData = nullptr);
+    /// Returns a view of `ns` rows. Each row has `nc` channel samples,
+    /// preceded by an X sample if `x` is true.
+    static SamplePackView interleaved(unsigned ns, unsigned nc, const double* data,
+                                      bool x = false);
+
+    bool hasX() const {return _xData != nullptr;};
+    unsigned numChannels() const {return _numChannels;};
+    unsigned numSamples() const {return _numSamples;};
+    /// Samples of each channel (and X) are contiguous
+    bool isPlanar() const;
+    /// Rows are contiguous, laid out like `interleaved()` views
+    bool isInterleaved() const;
+
+    /// Returns sample `i` of channel `ci`
+    double sample(unsigned ci, unsigned i) const
+    {
+        Q_ASSERT(ci < _numChannels && i < _numSamples);
+        return _data[ci * _channelStride + i * _sampleStride];
+    };
+    /// Returns X sample `i`
+    double x(unsigned i) const
+    {
+        Q_ASSERT(hasX() && i < _numSamples);
+        return _xData[i * _xStride];
+    };
+
+    /// Returns contiguous data of a channel. Only for planar views.
+    const double* data(unsigned ci) const;
+    /// Returns contiguous X data. Only for planar views.
+    const double* xData() const;
+
+    /// Copies `n` samples of channel `ci` starting from `i` to `out`
+    void copyChannel(unsigned ci, unsigned i, unsigned n, double* out) const;
+    /// Copies `n` X samples starting from `i` to `out`
+    void copyX(unsigned i, unsigned n, double* out) const;
+    /// Copies all samples to `out` as rows, in the layout of `interleaved()` views
+    void copyRows(double* out) const;
+
+private:
+    unsigned _numSamples, _numChannels;
+    const double* _data;
+    size_t _channelStride, _sampleStride;
+    const double* _xData;
+    size_t _xStride;
+};
+
+#endif // SAMPLEPACKVIEW_H
@@ -73,6 +73,32 @@ void ScrollZoomer::setXLimits(double min, double max)
     setZoomBase();
 }
 
+void ScrollZoomer::extendXLimits(double max)
+{
+    double oldMax = xMax;
+    xMax = max;
+
+    auto zs = zoomStack();
+    for (int i = 0; i < zs.size(); i++)
+    {
+        if (zs[i].right() < oldMax) continue;
+
+        // base grows until it reaches the view size
+        if (i == 0 && (xMax - xMin) <= hViewSize)
+        {
+            zs[i].setRight(xMax);
+        }
+        else
+        {
+            zs[i].moveRight(xMax);
+        }
+    }
+    setZoomStack(zs, zoomRectIndex());
+
+    // limits of scrollbar are changed even if zoom rect didn't move
+    updateScrollBars();
+}
+
 void ScrollZoomer::setHViewSize(double size)
 {
     hscrollmove = true;
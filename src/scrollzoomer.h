@@ -51,6 +51,9 @@ public:
     virtual bool eventFilter( QObject *, QEvent * );
 
     void setXLimits(double min, double max);
+    /// Moves the upper X limit without resetting the zoom. Zoom rects that
+    /// are at the old limit follow it, others keep their position.
+    void extendXLimits(double max);
     void setHViewSize(double size);
     virtual void setZoomBase(bool doReplot = true);
     virtual void rescale();
@@ -99,6 +99,7 @@ const char SG_Plot_IndexAsX[] = "indexAsX";
 const char SG_Plot_XMax[] = "xMax";
 const char SG_Plot_XMin[] = "xMin";
 const char SG_Plot_AutoScale[] = "autoScale";
+const char SG_Plot_AutoScaleVisible[] = "autoScaleVisible";
 const char SG_Plot_YMax[] = "yMax";
 const char SG_Plot_YMin[] = "yMin";
 const char SG_Plot_DarkBackground[] = "darkBackground";
@@ -108,7 +109,11 @@ const char SG_Plot_Legend[] = "legend";
 const char SG_Plot_LegendPos[] = "legendPos";
 const char SG_Plot_MultiPlot[] = "multiPlot";
 const char SG_Plot_Symbols[] = "symbols";
+const char SG_Plot_Incremental[] = "incremental";
+const char SG_Plot_Sweep[] = "sweep";
 const char SG_Plot_LineThickness[] = "lineThickness";
+const char SG_Plot_MaxFps[] = "maxFps";
+const char SG_Plot_History[] = "history";
 
 // command setting keys
 const char SG_Commands_Command[] = "command";
@@ -19,6 +19,7 @@
 
 #include <QtGlobal>
 #include "sink.h"
+#include "sinkpool.h"
 
 void Sink::connectFollower(Sink* sink)
 {
@@ -33,10 +34,30 @@ void Sink::disconnectFollower(Sink* sink)
     Q_ASSERT(followers.contains(sink));
 
     followers.removeOne(sink);
+    // no more data after disconnection
+    if (pool != nullptr) pool->remove(sink);
 }
 
-void Sink::feedIn(const SamplePack& data)
+void Sink::setFollowerPool(SinkPool* p)
 {
+    if (pool != nullptr)
+    {
+        for (auto sink : followers)
+        {
+            pool->remove(sink);
+        }
+    }
+    pool = p;
+}
+
+void Sink::feedIn(const SamplePackView& data)
+{
+    if (pool != nullptr)
+    {
+        pool->feed(followers, data);
+        return;
+    }
+
     for (auto sink : followers)
     {
         sink->feedIn(data);
@@ -49,6 +70,8 @@ void Sink::setNumChannels(unsigned nc, bool x)
     _hasX = x;
     for (auto sink : followers)
     {
+        // pending data is in old layout
+        if (pool != nullptr) pool->flush(sink);
         sink->setNumChannels(nc, x);
     }
 }
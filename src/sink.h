@@ -21,9 +21,10 @@
 #define SINK_H
 
 #include <QList>
-#include "samplepack.h"
+#include "samplepackview.h"
 
 class Source;
+class SinkPool;
 
 class Sink
 {
@@ -43,10 +44,19 @@ public:
     const Source* connectedSource() const;
     Source* connectedSource();
 
+    /// Returns true if `feedIn` can be called from a worker thread of
+    /// a `SinkPool`. Calls for the same sink are never concurrent and
+    /// keep their order. Default is `false`.
+    virtual bool isThreadSafe() const {return false;};
+
+    /// Feeds thread-safe followers on given pool. `nullptr` (default)
+    /// feeds all followers on the calling thread.
+    void setFollowerPool(SinkPool* pool);
+
 protected:
     /// Entry point for incoming data. Re-implementations should
     /// call this function to feed followers.
-    virtual void feedIn(const SamplePack& data);
+    virtual void feedIn(const SamplePackView& data);
 
     /// Is set by connected source. Re-implementations should call
     /// this function to update followers.
@@ -62,10 +72,12 @@ protected:
     void setSource(Source* s);
 
     friend Source;
+    friend SinkPool;
 
 private:
     QList<Sink*> followers;
     Source* source = nullptr;   ///< source that this sink is connected to
+    SinkPool* pool = nullptr;   ///< feeds followers if set
     bool _hasX;
     unsigned _numChannels;
 };
@@ -0,0 +1,337 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <QtGlobal>
+
+#include "sinkpool.h"
+
+/// Pool of the worker running on this thread, if any
+static thread_local const SinkPool* currentPool = nullptr;
+
+SinkPool::SinkPool(unsigned numThreads, unsigned maxDepth, OverflowPolicy policy) :
+    nextWorker(0)
+{
+    if (numThreads == 0)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _numThreads = numThreads;
+    _maxDepth = maxDepth;
+    _policy = policy;
+    pendingTasks = 0;
+    stopping = false;
+}
+
+void SinkPool::start()
+{
+    for (unsigned i = 0; i < _numThreads; i++)
+    {
+        workers.push_back(new Worker);
+    }
+    // start after all workers exist, they steal from each other
+    for (unsigned i = 0; i < _numThreads; i++)
+    {
+        workers[i]->thread = std::thread(&SinkPool::work, this, i);
+    }
+}
+
+SinkPool::~SinkPool()
+{
+    flush();
+
+    {
+        std::lock_guard<std::mutex> guard(idleLock);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    for (auto w : workers)
+    {
+        w->thread.join();
+        delete w;
+    }
+    for (auto s : strands)
+    {
+        delete s;
+    }
+}
+
+unsigned SinkPool::numThreads() const
+{
+    return _numThreads;
+}
+
+unsigned SinkPool::maxDepth() const
+{
+    return _maxDepth;
+}
+
+SinkPool::OverflowPolicy SinkPool::policy() const
+{
+    return _policy;
+}
+
+bool SinkPool::inWorker() const
+{
+    return currentPool == this;
+}
+
+void SinkPool::feed(const QList<Sink*>& sinks, const SamplePackView& data)
+{
+    // pooled sinks share a single copy, view is only valid during this call
+    std::shared_ptr<const SamplePack> pack;
+    for (auto sink : sinks)
+    {
+        if (!sink->isThreadSafe()) continue;
+
+        if (pack == nullptr)
+        {
+            unsigned ns = data.numSamples();
+            auto copy = std::make_shared<SamplePack>(ns, data.numChannels(), data.hasX());
+            if (data.hasX())
+            {
+                data.copyX(0, ns, copy->xData());
+            }
+            for (unsigned ci = 0; ci < data.numChannels(); ci++)
+            {
+                data.copyChannel(ci, 0, ns, copy->data(ci));
+            }
+            pack = std::move(copy);
+        }
+        post(sink, pack);
+    }
+
+    for (auto sink : sinks)
+    {
+        if (!sink->isThreadSafe())
+        {
+            sink->feedIn(data);
+        }
+    }
+}
+
+void SinkPool::post(Sink* sink, std::shared_ptr<const SamplePack> pack)
+{
+    Q_ASSERT(sink->isThreadSafe());
+
+    Strand* strand;
+    bool needSchedule = false;
+    {
+        std::unique_lock<std::mutex> lock(strandsLock);
+        strand = strands.value(sink, nullptr);
+        if (strand == nullptr)
+        {
+            strand = new Strand;
+            strand->sink = sink;
+            strands.insert(sink, strand);
+        }
+        if (_maxDepth && strand->queue.size() >= _maxDepth)
+        {
+            strand->overflows++;
+            if (!makeSpace(strand, lock))
+            {
+                strand->droppedSamples += pack->numSamples();
+                return;
+            }
+        }
+        strand->queue.push_back(std::move(pack));
+        strand->peakDepth = std::max(strand->peakDepth, unsigned(strand->queue.size()));
+        if (!strand->scheduled)
+        {
+            strand->scheduled = true;
+            needSchedule = true;
+        }
+    }
+
+    // a running strand takes the new pack itself
+    if (needSchedule) schedule(strand);
+}
+
+bool SinkPool::makeSpace(Strand* strand, std::unique_lock<std::mutex>& lock)
+{
+    // a full queue is always scheduled, so it will get space
+    if (_policy == Block)
+    {
+        // workers would wait for each other
+        if (!inWorker())
+        {
+            strandSpace.wait(lock, [this, strand]() {return strand->queue.size() < _maxDepth;});
+        }
+        return true;
+    }
+
+    // front pack is in use while it's fed
+    auto oldest = strand->queue.begin();
+    if (strand->feeding) oldest++;
+    if (oldest == strand->queue.end()) return false;
+
+    strand->droppedSamples += (*oldest)->numSamples();
+    strand->queue.erase(oldest);
+    return true;
+}
+
+void SinkPool::schedule(Strand* strand)
+{
+    std::call_once(started, &SinkPool::start, this);
+
+    Worker* w = workers[nextWorker++ % workers.size()];
+    {
+        std::lock_guard<std::mutex> guard(w->lock);
+        w->tasks.push_back(strand);
+    }
+    {
+        std::lock_guard<std::mutex> guard(idleLock);
+        pendingTasks++;
+    }
+    wakeUp.notify_one();
+}
+
+SinkPool::Strand* SinkPool::take(unsigned wi)
+{
+    Strand* strand = nullptr;
+
+    // newest of own tasks first, oldest of others
+    {
+        Worker* w = workers[wi];
+        std::lock_guard<std::mutex> guard(w->lock);
+        if (!w->tasks.empty())
+        {
+            strand = w->tasks.back();
+            w->tasks.pop_back();
+        }
+    }
+    for (unsigned i = 1; strand == nullptr && i < workers.size(); i++)
+    {
+        Worker* w = workers[(wi + i) % workers.size()];
+        std::lock_guard<std::mutex> guard(w->lock);
+        if (!w->tasks.empty())
+        {
+            strand = w->tasks.front();
+            w->tasks.pop_front();
+        }
+    }
+
+    if (strand != nullptr)
+    {
+        std::lock_guard<std::mutex> guard(idleLock);
+        pendingTasks--;
+    }
+    return strand;
+}
+
+void SinkPool::run(Strand* strand)
+{
+    std::unique_lock<std::mutex> lock(strandsLock);
+    while (!strand->queue.empty())
+    {
+        // pack stays in queue while it's fed, so that it's counted in depth
+        auto pack = strand->queue.front();
+        strand->feeding = true;
+        lock.unlock();
+        strand->sink->feedIn(*pack);
+        pack.reset();
+        lock.lock();
+        strand->feeding = false;
+        strand->queue.pop_front();
+        if (_maxDepth) strandSpace.notify_all();
+    }
+    strand->scheduled = false;
+    lock.unlock();
+    strandIdle.notify_all();
+}
+
+void SinkPool::work(unsigned wi)
+{
+    currentPool = this;
+    while (true)
+    {
+        Strand* strand = take(wi);
+        if (strand != nullptr)
+        {
+            run(strand);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleLock);
+        wakeUp.wait(lock, [this]() {return pendingTasks > 0 || stopping;});
+        if (stopping && pendingTasks == 0) return;
+    }
+}
+
+void SinkPool::flush(const Sink* sink)
+{
+    std::unique_lock<std::mutex> lock(strandsLock);
+    Strand* strand = strands.value(sink, nullptr);
+    if (strand == nullptr) return;
+
+    strandIdle.wait(lock, [strand]() {return !strand->scheduled;});
+}
+
+void SinkPool::flush()
+{
+    std::unique_lock<std::mutex> lock(strandsLock);
+    strandIdle.wait(lock, [this]()
+        {
+            for (auto s : strands)
+            {
+                if (s->scheduled) return false;
+            }
+            return true;
+        });
+}
+
+void SinkPool::remove(const Sink* sink)
+{
+    std::unique_lock<std::mutex> lock(strandsLock);
+    Strand* strand = strands.value(sink, nullptr);
+    if (strand == nullptr) return;
+
+    strandIdle.wait(lock, [strand]() {return !strand->scheduled;});
+    strands.remove(sink);
+    delete strand;
+}
+
+unsigned SinkPool::queueDepth(const Sink* sink) const
+{
+    std::lock_guard<std::mutex> guard(strandsLock);
+    Strand* strand = strands.value(sink, nullptr);
+    return strand == nullptr ? 0 : strand->queue.size();
+}
+
+QList<SinkPool::SinkStats> SinkPool::stats() const
+{
+    std::lock_guard<std::mutex> guard(strandsLock);
+    QList<SinkStats> r;
+    for (auto s : strands)
+    {
+        r.append({s->sink, unsigned(s->queue.size()), s->peakDepth,
+                  s->overflows, s->droppedSamples});
+    }
+    return r;
+}
+
+void SinkPool::resetPeaks()
+{
+    std::lock_guard<std::mutex> guard(strandsLock);
+    for (auto s : strands)
+    {
+        s->peakDepth = s->queue.size();
+    }
+}
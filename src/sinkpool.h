@@ -0,0 +1,174 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SINKPOOL_H
+#define SINKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <QHash>
+#include <QList>
+
+#include "samplepack.h"
+#include "samplepackview.h"
+#include "sink.h"
+
+/**
+ * A pool of worker threads that feeds thread-safe sinks concurrently.
+ *
+ * When a pool is set for a `Source` (`Source::setSinkPool()`) or for
+ * the followers of a `Sink` (`Sink::setFollowerPool()`), incoming data
+ * is copied once into an immutable pack that is shared by all sinks
+ * that return true from `Sink::isThreadSafe()`. Each of those sinks has
+ * its own queue. Packs of a sink are fed in order and never
+ * concurrently, but different sinks run in parallel. Other sinks are
+ * fed directly on the calling thread, as usual.
+ *
+ * Every worker has a queue of sinks that have pending packs. Idle
+ * workers steal from queues of busy workers. Workers are started when
+ * the first pack is queued, an unused pool has no threads.
+ *
+ * Queue of a sink that can't keep up can be limited to `maxDepth`
+ * packs. Packs that are posted from worker threads (followers of pooled
+ * sinks) are never blocked, they may exceed the limit.
+ */
+class SinkPool
+{
+public:
+    /// What to do when a pack is posted to a full queue
+    enum OverflowPolicy
+    {
+        /// Wait until the sink takes a pack
+        Block,
+        /// Drop the oldest pack that isn't being fed. If there is no
+        /// such pack, incoming pack is dropped instead.
+        DropOldest
+    };
+
+    /// Queue depth of a sink, for diagnosis
+    struct SinkStats
+    {
+        const Sink* sink;
+        unsigned depth;         ///< packs waiting or being fed
+        unsigned peakDepth;     ///< highest `depth` since last `resetPeaks()`
+        quint64 overflows;      ///< packs posted while queue was full
+        quint64 droppedSamples; ///< samples of dropped packs, only with `DropOldest`
+    };
+
+    /**
+     * @param numThreads number of workers, 0 for one per CPU core
+     * @param maxDepth queue limit of each sink, 0 for no limit
+     * @param policy overflow policy
+     */
+    explicit SinkPool(unsigned numThreads = 0, unsigned maxDepth = 0,
+                      OverflowPolicy policy = Block);
+    /// Waits for all queued packs to be fed, then stops workers.
+    ~SinkPool();
+
+    unsigned numThreads() const;
+    unsigned maxDepth() const;
+    OverflowPolicy policy() const;
+
+    /// Feeds `data` to `sinks`. Thread-safe sinks are queued, others
+    /// are fed before returning.
+    void feed(const QList<Sink*>& sinks, const SamplePackView& data);
+
+    /// Queues `pack` to be fed to `sink` on a worker thread.
+    void post(Sink* sink, std::shared_ptr<const SamplePack> pack);
+
+    /**
+     * Waits until all packs that are queued for `sink` are fed.
+     *
+     * @note Must not be called from `feedIn` of a pooled sink.
+     */
+    void flush(const Sink* sink);
+    /// Waits until queues of all sinks are empty.
+    void flush();
+    /// Flushes `sink` and forgets about it. Must be called when sink
+    /// is disconnected.
+    void remove(const Sink* sink);
+
+    /// Returns number of packs waiting or being fed for `sink`
+    unsigned queueDepth(const Sink* sink) const;
+    /// Returns stats of all known sinks
+    QList<SinkStats> stats() const;
+    /// Resets peak depths to current depths
+    void resetPeaks();
+
+private:
+    /// Pending packs of a single sink
+    struct Strand
+    {
+        Sink* sink;
+        std::deque<std::shared_ptr<const SamplePack>> queue;
+        bool scheduled = false; ///< queued to a worker or running
+        bool feeding = false;   ///< front of `queue` is being fed
+        unsigned peakDepth = 0;
+        quint64 overflows = 0;
+        quint64 droppedSamples = 0;
+    };
+
+    struct Worker
+    {
+        std::thread thread;
+        std::mutex lock;        ///< guards `tasks`
+        std::deque<Strand*> tasks;
+    };
+
+    unsigned _numThreads;
+    unsigned _maxDepth;
+    OverflowPolicy _policy;
+    std::once_flag started;
+    std::vector<Worker*> workers;
+    std::atomic<unsigned> nextWorker;
+
+    /// guards all strands and their queues
+    mutable std::mutex strandsLock;
+    std::condition_variable strandIdle;
+    std::condition_variable strandSpace; ///< a pack is taken from a queue
+    QHash<const Sink*, Strand*> strands;
+
+    std::mutex idleLock;        ///< guards `pendingTasks` and `stopping`
+    std::condition_variable wakeUp;
+    unsigned pendingTasks;      ///< strands in worker queues, not taken yet
+    bool stopping;
+
+    /// Starts worker threads
+    void start();
+    /// Puts strand in a worker queue
+    void schedule(Strand* strand);
+    /// Takes a strand from queue of worker `wi`, or steals one from others.
+    Strand* take(unsigned wi);
+    /// Feeds pending packs of strand until its queue is empty
+    void run(Strand* strand);
+    /// Worker thread loop
+    void work(unsigned wi);
+    /// Makes space for one pack in a full queue, or waits for it.
+    /// Returns false if incoming pack should be dropped.
+    bool makeSpace(Strand* strand, std::unique_lock<std::mutex>& lock);
+    /// Returns true if called from a worker of this pool
+    bool inWorker() const;
+};
+
+#endif // SINKPOOL_H
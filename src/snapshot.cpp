@@ -18,6 +18,7 @@
 */
 
 #include <stddef.h>
+#include <algorithm>
 #include <QSaveFile>
 #include <QTextStream>
 
@@ -49,6 +50,10 @@ Snapshot::~Snapshot()
     {
         delete view;
     }
+
+    // buffers may be sharing data with stream, they must be released
+    qDeleteAll(xData);
+    qDeleteAll(yData);
 }
 
 QAction* Snapshot::showAction()
@@ -149,15 +154,26 @@ void Snapshot::save(QString fileName)
         }
         fileStream << '\n';
 
-        // print rows
-        for (unsigned int i = 0; i < numSamples(); i++)
+        // print rows, data is read in chunks of rows
+        const unsigned CHUNK_SIZE = 1024;
+        QVector<double> chunk(numChannels() * CHUNK_SIZE);
+        for (unsigned int start = 0; start < numSamples(); start += CHUNK_SIZE)
         {
+            unsigned n = std::min(CHUNK_SIZE, numSamples() - start);
             for (unsigned int ci = 0; ci < numChannels(); ci++)
             {
-                fileStream << yData[ci]->sample(i);
-                if (ci != numChannels()-1) fileStream << ",";
+                yData[ci]->copySamples(start, n, &chunk[ci * CHUNK_SIZE]);
+            }
+
+            for (unsigned int i = 0; i < n; i++)
+            {
+                for (unsigned int ci = 0; ci < numChannels(); ci++)
+                {
+                    fileStream << chunk[ci * CHUNK_SIZE + i];
+                    if (ci != numChannels()-1) fileStream << ",";
+                }
+                fileStream << '\n';
             }
-            fileStream << '\n';
         }
 
         if (!file.commit())
@@ -27,7 +27,7 @@
 #include <QStringList>
 
 #include "channelinfomodel.h"
-#include "readonlybuffer.h"
+#include "framebuffer.h"
 #include "indexbuffer.h"
 
 class SnapshotView;
@@ -43,7 +43,7 @@ public:
 
     // TODO: yData and xData of snapshot shouldn't be public, preferable should be handled in constructor
     QVector<IndexBuffer*> xData;
-    QVector<ReadOnlyBuffer*> yData;
+    QVector<FrameBuffer*> yData;
     QAction* showAction();
     QAction* deleteAction();
 
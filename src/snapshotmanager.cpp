@@ -30,6 +30,7 @@
 
 #include "mainwindow.h"
 #include "snapshotmanager.h"
+#include "compressedbuffer.h"
 
 SnapshotManager::SnapshotManager(MainWindow* mainWindow,
                                  Stream* stream) :
@@ -69,10 +70,11 @@ Snapshot* SnapshotManager::makeSnapshot() const
     QString name = QTime::currentTime().toString("'Snapshot ['HH:mm:ss']'");
     auto snapshot = new Snapshot(_mainWindow, name, *(_stream->infoModel()));
 
+    // data is shared with stream until it's overwritten
+    snapshot->yData = _stream->snapshot();
     for (unsigned ci = 0; ci < _stream->numChannels(); ci++)
     {
         snapshot->xData.append(new IndexBuffer(_stream->numSamples()));
-        snapshot->yData.append(new ReadOnlyBuffer(_stream->channel(ci)->yData()));
     }
 
     return snapshot;
@@ -204,7 +206,7 @@ void SnapshotManager::loadSnapshotFromFile(QString fileName)
     for (unsigned ci = 0; ci < numOfChannels; ci++)
     {
         snapshot->xData.append(new IndexBuffer(data[ci].size()));
-        snapshot->yData.append(new ReadOnlyBuffer(data[ci].data(), data[ci].size()));
+        snapshot->yData.append(new CompressedBuffer(data[ci].data(), data[ci].size()));
     }
 
     addSnapshot(snapshot, false);
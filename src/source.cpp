@@ -20,11 +20,13 @@
 #include <QtGlobal>
 
 #include "source.h"
+#include "sinkpool.h"
 
 Source::~Source()
 {
     for (auto sink : sinks)
     {
+        if (pool != nullptr) pool->remove(sink);
         sink->setSource(nullptr);
     }
 }
@@ -49,6 +51,7 @@ void Source::disconnect(Sink* sink)
     Q_ASSERT(sinks.contains(sink));
     Q_ASSERT(sink->connectedSource() == this);
 
+    if (pool != nullptr) pool->remove(sink);
     sink->setSource(nullptr);
     sinks.removeOne(sink);
 }
@@ -58,12 +61,31 @@ void Source::disconnectSinks()
     while (!sinks.isEmpty())
     {
         auto sink = sinks.takeFirst();
+        if (pool != nullptr) pool->remove(sink);
         sink->setSource(nullptr);
     }
 }
 
-void Source::feedOut(const SamplePack& data) const
+void Source::setSinkPool(SinkPool* p)
 {
+    if (pool != nullptr)
+    {
+        for (auto sink : sinks)
+        {
+            pool->remove(sink);
+        }
+    }
+    pool = p;
+}
+
+void Source::feedOut(const SamplePackView& data) const
+{
+    if (pool != nullptr)
+    {
+        pool->feed(sinks, data);
+        return;
+    }
+
     for (auto sink : sinks)
     {
         sink->feedIn(data);
@@ -74,6 +96,8 @@ void Source::updateNumChannels() const
 {
     for (auto sink : sinks)
     {
+        // pending data is in old layout
+        if (pool != nullptr) pool->flush(sink);
         sink->setNumChannels(numChannels(), hasX());
     }
 }
@@ -81,6 +105,7 @@ void Source::updateNumOmitByte() const
 {
     for (auto sink : sinks)
     {
+        if (pool != nullptr) pool->flush(sink);
         sink->setNumChannels(numChannels(), hasX());
     }
 }
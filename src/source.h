@@ -23,7 +23,8 @@
 #include <QList>
 
 #include "sink.h"
-#include "samplepack.h"
+#include "samplepackview.h"
+#include "numberformat.h"
 
 class Source
 {
@@ -37,6 +38,10 @@ public:
     /// Returns number of channels
     virtual unsigned numChannels() const = 0;
 
+    /// Returns the format that samples are originally in. Sinks may use
+    /// this to select a compact storage. Default is `NumberFormat_double`.
+    virtual NumberFormat numberFormat() const { return NumberFormat_double; };
+
     /// Connects a sink to this source.
     ///
     /// If `Sink` is already connected to a source, it's disconnected first.
@@ -49,16 +54,21 @@ public:
     /// Disconnects all connected sinks.
     void disconnectSinks();
 
+    /// Feeds thread-safe sinks on given pool. `nullptr` (default)
+    /// feeds all sinks on the calling thread.
+    void setSinkPool(SinkPool* pool);
+
 protected:
     /// Feeds "in" given data to connected sinks
-    virtual void feedOut(const SamplePack& data) const;
+    virtual void feedOut(const SamplePackView& data) const;
 
     /// Updates "number of channels" of connected sinks. Must be
-    /// called when num. channels or hasX changes.
+    /// called when num. channels, hasX or number format changes.
     void updateNumChannels() const;
     void updateNumOmitByte() const;
 private:
     QList<Sink*> sinks;
+    SinkPool* pool = nullptr;
 };
 
 #endif // SOURCE_H
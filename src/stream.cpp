@@ -17,10 +17,16 @@
   along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+
 #include "stream.h"
-#include "ringbuffer.h"
+#include "multiringbuffer.h"
 #include "indexbuffer.h"
 #include "linindexbuffer.h"
+#include "xringbuffer.h"
+#include "historyfile.h"
+#include "tieredhistory.h"
+#include "gainoffset.h"
 
 Stream::Stream(unsigned nc, bool x, unsigned ns) :
     _infoModel(nc)
@@ -32,24 +38,39 @@ Stream::Stream(unsigned nc, bool x, unsigned ns) :
     xMin = 0;
     xMax = 1;
 
+    historyMode = HistoryMode_Off;
+    _history = nullptr;
+    historyX = nullptr;
+
+    _storageFormat = NumberFormat_double;
+    isEmpty = true;
+    _sequence = 0;
+    validFrom = 0;
+    connect(&_infoModel, &QAbstractItemModel::dataChanged,
+            [this]()
+            {
+                updateGainOffsetPlan();
+                updateStorageFormat();
+            });
+    connect(&_infoModel, &QAbstractItemModel::modelReset,
+            [this]()
+            {
+                updateGainOffsetPlan();
+                updateStorageFormat();
+            });
+
     // create xdata buffer
     _hasx = x;
-    if (x)
-    {
-        // TODO: implement XRingBuffer (binary search)
-        Q_ASSERT(false);
-    }
-    else
-    {
-        xData = makeXBuffer();
-    }
+    xData = makeXBuffer();
 
     // create channels
+    yData = makeYBuffer(nc);
     for (unsigned i = 0; i < nc; i++)
     {
-        auto c = new StreamChannel(i, xData, new RingBuffer(ns), &_infoModel);
+        auto c = new StreamChannel(i, xData, yData->makeChannel(i), &_infoModel);
         channels.append(c);
     }
+    updateGainOffsetPlan();
 }
 
 Stream::~Stream()
@@ -58,6 +79,9 @@ Stream::~Stream()
     {
         delete ch;
     }
+    delete _history;
+    delete historyX;
+    delete yData;
     delete xData;
 }
 
@@ -107,61 +131,101 @@ ChannelInfoModel* Stream::infoModel()
     return const_cast<ChannelInfoModel*>(static_cast<const Stream&>(*this).infoModel());
 }
 
+const History* Stream::history() const
+{
+    return _history;
+}
+
+QVector<FrameBuffer*> Stream::snapshot()
+{
+    // buffers keep the last samples at full resolution even while
+    // recording history, which may have averaged them
+    return yData->snapshot();
+}
+
+quint64 Stream::sequence() const
+{
+    return _sequence;
+}
+
+quint64 Stream::firstAvailable() const
+{
+    quint64 bufferStart = _sequence > _numSamples ? _sequence - _numSamples : 0;
+    return std::max(validFrom, bufferStart);
+}
+
+bool Stream::readSamples(unsigned ci, quint64 first, quint64 last, double* out) const
+{
+    Q_ASSERT(ci < numChannels() && first <= last);
+
+    if (first < firstAvailable() || last > _sequence) return false;
+
+    // last sample of buffer is `_sequence - 1`
+    unsigned start = _numSamples - (_sequence - first);
+    yData->copySamples(ci, start, last - first, out);
+    return true;
+}
+
 void Stream::setNumChannels(unsigned nc, bool x)
 {
+    // source also notifies number format changes via this call
+    updateStorageFormat();
+
     unsigned oldNum = numChannels();
     if (oldNum == nc && x == _hasx) return;
 
+    // a new history is started for the new channels
+    if (_history != nullptr) closeHistory();
+
+    // change the xdata, done before adding channels so that new
+    // channels are created with new xdata
+    if (x != _hasx)
+    {
+        _hasx = x;
+        replaceXBuffer(makeXBuffer());
+    }
+
     // adjust the number of channels
     if (nc > oldNum)
     {
+        yData->setNumChannels(nc);
         for (unsigned i = oldNum; i < nc; i++)
         {
-            auto c = new StreamChannel(i, xData, new RingBuffer(_numSamples), &_infoModel);
+            auto c = new StreamChannel(i, xData, yData->makeChannel(i), &_infoModel);
             channels.append(c);
         }
     }
     else if (nc < oldNum)
     {
+        // views must be deleted before their storage is removed
         for (unsigned i = oldNum-1; i > nc-1; i--)
         {
             delete channels.takeLast();
         }
-    }
-
-    // change the xdata
-    if (x != _hasx)
-    {
-        if (x)
-        {
-            // TODO: implement XRingBuffer (binary search)
-            Q_ASSERT(false);
-        }
-        else
-        {
-            xData = makeXBuffer();
-        }
-
-        for (auto c : channels)
-        {
-            c->setX(xData);
-        }
-        _hasx = x;
+        yData->setNumChannels(nc);
     }
 
     if (nc != oldNum)
     {
+        // new channels don't have old samples
+        validFrom = _sequence;
         _infoModel.setNumOfChannels(nc);
-        // TODO: how about X change?
+        updateGainOffsetPlan();
         emit numChannelsChanged(nc);
     }
 
+    openHistory();
+
     Sink::setNumChannels(nc, x);
 }
 
 XFrameBuffer* Stream::makeXBuffer() const
 {
-    if (xAsIndex)
+    if (_hasx)
+    {
+        return new XRingBuffer(_numSamples);
+    }
+    else if (xAsIndex)
     {
         return new IndexBuffer(_numSamples);
     }
@@ -171,76 +235,237 @@ XFrameBuffer* Stream::makeXBuffer() const
     }
 }
 
-const SamplePack* Stream::applyGainOffset(const SamplePack& pack) const
+MultiRingBuffer* Stream::makeYBuffer(unsigned nc) const
+{
+    switch (_storageFormat)
+    {
+        case NumberFormat_uint8:
+            return new MultiRingBufferT<quint8>(nc, _numSamples);
+        case NumberFormat_uint16:
+            return new MultiRingBufferT<quint16>(nc, _numSamples);
+        case NumberFormat_uint32:
+            return new MultiRingBufferT<quint32>(nc, _numSamples);
+        case NumberFormat_int8:
+            return new MultiRingBufferT<qint8>(nc, _numSamples);
+        case NumberFormat_int16:
+            return new MultiRingBufferT<qint16>(nc, _numSamples);
+        case NumberFormat_int32:
+            return new MultiRingBufferT<qint32>(nc, _numSamples);
+        case NumberFormat_float:
+            return new MultiRingBufferT<float>(nc, _numSamples);
+        default:
+            return new MultiRingBufferT<double>(nc, _numSamples);
+    }
+}
+
+NumberFormat Stream::storageFormat() const
 {
-    Q_ASSERT(infoModel()->gainOrOffsetEn());
+    return _storageFormat;
+}
 
-    SamplePack* mPack = new SamplePack(pack);
-    unsigned ns = pack.numSamples();
+NumberFormat Stream::idealStorageFormat() const
+{
+    auto source = connectedSource();
+    if (_infoModel.gainOrOffsetEn() || source == nullptr)
+    {
+        return NumberFormat_double;
+    }
 
-    for (unsigned ci = 0; ci < numChannels(); ci++)
+    auto format = source->numberFormat();
+    return format == NumberFormat_INVALID ? NumberFormat_double : format;
+}
+
+/// Copies all data of `from` to `to` in chunks
+template <typename T>
+static void copyChunks(const MultiRingBuffer* from, T* to)
+{
+    const unsigned CHUNK_SIZE = 1024;
+    unsigned nc = from->numChannels();
+    unsigned ns = from->size();
+    for (unsigned i = 0; i < ns; i += CHUNK_SIZE)
     {
-        // TODO: we could use some kind of map (int32, int64 would suffice) to speed things up
-        bool gainEn = infoModel()->gainEn(ci);
-        bool offsetEn = infoModel()->offsetEn(ci);
-        if (gainEn || offsetEn)
+        SamplePack chunk(std::min(CHUNK_SIZE, ns - i), nc);
+        for (unsigned ci = 0; ci < nc; ci++)
         {
-            double* mdata = mPack->data(ci);
+            from->copySamples(ci, i, chunk.numSamples(), chunk.data(ci));
+        }
+        to->addSamples(chunk);
+    }
+}
 
-            double gain = infoModel()->gain(ci);
-            double offset = infoModel()->offset(ci);
+/// Returns true if all values of `from` type can be represented by `to` type
+static bool canRepresent(NumberFormat to, NumberFormat from)
+{
+    if (to == from || to == NumberFormat_double) return true;
+    if (from == NumberFormat_float || from == NumberFormat_double) return false;
 
-            if (gainEn)
-            {
-                for (unsigned i = 0; i < ns; i++)
-                {
-                    mdata[i] *= gain;
-                }
-            }
-            if (offsetEn)
-            {
-                for (unsigned i = 0; i < ns; i++)
-                {
-                    mdata[i] += offset;
-                }
-            }
+    // `from` is an integer type
+    bool fromSigned = from >= NumberFormat_int8;
+    unsigned fromBits = 8 << (fromSigned ? from - NumberFormat_int8 : from);
+
+    if (to == NumberFormat_float) return fromBits <= 16;
+
+    bool toSigned = to >= NumberFormat_int8;
+    unsigned toBits = 8 << (toSigned ? to - NumberFormat_int8 : to);
+
+    if (toSigned)
+    {
+        return fromSigned ? fromBits <= toBits : fromBits < toBits;
+    }
+    else
+    {
+        return !fromSigned && fromBits <= toBits;
+    }
+}
+
+/// Returns the most compact format that can represent all values of both types
+static NumberFormat commonFormat(NumberFormat a, NumberFormat b)
+{
+    if (canRepresent(a, b)) return a;
+    if (canRepresent(b, a)) return b;
+
+    const NumberFormat candidates[] = {NumberFormat_int16, NumberFormat_int32,
+                                       NumberFormat_float, NumberFormat_double};
+    for (auto c : candidates)
+    {
+        if (canRepresent(c, a) && canRepresent(c, b)) return c;
+    }
+    return NumberFormat_double;
+}
+
+void Stream::updateStorageFormat(bool clearing)
+{
+    auto format = idealStorageFormat();
+    if (format == _storageFormat) return;
+    clearing = clearing || isEmpty;
+    if (!clearing)
+    {
+        // narrowing is postponed until clear, existing samples are kept
+        if (canRepresent(_storageFormat, format)) return;
+        // new samples shouldn't be truncated either
+        format = commonFormat(format, _storageFormat);
+    }
+
+    _storageFormat = format;
+
+    unsigned nc = numChannels();
+    auto newYData = makeYBuffer(nc);
+
+    if (!clearing) copyChunks(yData, newYData);
+
+    // while recording history channels don't refer to buffers
+    if (_history != nullptr)
+    {
+        delete yData;
+        yData = newYData;
+        return;
+    }
+
+    QVector<FrameBuffer*> oldViews;
+    for (unsigned ci = 0; ci < nc; ci++)
+    {
+        oldViews.append(channels[ci]->setY(newYData->makeChannel(ci)));
+    }
+
+    // users should stop referring old buffers before they are deleted
+    emit yDataChanged();
+    for (auto view : oldViews)
+    {
+        delete view;
+    }
+    delete yData;
+    yData = newYData;
+}
+
+SamplePack& Stream::copyToScratch(const SamplePackView& pack, bool withGainOffset)
+{
+    unsigned ns = pack.numSamples();
+    if (scratchPack.numSamples() != ns ||
+        scratchPack.numChannels() != pack.numChannels() ||
+        scratchPack.hasX() != pack.hasX())
+    {
+        scratchPack = SamplePack(ns, pack.numChannels(), pack.hasX());
+    }
+
+    if (pack.hasX())
+    {
+        pack.copyX(0, ns, scratchPack.xData());
+    }
+    for (unsigned ci = 0; ci < pack.numChannels(); ci++)
+    {
+        double* dst = scratchPack.data(ci);
+        const ChannelGainOffset& go = gainOffsetPlan[ci];
+        if (!withGainOffset || !go.enabled)
+        {
+            pack.copyChannel(ci, 0, ns, dst);
+        }
+        else if (pack.isPlanar())
+        {
+            // copied and modified in a single pass
+            gainOffset(pack.data(ci), ns, go.gain, go.offset, dst);
+        }
+        else
+        {
+            pack.copyChannel(ci, 0, ns, dst);
+            gainOffset(dst, ns, go.gain, go.offset, dst);
         }
     }
+    return scratchPack;
+}
 
-    return mPack;
+void Stream::updateGainOffsetPlan()
+{
+    unsigned nc = numChannels();
+    gainOffsetPlan.resize(nc);
+    gainOffsetEn = false;
+    for (unsigned ci = 0; ci < nc; ci++)
+    {
+        bool gainEn = _infoModel.gainEn(ci);
+        bool offsetEn = _infoModel.offsetEn(ci);
+        gainOffsetPlan[ci] = {gainEn || offsetEn,
+                              gainEn ? _infoModel.gain(ci) : 1.,
+                              offsetEn ? _infoModel.offset(ci) : 0.};
+        gainOffsetEn |= gainOffsetPlan[ci].enabled;
+    }
 }
 
-void Stream::feedIn(const SamplePack& pack)
+void Stream::feedIn(const SamplePackView& pack)
 {
     Q_ASSERT(pack.numChannels() == numChannels() &&
              pack.hasX() == hasX());
 
     if (_paused) return;
 
+    // buffers need contiguous channels; gain and offset is applied
+    // while copying to planar scratch, other layouts are only converted
+    bool gainOrOffset = gainOffsetEn;
+    SamplePackView mPack = pack;
+    if (gainOrOffset || !pack.isPlanar())
+    {
+        mPack = copyToScratch(pack, gainOrOffset);
+    }
+
     unsigned ns = pack.numSamples();
     if (_hasx)
     {
-        // TODO: implement XRingBuffer (binary search)
-        Q_ASSERT(false);
-        // static_cast<RingBuffer*>(xData)->addSamples(pack.xData(), ns);
+        static_cast<XRingBuffer*>(xData)->addSamples(mPack.xData(), ns);
     }
 
-    // modified pack that gain and offset is applied to
-    const SamplePack* mPack = nullptr;
-    if (infoModel()->gainOrOffsetEn())
-        mPack = applyGainOffset(pack);
-
-    for (unsigned ci = 0; ci < numChannels(); ci++)
+    yData->addSamples(mPack);
+    if (_history != nullptr)
     {
-        auto buf = static_cast<RingBuffer*>(channels[ci]->yData());
-        double* data = (mPack == nullptr) ? pack.data(ci) : mPack->data(ci);
-        buf->addSamples(data, ns);
+        _history->addSamples(mPack);
+        historyX->resize(_history->numRows());
     }
 
-    Sink::feedIn((mPack == nullptr) ? pack : *mPack);
+    isEmpty = false;
+    // followers get data in its original layout unless it's modified
+    Sink::feedIn(gainOrOffset ? mPack : pack);
 
-    if (mPack != nullptr) delete mPack;
+    quint64 first = _sequence;
+    _sequence += ns;
     emit dataAdded();
+    emit samplesAdded(first, _sequence);
 }
 
 void Stream::pause(bool paused)
@@ -250,21 +475,36 @@ void Stream::pause(bool paused)
 
 void Stream::clear()
 {
-    for (auto c : channels)
+    if (_history != nullptr) closeHistory();
+
+    // postponed storage format changes are applied here
+    updateStorageFormat(true);
+    isEmpty = true;
+
+    if (_hasx)
     {
-        static_cast<RingBuffer*>(c->yData())->clear();
+        static_cast<XRingBuffer*>(xData)->clear();
     }
+    yData->clear();
+    validFrom = _sequence;
+
+    openHistory();
 }
 
 void Stream::setNumSamples(unsigned value)
 {
     if (value == _numSamples) return;
+    // samples before the old buffer range are not kept when growing
+    validFrom = std::max(validFrom, firstAvailable());
     _numSamples = value;
 
     xData->resize(value);
-    for (auto c : channels)
+    yData->resize(value);
+
+    // tiered history keeps the samples that are shown at full resolution
+    if (_history != nullptr && historyMode == HistoryMode_Tiered)
     {
-        static_cast<RingBuffer*>(c->yData())->resize(value);
+        static_cast<TieredHistory*>(_history)->setRecentSize(value);
     }
 }
 
@@ -278,12 +518,25 @@ void Stream::setXAxis(bool asIndex, double min, double max)
     // TODO: assert (UI options for x axis should be disabled)
     if (!hasX())
     {
-        xData = makeXBuffer();
+        replaceXBuffer(makeXBuffer());
+    }
+}
+
+void Stream::replaceXBuffer(XFrameBuffer* newX)
+{
+    XFrameBuffer* oldX = xData;
+    xData = newX;
+    // while recording history channels don't refer to X buffer
+    if (_history == nullptr)
+    {
         for (auto c : channels)
         {
             c->setX(xData);
         }
+        // users should stop referring old buffer before it's deleted
+        emit xDataChanged();
     }
+    delete oldX;
 }
 
 void Stream::saveSettings(QSettings* settings) const
@@ -295,3 +548,83 @@ void Stream::loadSettings(QSettings* settings)
 {
     _infoModel.loadSettings(settings);
 }
+
+void Stream::setHistoryMode(HistoryMode mode)
+{
+    if (mode == historyMode) return;
+    historyMode = mode;
+
+    if (_history != nullptr) closeHistory();
+    openHistory();
+}
+
+History* Stream::makeHistory() const
+{
+    if (historyMode == HistoryMode_Tiered)
+    {
+        return new TieredHistory(numChannels(), _numSamples);
+    }
+
+    auto file = new HistoryFile(numChannels());
+    if (!file->isOpen())
+    {
+        delete file;
+        return nullptr;
+    }
+    return file;
+}
+
+void Stream::openHistory()
+{
+    if (historyMode == HistoryMode_Off || _hasx || _history != nullptr) return;
+
+    auto history = makeHistory();
+    if (history == nullptr) return;
+
+    // continue from the data that is already shown
+    copyChunks(yData, history);
+
+    _history = history;
+    historyX = new IndexBuffer(history->numRows());
+
+    QVector<FrameBuffer*> oldViews;
+    for (auto c : channels)
+    {
+        oldViews.append(c->setY(history->makeChannel(c->index())));
+        c->setX(historyX);
+    }
+
+    // users should stop referring old buffers before they are deleted
+    emit xDataChanged();
+    emit yDataChanged();
+    emit historyChanged(true);
+    for (auto view : oldViews)
+    {
+        delete view;
+    }
+}
+
+void Stream::closeHistory()
+{
+    Q_ASSERT(_history != nullptr);
+
+    QVector<FrameBuffer*> oldViews;
+    for (auto c : channels)
+    {
+        oldViews.append(c->setY(yData->makeChannel(c->index())));
+        c->setX(xData);
+    }
+
+    // users should stop referring history before it's deleted
+    emit xDataChanged();
+    emit yDataChanged();
+    emit historyChanged(false);
+    for (auto view : oldViews)
+    {
+        delete view;
+    }
+    delete historyX;
+    delete _history;
+    historyX = nullptr;
+    _history = nullptr;
+}
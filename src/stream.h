@@ -30,6 +30,10 @@
 #include "channelinfomodel.h"
 #include "streamchannel.h"
 #include "framebuffer.h"
+#include "multiringbuffer.h"
+#include "history.h"
+#include "indexbuffer.h"
+#include "numberformat.h"
 
 /**
  * Main waveform storage class. It consists of channels. Channels are
@@ -55,11 +59,43 @@ public:
     unsigned numChannels() const;
 
     unsigned numSamples() const;
+    /// Returns the type that samples are stored as
+    NumberFormat storageFormat() const;
     const StreamChannel* channel(unsigned index) const;
     StreamChannel* channel(unsigned index);
     QVector<const StreamChannel*> allChannels() const;
     const ChannelInfoModel* infoModel() const;
     ChannelInfoModel* infoModel();
+    /// Returns the history of session if it's being recorded, otherwise
+    /// `nullptr`. See `setHistoryMode()`.
+    const History* history() const;
+    /**
+     * Returns views of the last `numSamples()` samples of all channels that
+     * keep their data when stream is modified later. Data is shared with
+     * stream until it's overwritten (see `MultiRingBuffer::snapshot()`).
+     * Samples are never averaged, even while recording a `TieredHistory`.
+     * Caller takes ownership.
+     */
+    QVector<FrameBuffer*> snapshot();
+
+    /**
+     * Returns the sequence number of next sample, which is also the total
+     * number of samples added since creation. Unlike sample indexes it
+     * doesn't shift as data is added and it never decreases, not even when
+     * stream is cleared. See `samplesAdded()`.
+     */
+    quint64 sequence() const;
+    /// Returns sequence number of the oldest sample that can still be read
+    /// with `readSamples()`.
+    quint64 firstAvailable() const;
+    /**
+     * Copies samples of channel `ci` with sequence numbers in range
+     * [first, last) to `out`.
+     *
+     * @return `false` (nothing is copied) if range isn't available (already
+     * overwritten, cleared or not added yet)
+     */
+    bool readSamples(unsigned ci, quint64 first, quint64 last, double* out) const;
 
     /// Saves channel information
     void saveSettings(QSettings* settings) const;
@@ -69,7 +105,7 @@ public:
 protected:
     // implementations for `Sink`
     virtual void setNumChannels(unsigned nc, bool x);
-    virtual void feedIn(const SamplePack& pack);
+    virtual void feedIn(const SamplePackView& pack);
 
 signals:
     void numChannelsChanged(unsigned value);
@@ -77,6 +113,18 @@ signals:
     void channelAdded(const StreamChannel* chan);
     void channelNameChanged(unsigned channel, QString name); // TODO: does it stay?
     void dataAdded(); ///< emitted when data added to channel man.
+    /// Emitted with `dataAdded()`, new samples have sequence numbers in
+    /// range [first, last). See `sequence()`.
+    void samplesAdded(quint64 first, quint64 last);
+    /// Emitted when X buffer of channels is replaced. Previous X buffer
+    /// is deleted right after this signal.
+    void xDataChanged();
+    /// Emitted when data buffers of channels are replaced (ex: storage
+    /// format change). Previous buffers are deleted right after this signal.
+    void yDataChanged();
+    /// Emitted when history recording starts or stops. Channel buffers
+    /// are already replaced (`xDataChanged` and `yDataChanged` are emitted).
+    void historyChanged(bool recording);
 
 public slots:
     /// Change number of samples (buffer size)
@@ -92,12 +140,43 @@ public slots:
     /// Clears buffer data (fills with 0)
     void clear();
 
+    /**
+     * Enables recording of all incoming data to a `History`. With
+     * `HistoryMode_File` all samples are kept in a `HistoryFile`, with
+     * `HistoryMode_Tiered` memory use is bounded by a `TieredHistory`
+     * that keeps last `numSamples()` at full resolution.
+     *
+     * While recording, channels are views of the whole history instead
+     * of the last `numSamples()` samples and X is the sample index. A
+     * new history is started when number of channels changes or
+     * stream is cleared. History isn't recorded when source provides X.
+     */
+    void setHistoryMode(HistoryMode mode);
+
 private:
     unsigned _numSamples;
     bool _paused;
 
     bool _hasx;
+    NumberFormat _storageFormat;
+    bool isEmpty;       ///< no data is added since creation or last clear
+    SamplePack scratchPack;     ///< planar copy of incoming data when needed
+
+    /// Gain and offset of a channel, compiled from channel infos
+    struct ChannelGainOffset
+    {
+        bool enabled;
+        double gain;            ///< 1 if gain is disabled
+        double offset;          ///< 0 if offset is disabled
+    };
+    QVector<ChannelGainOffset> gainOffsetPlan;
+    bool gainOffsetEn;          ///< gain or offset is enabled for any channel
+    quint64 _sequence;  ///< sequence number of next sample
+    /// Samples before this are not available, even if they are in range of
+    /// buffer (ex: cleared)
+    quint64 validFrom;
     XFrameBuffer* xData;
+    MultiRingBuffer* yData;     ///< storage of all channels
     QList<StreamChannel*> channels;
 
     ChannelInfoModel _infoModel;
@@ -105,21 +184,55 @@ private:
     bool xAsIndex;
     double xMin, xMax;
 
+    HistoryMode historyMode;
+    History* _history;          ///< `nullptr` when not recording
+    IndexBuffer* historyX;      ///< X of channels while recording
+
     /**
-     * Applies gain and offset to given pack.
-     *
-     * Caller is responsible for deleting returned `SamplePack`.
+     * Copies given pack to `scratchPack`, which is re-used while pack
+     * size doesn't change.
      *
-     * @note Should be called only when gain or offset is enabled. Guard with
-     * `ChannelInfoModel::gainOrOffsetEn()`.
-     *
-     * @param pack input data
-     * @return modified data
+     * @param pack input data, any layout
+     * @param withGainOffset apply `gainOffsetPlan` while copying
+     * @return `scratchPack`, valid until next call
      */
-    const SamplePack* applyGainOffset(const SamplePack& pack) const;
+    SamplePack& copyToScratch(const SamplePackView& pack, bool withGainOffset = false);
+
+    /// Rebuilds `gainOffsetPlan` from channel infos
+    void updateGainOffsetPlan();
 
-    /// Returns a new virtual X buffer for settings
+    /// Returns a new X buffer; a data buffer if stream has X, otherwise a
+    /// virtual buffer for settings
     XFrameBuffer* makeXBuffer() const;
+    /// Sets `newX` as X buffer of all channels and deletes the old one
+    void replaceXBuffer(XFrameBuffer* newX);
+
+    /// Returns a new data buffer for `nc` channels of `storageFormat` type
+    MultiRingBuffer* makeYBuffer(unsigned nc) const;
+    /**
+     * Storage type should be as compact as possible while being able
+     * to represent all incoming samples. It's selected from the number
+     * format of connected source. If gain or offset is enabled samples
+     * are stored as `double`.
+     */
+    NumberFormat idealStorageFormat() const;
+    /**
+     * Replaces data buffers if storage format should change. Existing
+     * data is converted to new format. Changes that would cause data
+     * loss (narrowing) are postponed until buffers are cleared, unless
+     * they are empty.
+     *
+     * @param clearing buffers are being cleared, data isn't kept
+     */
+    void updateStorageFormat(bool clearing = false);
+
+    /// Returns a new history for `historyMode`, `nullptr` on failure.
+    History* makeHistory() const;
+    /// Starts recording a new history if enabled. History starts with
+    /// the data in buffers.
+    void openHistory();
+    /// Stops recording and switches channels back to buffers.
+    void closeHistory();
 };
 
 
@@ -44,6 +44,13 @@ FrameBuffer* StreamChannel::yData() {return _y;}
 const ChannelInfoModel* StreamChannel::info() const {return _info;}
 void StreamChannel::setX(const XFrameBuffer* x) {_x = x;};
 
+FrameBuffer* StreamChannel::setY(FrameBuffer* y)
+{
+    FrameBuffer* old = _y;
+    _y = y;
+    return old;
+}
+
 double StreamChannel::findValue(double x) const
 {
     int index = _x->findIndex(x);
@@ -61,6 +68,8 @@ double StreamChannel::findValue(double x) const
             // calculate middle of the line
             double prev_x = _x->sample(index);
             double next_x = _x->sample(index+1);
+            // X data from source may contain repeating values
+            if (next_x == prev_x) return _y->sample(index);
             double ratio = (x - prev_x) / (next_x - prev_x);
             double prev_y = _y->sample(index);
             double next_y = _y->sample(index+1);
@@ -49,6 +49,9 @@ public:
     const FrameBuffer* yData() const;
     const ChannelInfoModel* info() const;
     void setX(const XFrameBuffer* x);
+    /// Replaces the data buffer, takes ownership of `y`. Previous
+    /// buffer is returned and should be deleted by the caller.
+    FrameBuffer* setY(FrameBuffer* y);
 
     /**
      * Returns sample value for `x`.
@@ -0,0 +1,100 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+
+#include "sweepbuffer.h"
+#include "minmax.h"
+
+SweepBuffer::SweepBuffer(const FrameBuffer* buffer)
+{
+    Q_ASSERT(buffer != nullptr);
+
+    _buffer = buffer;
+    _phase = 0;
+}
+
+void SweepBuffer::setPhase(unsigned phase)
+{
+    _phase = phase;
+}
+
+unsigned SweepBuffer::phase() const
+{
+    unsigned n = _buffer->size();
+    return n ? _phase % n : 0;
+}
+
+unsigned SweepBuffer::sourceIndex(unsigned i) const
+{
+    // underlying buffer may be resized after `setPhase()`
+    unsigned n = _buffer->size();
+    unsigned p = phase();
+    return (i >= p) ? i - p : i + n - p;
+}
+
+unsigned SweepBuffer::size() const
+{
+    return _buffer->size();
+}
+
+double SweepBuffer::sample(unsigned i) const
+{
+    return _buffer->sample(sourceIndex(i));
+}
+
+Range SweepBuffer::limits() const
+{
+    return _buffer->limits();
+}
+
+Range SweepBuffer::rangeLimits(unsigned start, unsigned n) const
+{
+    Q_ASSERT(n > 0 && start + n <= size());
+
+    // range is at most 2 contiguous segments of the underlying buffer
+    unsigned p = phase();
+    if (start >= p || start + n <= p)
+    {
+        return _buffer->rangeLimits(sourceIndex(start), n);
+    }
+
+    unsigned n1 = p - start;
+    Range r1 = _buffer->rangeLimits(sourceIndex(start), n1);
+    Range r2 = _buffer->rangeLimits(0, n - n1);
+    return combineLimits(r1, r2);
+}
+
+void SweepBuffer::copySamples(unsigned start, unsigned n, double* out) const
+{
+    Q_ASSERT(start + n <= size());
+
+    if (n == 0) return;
+
+    unsigned p = phase();
+    if (start >= p || start + n <= p)
+    {
+        _buffer->copySamples(sourceIndex(start), n, out);
+        return;
+    }
+
+    unsigned n1 = p - start;
+    _buffer->copySamples(sourceIndex(start), n1, out);
+    _buffer->copySamples(0, n - n1, out + n1);
+}
@@ -0,0 +1,62 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SWEEPBUFFER_H
+#define SWEEPBUFFER_H
+
+#include "framebuffer.h"
+
+/**
+ * Presents the samples of a buffer in sweep order, like the display of
+ * an oscilloscope.
+ *
+ * Underlying buffer keeps the oldest sample at index 0. This buffer
+ * rotates it so that the oldest sample is at index `phase` and the
+ * newest sample is right before it. When `phase` is set to the
+ * sequence number of the next sample modulo `size()`, every sample
+ * stays at a fixed index until it's overwritten, instead of moving
+ * one index down with each new sample.
+ *
+ * Doesn't own the underlying buffer.
+ */
+class SweepBuffer : public FrameBuffer
+{
+public:
+    explicit SweepBuffer(const FrameBuffer* buffer);
+
+    /// Sets the index of the oldest sample, wrapped to `size()`
+    void setPhase(unsigned phase);
+    /// Returns index of the oldest sample
+    unsigned phase() const;
+
+    virtual unsigned size() const;
+    virtual double sample(unsigned i) const;
+    virtual Range limits() const;
+    virtual Range rangeLimits(unsigned start, unsigned n) const;
+    virtual void copySamples(unsigned start, unsigned n, double* out) const;
+
+private:
+    const FrameBuffer* _buffer;
+    unsigned _phase;
+
+    /// Returns the index of underlying buffer for index `i`
+    unsigned sourceIndex(unsigned i) const;
+};
+
+#endif // SWEEPBUFFER_H
@@ -0,0 +1,351 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <QtGlobal>
+
+#include "tieredhistory.h"
+#include "minmax.h"
+
+/// A read only view of the last `numRows()` samples of a channel
+class TieredHistory::Channel : public FrameBuffer
+{
+public:
+    Channel(const TieredHistory* history, unsigned ci) :
+        history(history), ci(ci) {}
+
+    unsigned size() const override
+    {
+        return history->numRows();
+    }
+    double sample(unsigned i) const override
+    {
+        return history->sample(ci, start() + i);
+    }
+    Range limits() const override
+    {
+        return history->limits(ci);
+    }
+    Range rangeLimits(unsigned start, unsigned n) const override
+    {
+        return history->rangeLimits(ci, this->start() + start, n);
+    }
+
+private:
+    const TieredHistory* history;
+    unsigned ci;                  ///< channel index
+
+    /// Number of the sample at index 0
+    quint64 start() const
+    {
+        return history->endRow() - history->numRows();
+    }
+};
+
+quint64 TieredHistory::Tier::first(quint64 firstRow) const
+{
+    return std::max(firstRow, firstBin * binSize);
+}
+
+unsigned TieredHistory::Tier::slot(quint64 b) const
+{
+    return growing ? b - firstBin : b % capacity;
+}
+
+const TieredHistory::Bin& TieredHistory::Tier::bin(unsigned ci, quint64 b) const
+{
+    return bins[ci * capacity + slot(b)];
+}
+
+TieredHistory::TieredHistory(unsigned nc, unsigned recentSize, unsigned tierBins,
+                             quint64 firstRow) :
+    totals(nc, {0, 0})
+{
+    Q_ASSERT(nc > 0 && recentSize > 0 && tierBins >= 2 && tierBins % 2 == 0);
+
+    _numChannels = nc;
+    _firstRow = firstRow;
+    _endRow = firstRow;
+    recentFrom = firstRow;
+
+    for (unsigned ci = 0; ci < nc; ci++)
+    {
+        recent.append(new RingBuffer(recentSize));
+    }
+
+    quint64 binSize = TIER_FACTOR;
+    for (unsigned t = 0; t < NUM_TIERS; t++)
+    {
+        Tier tier;
+        tier.binSize = binSize;
+        tier.capacity = tierBins;
+        tier.firstBin = firstRow / binSize;
+        tier.endBin = tier.firstBin;
+        tier.growing = (t == NUM_TIERS - 1);
+        tier.bins.resize(nc * tierBins);
+        tiers.append(tier);
+        binSize *= TIER_FACTOR;
+    }
+}
+
+TieredHistory::~TieredHistory()
+{
+    for (auto buf : recent)
+    {
+        delete buf;
+    }
+}
+
+unsigned TieredHistory::numChannels() const
+{
+    return _numChannels;
+}
+
+unsigned TieredHistory::numRows() const
+{
+    // views are indexed with `unsigned`
+    const quint64 maxRows = std::numeric_limits<unsigned>::max();
+    return std::min(_endRow - _firstRow, maxRows);
+}
+
+quint64 TieredHistory::firstRow() const
+{
+    return _firstRow;
+}
+
+quint64 TieredHistory::endRow() const
+{
+    return _endRow;
+}
+
+quint64 TieredHistory::recentStart() const
+{
+    quint64 recentSize = recent[0]->size();
+    return std::max(recentFrom, _endRow - std::min(_endRow, recentSize));
+}
+
+void TieredHistory::setRecentSize(unsigned n)
+{
+    Q_ASSERT(n > 0);
+
+    if (n == recent[0]->size()) return;
+
+    // a grown buffer is zero filled at the beginning
+    recentFrom = recentStart();
+    for (auto buf : recent)
+    {
+        buf->resize(n);
+    }
+}
+
+void TieredHistory::addSamples(const SamplePackView& pack)
+{
+    Q_ASSERT(pack.numChannels() == _numChannels);
+
+    unsigned ns = pack.numSamples();
+    for (auto& tier : tiers)
+    {
+        addToTier(tier, pack);
+    }
+
+    for (unsigned ci = 0; ci < _numChannels; ci++)
+    {
+        recent[ci]->addSamples(pack.data(ci), ns);
+
+        Range r = minMax(pack.data(ci), ns);
+        totals[ci] = (_endRow == _firstRow) ? r : combineLimits(totals[ci], r);
+    }
+    _endRow += ns;
+}
+
+void TieredHistory::addToTier(Tier& tier, const SamplePackView& pack)
+{
+    unsigned ns = pack.numSamples();
+    for (unsigned j = 0; j < ns;)
+    {
+        quint64 i = _endRow + j;  // number of sample in session
+        quint64 b = i / tier.binSize;
+
+        // start a new bin
+        bool newBin = (b == tier.endBin);
+        if (newBin)
+        {
+            while (tier.growing && tier.endBin - tier.firstBin == tier.capacity)
+            {
+                mergeBins(tier);
+                b = i / tier.binSize;
+                newBin = (b == tier.endBin);
+                if (!newBin) break;
+            }
+        }
+        if (newBin)
+        {
+            if (tier.endBin - tier.firstBin == tier.capacity) tier.firstBin++;
+            tier.endBin++;
+        }
+
+        unsigned n = std::min<quint64>((b + 1) * tier.binSize - i, ns - j);
+        for (unsigned ci = 0; ci < _numChannels; ci++)
+        {
+            const double* data = pack.data(ci) + j;
+            Range r = minMax(data, n);
+            double sum = std::accumulate(data, data + n, 0.);
+
+            Bin& bin = tier.bins[ci * tier.capacity + tier.slot(b)];
+            if (newBin)
+            {
+                bin = {r.start, r.end, sum};
+            }
+            else
+            {
+                bin.min = std::min(bin.min, r.start);
+                bin.max = std::max(bin.max, r.end);
+                bin.sum += sum;
+            }
+        }
+        j += n;
+    }
+}
+
+void TieredHistory::mergeBins(Tier& tier)
+{
+    Q_ASSERT(tier.growing);
+
+    // new bin `k` is made of old bins `2k` and `2k+1`, positions of new
+    // bins are never after the old ones so bins are merged in place
+    quint64 newFirst = tier.firstBin / 2;
+    quint64 newEnd = (tier.endBin + 1) / 2;
+    for (unsigned ci = 0; ci < _numChannels; ci++)
+    {
+        Bin* bins = tier.bins.data() + ci * tier.capacity;
+        for (quint64 k = newFirst; k < newEnd; k++)
+        {
+            quint64 b1 = std::max(2 * k, tier.firstBin);
+            quint64 b2 = std::min(2 * k + 1, tier.endBin - 1);
+            Bin merged = bins[b1 - tier.firstBin];
+            if (b2 != b1)
+            {
+                const Bin& other = bins[b2 - tier.firstBin];
+                merged = {std::min(merged.min, other.min), std::max(merged.max, other.max),
+                          merged.sum + other.sum};
+            }
+            bins[k - newFirst] = merged;
+        }
+    }
+    tier.firstBin = newFirst;
+    tier.endBin = newEnd;
+    tier.binSize *= 2;
+}
+
+double TieredHistory::sample(unsigned ci, quint64 i) const
+{
+    Q_ASSERT(ci < _numChannels && i >= _firstRow && i < _endRow);
+
+    if (i >= recentStart())
+    {
+        unsigned recentSize = recent[ci]->size();
+        return recent[ci]->sample(recentSize - (_endRow - i));
+    }
+
+    // finest tier that covers the sample
+    for (auto& tier : tiers)
+    {
+        if (i < tier.first(_firstRow)) continue;
+
+        quint64 b = i / tier.binSize;
+        quint64 binStart = std::max(b * tier.binSize, _firstRow);
+        quint64 binEnd = std::min((b + 1) * tier.binSize, _endRow);
+        return tier.bin(ci, b).sum / (binEnd - binStart);
+    }
+
+    Q_ASSERT(false);            // last tier covers all samples
+    return 0;
+}
+
+Range TieredHistory::limits(unsigned ci) const
+{
+    Q_ASSERT(ci < _numChannels);
+
+    return totals[ci];
+}
+
+const TieredHistory::Tier& TieredHistory::pickTier(quint64 start, quint64 end) const
+{
+    // coarsest tier that has bins smaller than range, or the finest one
+    int t = 0;
+    while (t < (int) NUM_TIERS - 1 && tiers[t+1].binSize <= end - start)
+    {
+        t++;
+    }
+
+    // coarser tiers cover a longer period
+    while (end - 1 < tiers[t].first(_firstRow))
+    {
+        t++;
+    }
+    return tiers[t];
+}
+
+Range TieredHistory::rangeLimits(unsigned ci, quint64 start, quint64 n) const
+{
+    Q_ASSERT(ci < _numChannels && n > 0 && start >= _firstRow && start + n <= _endRow);
+
+    Range result = {0, 0};
+    bool first = true;
+    auto add = [&result, &first](Range r)
+        {
+            result = first ? r : combineLimits(result, r);
+            first = false;
+        };
+
+    // recent part at full resolution
+    quint64 end = start + n;
+    quint64 rStart = recentStart();
+    if (end > rStart)
+    {
+        quint64 s = std::max(start, rStart);
+        unsigned recentSize = recent[ci]->size();
+        add(recent[ci]->rangeLimits(recentSize - (_endRow - s), end - s));
+        end = s;
+    }
+
+    // older parts from bins, going back in time
+    while (start < end)
+    {
+        const Tier& tier = pickTier(start, end);
+        quint64 s = std::max(start, tier.first(_firstRow));
+        for (quint64 b = s / tier.binSize; b <= (end - 1) / tier.binSize; b++)
+        {
+            const Bin& bin = tier.bin(ci, b);
+            add({bin.min, bin.max});
+        }
+        end = s;
+    }
+
+    return result;
+}
+
+FrameBuffer* TieredHistory::makeChannel(unsigned ci) const
+{
+    Q_ASSERT(ci < _numChannels);
+
+    return new Channel(this, ci);
+}
@@ -0,0 +1,140 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TIEREDHISTORY_H
+#define TIEREDHISTORY_H
+
+#include <QList>
+#include <QVector>
+#include <QtGlobal>
+
+#include "history.h"
+#include "ringbuffer.h"
+
+/**
+ * In-memory history of a session with bounded size.
+ *
+ * Last `recentSize` samples are kept at full resolution. Older samples
+ * are only available as summaries (minimum, maximum and mean) of bins
+ * of samples. There are multiple tiers of bins, each tier has
+ * `TIER_FACTOR` times bigger bins than the previous one and keeps
+ * the same number of bins. Bins of finer tiers are dropped as they get old,
+ * while the last (coarsest) tier covers the whole session: when it is
+ * full its bins are merged in pairs, halving its resolution.
+ *
+ * Limits of a range are found from the coarsest data that has bins
+ * not bigger than the range, so a plot that is decimated to pixel
+ * columns reads about the same number of bins at every zoom level.
+ * Limits of old samples are approximate (they include whole bins).
+ * Old samples read one by one are bin means.
+ *
+ * Samples are numbered with 64 bits, so a session can be longer than
+ * 2^32 samples. Channel views (`makeChannel()`) show the last
+ * `numRows()` samples, which is at most `UINT_MAX`.
+ */
+class TieredHistory : public History
+{
+public:
+    /// Number of tiers including the last (growing) one
+    static const unsigned NUM_TIERS = 4;
+    /// Ratio of bin sizes of consecutive tiers
+    static const unsigned TIER_FACTOR = 16;
+    /// Default number of bins of each tier
+    static const unsigned TIER_BINS = 1 << 14;
+
+    /**
+     * @param nc number of channels
+     * @param recentSize number of samples that are kept at full resolution
+     * @param tierBins number of bins of each tier, must be even
+     * @param firstRow number of the first sample, mainly for testing long sessions
+     */
+    TieredHistory(unsigned nc, unsigned recentSize, unsigned tierBins = TIER_BINS,
+                  quint64 firstRow = 0);
+    ~TieredHistory();
+
+    unsigned numChannels() const override;
+    unsigned numRows() const override;
+    void addSamples(const SamplePackView& pack) override;
+    FrameBuffer* makeChannel(unsigned ci) const override;
+
+    /// Returns the number of the first sample
+    quint64 firstRow() const;
+    /// Returns the number after the last sample
+    quint64 endRow() const;
+    /// Changes the number of samples that are kept at full resolution.
+    /// Samples that are already binned stay binned when growing.
+    void setRecentSize(unsigned n);
+
+    /// Returns sample number `i` of channel `ci`, bin mean if it's not recent.
+    double sample(unsigned ci, quint64 i) const;
+    /// Returns minimum and maximum of all samples of channel `ci`.
+    Range limits(unsigned ci) const;
+    /// Returns minimum and maximum of `n` samples of channel `ci`
+    /// starting from sample number `start`.
+    Range rangeLimits(unsigned ci, quint64 start, quint64 n) const;
+
+private:
+    class Channel;
+
+    /// Summary of a bin of samples
+    struct Bin
+    {
+        double min, max;
+        double sum;
+    };
+
+    /// Bins of all channels for a resolution. Bin `b` covers samples
+    /// [b * binSize, (b+1) * binSize).
+    struct Tier
+    {
+        quint64 binSize;        ///< number of samples in a bin
+        unsigned capacity;      ///< number of bins kept for each channel
+        quint64 firstBin;       ///< number of the oldest kept bin
+        quint64 endBin;         ///< number after the newest bin
+        bool growing;           ///< bins are merged instead of dropped
+        QVector<Bin> bins;      ///< `capacity` bins for each channel
+
+        /// Returns the first sample that is covered by bins
+        quint64 first(quint64 firstRow) const;
+        /// Returns bin number `b` of channel `ci`
+        const Bin& bin(unsigned ci, quint64 b) const;
+        /// Returns position of bin number `b` in `bins` of a channel. Bins
+        /// of a growing tier are in order, others are in a ring.
+        unsigned slot(quint64 b) const;
+    };
+
+    unsigned _numChannels;
+    quint64 _firstRow;              ///< number of the first sample
+    quint64 _endRow;                ///< number after the last sample
+    quint64 recentFrom;             ///< no sample before this is in `recent`
+    QList<RingBuffer*> recent;      ///< last samples at full resolution
+    QVector<Tier> tiers;            ///< from finest to coarsest
+    QVector<Range> totals;          ///< limits of all samples of channels
+
+    /// Returns the first sample that is kept at full resolution
+    quint64 recentStart() const;
+    /// Adds samples of pack to bins of a tier
+    void addToTier(Tier& tier, const SamplePackView& pack);
+    /// Merges bins of a tier in pairs, doubling the bin size
+    void mergeBins(Tier& tier);
+    /// Returns the tier to read limits of range [start, end) from
+    const Tier& pickTier(quint64 start, quint64 end) const;
+};
+
+#endif // TIEREDHISTORY_H
@@ -0,0 +1,90 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+
+#include "xringbuffer.h"
+
+XRingBuffer::XRingBuffer(unsigned n) :
+    buffer(n)
+{
+}
+
+unsigned XRingBuffer::size() const
+{
+    return buffer.size();
+}
+
+double XRingBuffer::sample(unsigned i) const
+{
+    return buffer.sample(i);
+}
+
+Range XRingBuffer::limits() const
+{
+    return {buffer.sample(0), buffer.sample(buffer.size()-1)};
+}
+
+void XRingBuffer::resize(unsigned n)
+{
+    buffer.resize(n);
+}
+
+int XRingBuffer::findIndex(double value) const
+{
+    unsigned last = buffer.size()-1;
+    if (value < buffer.sample(0) || value > buffer.sample(last))
+    {
+        return OUT_OF_RANGE;
+    }
+
+    // find the last sample that is smaller or equal to `value`,
+    // invariant: sample(lo) <= value < sample(hi)
+    unsigned lo = 0;
+    unsigned hi = last + 1;
+    while (hi - lo > 1)
+    {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (buffer.sample(mid) <= value)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+void XRingBuffer::copySamples(unsigned start, unsigned n, double* out) const
+{
+    buffer.copySamples(start, n, out);
+}
+
+void XRingBuffer::addSamples(const double* samples, unsigned n)
+{
+    buffer.addSamples(samples, n);
+}
+
+void XRingBuffer::clear()
+{
+    buffer.clear();
+}
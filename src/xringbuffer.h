@@ -0,0 +1,58 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XRINGBUFFER_H
+#define XRINGBUFFER_H
+
+#include "framebuffer.h"
+#include "ringbuffer.h"
+
+/**
+ * A ring buffer for storing X data that is provided by the source
+ * (ex: device timestamps).
+ *
+ * Samples must be non-decreasing. This is also true for the initial
+ * content of the buffer, which is filled with 0s, so X values are
+ * expected to be non-negative.
+ *
+ * Since data is sorted, `findIndex` is a binary search and `limits`
+ * are simply the first and last samples.
+ */
+class XRingBuffer : public XFrameBuffer
+{
+public:
+    XRingBuffer(unsigned n);
+
+    unsigned size() const override;
+    double sample(unsigned i) const override;
+    Range limits() const override;
+    void resize(unsigned n) override;
+    int findIndex(double value) const override;
+    void copySamples(unsigned start, unsigned n, double* out) const override;
+
+    /// Add samples to the buffer
+    void addSamples(const double* samples, unsigned n);
+    /// Reset all data to 0
+    void clear();
+
+private:
+    RingBuffer buffer;
+};
+
+#endif // XRINGBUFFER_H
@@ -0,0 +1,74 @@
+/*
+  Copyright © 2021 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Micro-benchmark for min/max kernels. Prints throughput of each
+// kernel that is supported by the running CPU.
+//
+// usage: BenchMinMax [number of samples] [repeat]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "minmax.h"
+
+int main(int argc, char* argv[])
+{
+    unsigned n = argc > 1 ? strtoul(argv[1], NULL, 10) : 2*1024*1024;
+    unsigned repeat = argc > 2 ? strtoul(argv[2], NULL, 10) : 100;
+
+    std::vector<double> data(n);
+    for (unsigned i = 0; i < n; i++)
+    {
+        data[i] = (i * 7919) % 10007 - 5000.;
+    }
+
+    printf("%u samples (%.1f MiB), %u repeats\n",
+           n, n * sizeof(double) / (1024. * 1024.), repeat);
+
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::SSE2,
+                                SimdLevel::AVX2, SimdLevel::AVX512};
+    for (auto level : levels)
+    {
+        if (!isSimdLevelSupported(level))
+        {
+            printf("%-8s not supported\n", simdLevelName(level));
+            continue;
+        }
+
+        // warm up
+        Range r = minMax(level, data.data(), n);
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < repeat; i++)
+        {
+            Range ri = minMax(level, data.data(), n);
+            r.start += ri.start;
+            r.end += ri.end;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        double gbps = double(n) * sizeof(double) * repeat / elapsed.count() / 1e9;
+        // printing result so that loop isn't optimized out
+        printf("%-8s %8.2f GB/s (%g)\n", simdLevelName(level), gbps, r.end - r.start);
+    }
+
+    return 0;
+}
@@ -20,12 +20,34 @@
 #define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
 #include "catch.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
 #include "samplepack.h"
+#include "samplepackview.h"
+#include "allocator.h"
 #include "source.h"
+#include "packqueue.h"
+#include "sinkpool.h"
 #include "indexbuffer.h"
 #include "linindexbuffer.h"
 #include "ringbuffer.h"
-#include "readonlybuffer.h"
+#include "xringbuffer.h"
+#include "multiringbuffer.h"
+#include "historyfile.h"
+#include "tieredhistory.h"
+#include "sweepbuffer.h"
+#include "compression.h"
+#include "compressedbuffer.h"
+#include "minmax.h"
+#include "gainoffset.h"
+#include "minmaxpyramid.h"
 
 #include "test_helpers.h"
 
@@ -79,6 +101,140 @@ TEST_CASE("samplepack copy", "[memory]")
     }
 }
 
+TEST_CASE("samplepack move", "[memory]")
+{
+    size_t before = memoryReserved(MemoryUser_Packs);
+
+    SamplePack pack(10, 2, true);
+    pack.xData()[9] = 1;
+    pack.data(1)[9] = 2;
+    double* data = pack.data(0);
+
+    SamplePack other(std::move(pack));
+    REQUIRE(pack.numSamples() == 0);
+    REQUIRE(pack.numChannels() == 0);
+    REQUIRE(other.numSamples() == 10);
+    REQUIRE(other.hasX());
+    REQUIRE(other.data(0) == data);
+    REQUIRE(other.xData()[9] == 1);
+    REQUIRE(other.data(1)[9] == 2);
+
+    // previous data is released on assignment
+    SamplePack third(5, 1);
+    third = std::move(other);
+    REQUIRE(third.numSamples() == 10);
+    REQUIRE(third.data(0) == data);
+    REQUIRE(other.numSamples() == 0);
+
+    third = SamplePack();
+    REQUIRE(third.numChannels() == 0);
+    REQUIRE(memoryReserved(MemoryUser_Packs) == before);
+}
+
+TEST_CASE("samplepack view", "[memory]")
+{
+    SamplePack pack(4, 2, true);
+    for (unsigned i = 0; i < 4; i++)
+    {
+        pack.xData()[i] = i;
+        pack.data(0)[i] = 10 + i;
+        pack.data(1)[i] = 20 + i;
+    }
+
+    SamplePackView planar = pack;
+    REQUIRE(planar.isPlanar());
+    REQUIRE(planar.numSamples() == 4);
+    REQUIRE(planar.numChannels() == 2);
+    REQUIRE(planar.data(1) == pack.data(1));
+    REQUIRE(planar.xData() == pack.xData());
+    REQUIRE(planar.sample(1, 3) == 23);
+
+    // rows of {x, ch0, ch1}
+    double rows[] = {0, 10, 20, 1, 11, 21, 2, 12, 22, 3, 13, 23};
+    auto inter = SamplePackView::interleaved(4, 2, rows, true);
+    REQUIRE_FALSE(inter.isPlanar());
+    REQUIRE(inter.hasX());
+    REQUIRE(inter.x(2) == 2);
+    REQUIRE(inter.sample(0, 1) == 11);
+    REQUIRE(inter.sample(1, 3) == 23);
+
+    double out[3];
+    inter.copyChannel(1, 1, 3, out);
+    REQUIRE(out[0] == 21);
+    REQUIRE(out[2] == 23);
+    inter.copyX(0, 3, out);
+    REQUIRE(out[1] == 1);
+
+    // planar data is transposed to rows, rows are copied as is
+    REQUIRE(inter.isInterleaved());
+    REQUIRE_FALSE(planar.isInterleaved());
+    double copied[12];
+    planar.copyRows(copied);
+    REQUIRE(std::equal(rows, rows + 12, copied));
+    std::fill(copied, copied + 12, 0);
+    inter.copyRows(copied);
+    REQUIRE(std::equal(rows, rows + 12, copied));
+
+    // single row is also planar
+    auto row = SamplePackView::interleaved(1, 2, rows + 4);
+    REQUIRE(row.isPlanar());
+    REQUIRE(row.data(1)[0] == 20 + 1);
+}
+
+TEST_CASE("aligned allocation", "[memory]")
+{
+    size_t before = memoryReserved(MemoryUser_Snapshots);
+
+    // small ones come from heap, big ones are mapped
+    size_t sizes[] = {8, 1000, 300 * 1024, 5 * 1024 * 1024 + 8};
+    for (size_t bytes : sizes)
+    {
+        auto mem = static_cast<unsigned char*>(allocAligned(bytes, MemoryUser_Snapshots));
+        REQUIRE(reinterpret_cast<uintptr_t>(mem) % MEMORY_ALIGNMENT == 0);
+        REQUIRE(memoryReserved(MemoryUser_Snapshots) == before + bytes);
+        REQUIRE(mem[0] == 0);
+        REQUIRE(mem[bytes/2] == 0);
+        REQUIRE(mem[bytes-1] == 0);
+        mem[bytes-1] = 1;
+
+        freeAligned(mem, bytes, MemoryUser_Snapshots);
+        REQUIRE(memoryReserved(MemoryUser_Snapshots) == before);
+    }
+}
+
+TEST_CASE("pooled allocation", "[memory]")
+{
+    size_t before = memoryReserved(MemoryUser_Packs);
+
+    void* mem = allocPooled(1000, MemoryUser_Packs);
+    REQUIRE(reinterpret_cast<uintptr_t>(mem) % MEMORY_ALIGNMENT == 0);
+    // rounded up to size class
+    REQUIRE(memoryReserved(MemoryUser_Packs) == before + 1024);
+    freePooled(mem, 1000, MemoryUser_Packs);
+    REQUIRE(memoryReserved(MemoryUser_Packs) == before);
+
+    // same size class re-uses the freed block
+    size_t pooled = memoryReserved(MemoryUser_Pool);
+    void* mem2 = allocPooled(600, MemoryUser_Packs);
+    REQUIRE(mem2 == mem);
+    REQUIRE(memoryReserved(MemoryUser_Pool) == pooled - 1024);
+    freePooled(mem2, 600, MemoryUser_Packs);
+
+    // too big for pool
+    void* big = allocPooled(4 * 1024 * 1024, MemoryUser_Packs);
+    REQUIRE(memoryReserved(MemoryUser_Packs) == before + 4 * 1024 * 1024);
+    freePooled(big, 4 * 1024 * 1024, MemoryUser_Packs);
+    REQUIRE(memoryReserved(MemoryUser_Packs) == before);
+
+    // packs are counted
+    {
+        SamplePack pack(100, 3, true);
+        REQUIRE(memoryReserved(MemoryUser_Packs) >= before + sizeof(double) * 400);
+        REQUIRE(pack.data(2)[99] == 0);
+    }
+    REQUIRE(memoryReserved(MemoryUser_Packs) == before);
+}
+
 TEST_CASE("sink", "[memory, stream]")
 {
     TestSink sink;
@@ -169,6 +325,426 @@ TEST_CASE("source disconnect all sinks", "[memory, stream]")
     }
 }
 
+/// Records first value of each fed pack
+class RecordingSink : public TestSink
+{
+public:
+    std::vector<double> firstValues;
+    SamplePackView lastView = SamplePackView(0, 0, nullptr, 0, 0);
+
+    void feedIn(const SamplePackView& data)
+        {
+            firstValues.push_back(data.sample(0, 0));
+            lastView = data;
+            TestSink::feedIn(data);
+        };
+};
+
+TEST_CASE("PackQueue", "[memory, stream]")
+{
+    TestSource source(2, false);
+    PackQueue queue(8);
+    RecordingSink sink;
+
+    source.connectSink(&queue);
+    queue.connectSink(&sink);
+    REQUIRE(sink.connectedSource() == &queue);
+    // configuration of source reaches sinks with drain
+    REQUIRE(sink.numChannels() == 0);
+    REQUIRE(queue.drain() == 0);
+    REQUIRE(sink.numChannels() == 2);
+
+    for (int i = 0; i < 5; i++)
+    {
+        SamplePack pack(10, 2);
+        pack.data(0)[0] = i;
+        source._feed(pack);
+    }
+    REQUIRE(sink.totalFed == 0);
+    REQUIRE(queue.pending() == 5);
+
+    REQUIRE(queue.drain() == 5);
+    REQUIRE(queue.pending() == 0);
+    REQUIRE(sink.totalFed == 50);
+    REQUIRE(sink.firstValues == std::vector<double>({0, 1, 2, 3, 4}));
+
+    // pending packs are fed before the channel configuration changes
+    SamplePack pack(10, 2);
+    source._feed(pack);
+    source._setNumChannels(3, true);
+    REQUIRE(sink.numChannels() == 2);
+    REQUIRE(queue.drain() == 1);
+    REQUIRE(sink.totalFed == 60);
+    REQUIRE(sink.numChannels() == 3);
+    REQUIRE(sink.hasX() == true);
+
+    // interleaved data stays interleaved
+    double rows[] = {0, 10, 20, 30, 1, 11, 21, 31};
+    source._feed(SamplePackView::interleaved(2, 3, rows, true));
+    REQUIRE(queue.drain() == 1);
+    REQUIRE(sink.firstValues.back() == 10);
+    REQUIRE(sink.lastView.isInterleaved());
+    REQUIRE(!sink.lastView.isPlanar());
+    REQUIRE(sink.lastView.x(1) == 1);
+    REQUIRE(sink.lastView.sample(2, 1) == 31);
+    REQUIRE(sink.totalFed == 62);
+
+    SamplePack packX(10, 3, true);
+    source._feed(packX);
+    queue.clear();
+    REQUIRE(queue.pending() == 0);
+    REQUIRE(queue.drain() == 0);
+    REQUIRE(sink.totalFed == 62);
+
+    // each configuration is applied before its packs
+    source._setNumChannels(1, false);
+    SamplePack pack1(5, 1);
+    source._feed(pack1);
+    source._setNumberFormat(NumberFormat_uint8);
+    source._setNumChannels(2, false);
+    source._feed(pack);
+    REQUIRE(queue.numberFormat() == NumberFormat_double);
+    REQUIRE(queue.drain() == 2);
+    REQUIRE(sink.totalFed == 77);
+    REQUIRE(sink.numChannels() == 2);
+    REQUIRE(queue.numberFormat() == NumberFormat_uint8);
+}
+
+TEST_CASE("PackQueue pending callback", "[memory, stream]")
+{
+    TestSource source(1, false);
+    PackQueue queue(4);
+    int calls = 0;
+    queue.setPendingCallback([&calls]() {calls++;});
+
+    source.connectSink(&queue);
+    REQUIRE(calls == 1);
+
+    // called once until the next drain
+    SamplePack pack(10, 1);
+    source._feed(pack);
+    source._feed(pack);
+    REQUIRE(calls == 1);
+    queue.drain();
+    source._feed(pack);
+    REQUIRE(calls == 2);
+    queue.drain();
+    REQUIRE(calls == 2);
+}
+
+TEST_CASE("PackQueue overflow", "[memory, stream]")
+{
+    TestSource source(1, false);
+    PackQueue queue(4, PackQueue::DropOldest);
+    RecordingSink sink;
+
+    source.connectSink(&queue);
+    queue.connectSink(&sink);
+
+    SamplePack pack(10, 1);
+    for (int i = 0; i < 6; i++)
+    {
+        pack.data(0)[0] = i;
+        source._feed(pack);
+    }
+    REQUIRE(queue.overflows() == 2);
+    REQUIRE(queue.droppedPacks() == 2);
+    REQUIRE(queue.droppedSamples() == 20);
+    queue.drain();
+    REQUIRE(sink.firstValues == std::vector<double>({2, 3, 4, 5}));
+
+    // blocking in consumer thread drains the queue
+    sink.firstValues.clear();
+    queue.setPolicy(PackQueue::Block);
+    for (int i = 0; i < 6; i++)
+    {
+        pack.data(0)[0] = i;
+        source._feed(pack);
+    }
+    REQUIRE(queue.overflows() == 3);
+    REQUIRE(queue.droppedPacks() == 2);
+    REQUIRE(sink.firstValues.size() == 4);
+    queue.drain();
+    REQUIRE(sink.firstValues == std::vector<double>({0, 1, 2, 3, 4, 5}));
+}
+
+TEST_CASE("PackQueue with producer thread", "[memory, stream]")
+{
+    const int N = 5000;
+    TestSource source(1, false);
+    PackQueue queue(16);
+    RecordingSink sink;
+
+    source.connectSink(&queue);
+    queue.connectSink(&sink);
+
+    // channels change in the middle, sink must not see a pack in wrong
+    // configuration
+    std::thread producer([&source]()
+        {
+            for (int i = 0; i < N; i++)
+            {
+                unsigned nc = i < N / 2 ? 1 : 2;
+                if (nc != source.numChannels()) source._setNumChannels(nc, false);
+
+                SamplePack pack(1 + i % 3, nc);
+                pack.data(0)[0] = i;
+                source._feed(pack);
+            }
+        });
+    while (sink.firstValues.size() < N)
+    {
+        queue.drain();
+    }
+    producer.join();
+
+    REQUIRE(queue.droppedPacks() == 0);
+    int outOfOrder = 0, total = 0;
+    for (int i = 0; i < N; i++)
+    {
+        if (sink.firstValues[i] != i) outOfOrder++;
+        total += 1 + i % 3;
+    }
+    REQUIRE(outOfOrder == 0);
+    REQUIRE(sink.totalFed == total);
+    REQUIRE(sink.numChannels() == 2);
+}
+
+/// Records first values of packs, can be fed from a `SinkPool`. Doesn't
+/// use `REQUIRE` in `feedIn`, it's not thread-safe.
+class PooledSink : public Sink
+{
+public:
+    std::vector<double> firstValues;
+    std::vector<std::thread::id> threads;
+    unsigned numChannels = 0;
+    unsigned badPacks = 0;      ///< packs with wrong number of channels
+    unsigned delayUs = 0;
+
+    bool isThreadSafe() const override {return true;};
+
+    void feedIn(const SamplePackView& data) override
+        {
+            if (delayUs) std::this_thread::sleep_for(std::chrono::microseconds(delayUs));
+            if (data.numChannels() != numChannels) badPacks++;
+            firstValues.push_back(data.sample(0, 0));
+            threads.push_back(std::this_thread::get_id());
+            Sink::feedIn(data);
+        };
+
+    void setNumChannels(unsigned nc, bool x) override
+        {
+            numChannels = nc;
+            Sink::setNumChannels(nc, x);
+        };
+};
+
+TEST_CASE("SinkPool", "[memory, stream, sink]")
+{
+    const int N = 200;
+    SinkPool pool(2);
+    REQUIRE(pool.numThreads() == 2);
+
+    TestSource source(2, false);
+    PooledSink fast, slow;
+    RecordingSink direct;
+    slow.delayUs = 100;
+    source.connectSink(&fast);
+    source.connectSink(&slow);
+    source.connectSink(&direct);
+    source.setSinkPool(&pool);
+
+    for (int i = 0; i < N; i++)
+    {
+        SamplePack pack(3, 2);
+        pack.data(0)[0] = i;
+        source._feed(pack);
+        // pack is re-used by source, pooled sinks must get a copy
+        pack.data(0)[0] = -1;
+    }
+
+    // not thread-safe sinks are fed before returning
+    REQUIRE(direct.firstValues.size() == N);
+    REQUIRE(pool.queueDepth(&direct) == 0);
+
+    pool.flush();
+    REQUIRE(pool.queueDepth(&slow) == 0);
+    for (auto sink : {&fast, &slow})
+    {
+        REQUIRE(sink->firstValues.size() == N);
+        REQUIRE(sink->threads[0] != std::this_thread::get_id());
+        for (int i = 0; i < N; i++)
+        {
+            REQUIRE(sink->firstValues[i] == i);
+        }
+    }
+
+    // slow sink queue was visible
+    bool slowSeen = false;
+    for (auto& st : pool.stats())
+    {
+        if (st.sink == &slow)
+        {
+            slowSeen = true;
+            REQUIRE(st.depth == 0);
+            REQUIRE(st.peakDepth > 1);
+        }
+    }
+    REQUIRE(slowSeen);
+    pool.resetPeaks();
+    REQUIRE(pool.stats()[0].peakDepth == 0);
+
+    // pending data is flushed before channel number changes
+    for (int i = 0; i < 20; i++)
+    {
+        SamplePack pack(1, 2);
+        pack.data(0)[0] = i;
+        source._feed(pack);
+    }
+    source._setNumChannels(3, false);
+    REQUIRE(slow.firstValues.size() == N + 20);
+    REQUIRE(slow.numChannels == 3);
+    REQUIRE(slow.badPacks == 0);
+
+    // disconnected sink doesn't get any data after disconnect returns
+    SamplePack pack(1, 3);
+    source._feed(pack);
+    source.disconnect(&slow);
+    REQUIRE(slow.firstValues.size() == N + 21);
+    source._feed(pack);
+    pool.flush();
+    REQUIRE(slow.firstValues.size() == N + 21);
+    REQUIRE(fast.firstValues.size() == N + 22);
+}
+
+/// Pooled sink that doesn't return from `feedIn` until it's opened
+class GatedSink : public PooledSink
+{
+public:
+    std::atomic<bool> open{false};
+    std::atomic<unsigned> entered{0};  ///< number of `feedIn` calls
+
+    void feedIn(const SamplePackView& data) override
+        {
+            entered++;
+            while (!open) std::this_thread::sleep_for(std::chrono::microseconds(100));
+            PooledSink::feedIn(data);
+        };
+
+    void waitEntered(unsigned n) const
+        {
+            while (entered < n) std::this_thread::sleep_for(std::chrono::microseconds(100));
+        };
+};
+
+TEST_CASE("SinkPool queue limit", "[memory, stream, sink]")
+{
+    TestSource source(1, false);
+    auto feed = [&source](int i)
+        {
+            SamplePack pack(3, 1);
+            pack.data(0)[0] = i;
+            source._feed(pack);
+        };
+
+    SECTION("block")
+    {
+        SinkPool pool(2, 4, SinkPool::Block);
+        REQUIRE(pool.maxDepth() == 4);
+        PooledSink slow;
+        slow.delayUs = 200;
+        source.connectSink(&slow);
+        source.setSinkPool(&pool);
+
+        for (int i = 0; i < 50; i++)
+        {
+            feed(i);
+            REQUIRE(pool.queueDepth(&slow) <= 4);
+        }
+        pool.flush();
+        REQUIRE(slow.firstValues.size() == 50);
+        for (int i = 0; i < 50; i++)
+        {
+            REQUIRE(slow.firstValues[i] == i);
+        }
+        auto st = pool.stats()[0];
+        REQUIRE(st.overflows > 0);
+        REQUIRE(st.droppedSamples == 0);
+        source.disconnect(&slow);
+    }
+
+    SECTION("drop oldest")
+    {
+        SinkPool pool(1, 2, SinkPool::DropOldest);
+        GatedSink gated;
+        source.connectSink(&gated);
+        source.setSinkPool(&pool);
+
+        // first pack is being fed, others replace each other
+        feed(0);
+        gated.waitEntered(1);
+        for (int i = 1; i < 6; i++) feed(i);
+        REQUIRE(pool.queueDepth(&gated) == 2);
+        gated.open = true;
+        pool.flush();
+        REQUIRE(gated.firstValues == std::vector<double>({0, 5}));
+
+        auto st = pool.stats()[0];
+        REQUIRE(st.overflows == 4);
+        REQUIRE(st.droppedSamples == 4 * 3);
+        source.disconnect(&gated);
+    }
+
+    SECTION("drop incoming")
+    {
+        // only pack in queue is being fed
+        SinkPool pool(1, 1, SinkPool::DropOldest);
+        GatedSink gated;
+        source.connectSink(&gated);
+        source.setSinkPool(&pool);
+
+        feed(0);
+        gated.waitEntered(1);
+        feed(1);
+        REQUIRE(pool.queueDepth(&gated) == 1);
+        gated.open = true;
+        pool.flush();
+        REQUIRE(gated.firstValues == std::vector<double>({0}));
+        REQUIRE(pool.stats()[0].droppedSamples == 3);
+        source.disconnect(&gated);
+    }
+}
+
+TEST_CASE("SinkPool with followers", "[memory, stream, sink]")
+{
+    SinkPool pool(3);
+    TestSource source(1, false);
+    TestSink sink;
+    PooledSink followers[4];
+
+    source.connectSink(&sink);
+    for (auto& f : followers) sink.connectFollower(&f);
+    sink.setFollowerPool(&pool);
+
+    for (int i = 0; i < 100; i++)
+    {
+        double value = i;
+        source._feed(SamplePackView::planar(1, 1, &value));
+    }
+    pool.flush();
+    for (auto& f : followers)
+    {
+        REQUIRE(f.firstValues.size() == 100);
+        REQUIRE(f.firstValues[99] == 99);
+    }
+
+    // back to calling thread
+    sink.setFollowerPool(nullptr);
+    double value = 100;
+    source._feed(SamplePackView::planar(1, 1, &value));
+    REQUIRE(followers[0].threads.back() == std::this_thread::get_id());
+}
+
 TEST_CASE("IndexBuffer", "[memory, buffer]")
 {
     IndexBuffer buf(10);
@@ -340,6 +916,63 @@ TEST_CASE("RingBuffer limits", "[memory, buffer]")
     REQUIRE(lim.end == 9.);
 }
 
+TEST_CASE("RingBuffer limits of a large buffer", "[memory, buffer]")
+{
+    const unsigned N = 10000;
+    RingBuffer buf(N);
+
+    // brute force limits for comparison
+    auto calcLimits = [&buf]() -> Range
+        {
+            Range r = {buf.sample(0), buf.sample(0)};
+            for (unsigned i = 1; i < buf.size(); i++)
+            {
+                r.start = std::min(r.start, buf.sample(i));
+                r.end = std::max(r.end, buf.sample(i));
+            }
+            return r;
+        };
+
+    // spike at the beginning and bottom at the end
+    double values[N];
+    for (unsigned i = 0; i < N; i++)
+    {
+        values[i] = i % 100;
+    }
+    values[10] = 500;
+    values[N-10] = -500;
+
+    buf.addSamples(values, N);
+    auto lim = buf.limits();
+    REQUIRE(lim.start == -500.);
+    REQUIRE(lim.end == 500.);
+
+    // add in small chunks so that writes wrap around, spike gets pushed out
+    for (unsigned i = 0; i < 30; i++)
+    {
+        buf.addSamples(&values[100], 337);
+        lim = buf.limits();
+        auto expected = calcLimits();
+        REQUIRE(lim.start == expected.start);
+        REQUIRE(lim.end == expected.end);
+    }
+    REQUIRE(lim.start == 0.);
+    REQUIRE(lim.end == 99.);
+
+    // first element is the maximum
+    values[0] = 1000;
+    buf.addSamples(values, 50);
+    lim = buf.limits();
+    REQUIRE(lim.end == 1000.);
+
+    // resizing should keep limits correct
+    buf.resize(N/2);
+    lim = buf.limits();
+    auto expected = calcLimits();
+    REQUIRE(lim.start == expected.start);
+    REQUIRE(lim.end == expected.end);
+}
+
 TEST_CASE("RingBuffer clear", "[memory, buffer]")
 {
     RingBuffer buf(10);
@@ -358,34 +991,977 @@ TEST_CASE("RingBuffer clear", "[memory, buffer]")
     REQUIRE(lim.end == 0.);
 }
 
-TEST_CASE("ReadOnlyBuffer", "[memory, buffer]")
+TEST_CASE("RingBuffer with compact storage", "[memory, buffer]")
+{
+    RingBufferT<qint16> buf(10);
+    double values[5] = {-32768, -5, 0, 7, 32767};
+
+    buf.addSamples(values, 5);
+    REQUIRE(buf.sample(0) == 0.);
+    for (unsigned i = 0; i < 5; i++)
+    {
+        REQUIRE(buf.sample(i+5) == values[i]);
+    }
+
+    auto lim = buf.limits();
+    REQUIRE(lim.start == -32768.);
+    REQUIRE(lim.end == 32767.);
+    lim = buf.rangeLimits(6, 3);
+    REQUIRE(lim.start == -5.);
+    REQUIRE(lim.end == 7.);
+
+    buf.resize(4);
+    REQUIRE(buf.sample(0) == -5.);
+    REQUIRE(buf.sample(3) == 32767.);
+
+    RingBufferT<float> fbuf(4);
+    double fvalues[4] = {0.5, -1.25, 3, 1e6};
+    fbuf.addSamples(fvalues, 4);
+    for (unsigned i = 0; i < 4; i++)
+    {
+        REQUIRE(fbuf.sample(i) == fvalues[i]);
+    }
+    REQUIRE(fbuf.limits().start == -1.25);
+    REQUIRE(fbuf.limits().end == 1e6);
+}
+
+TEST_CASE("copying samples in bulk", "[memory, buffer]")
+{
+    RingBuffer buf(10);
+    double values[15];
+    for (unsigned i = 0; i < 15; i++) values[i] = i + 1;
+
+    // make the data wrap around
+    buf.addSamples(values, 15);
+    buf.addSamples(values, 3);
+
+    double out[10];
+    buf.copySamples(0, 10, out);
+    for (unsigned i = 0; i < 10; i++)
+    {
+        REQUIRE(out[i] == buf.sample(i));
+    }
+    buf.copySamples(5, 4, out);
+    for (unsigned i = 0; i < 4; i++)
+    {
+        REQUIRE(out[i] == buf.sample(i+5));
+    }
+
+    // default implementation
+    IndexBuffer ibuf(10);
+    ibuf.copySamples(3, 2, out);
+    REQUIRE(out[0] == 3.);
+    REQUIRE(out[1] == 4.);
+
+    // resize of a compact buffer
+    RingBufferT<quint8> cbuf(10);
+    cbuf.addSamples(values, 15);
+    cbuf.addSamples(values, 3);
+    cbuf.resize(6);
+    for (unsigned i = 0; i < 6; i++)
+    {
+        REQUIRE(cbuf.sample(i) == buf.sample(i+4));
+    }
+}
+
+TEST_CASE("MultiRingBuffer", "[memory, buffer]")
+{
+    MultiRingBufferT<qint32> buf(3, 10);
+    REQUIRE(buf.numChannels() == 3);
+    REQUIRE(buf.size() == 10);
+
+    FrameBuffer* views[3];
+    for (unsigned ci = 0; ci < 3; ci++)
+    {
+        views[ci] = buf.makeChannel(ci);
+        REQUIRE(views[ci]->size() == 10);
+        REQUIRE(views[ci]->sample(9) == 0);
+    }
+
+    // channel `ci` gets values `ci*100 + i`
+    unsigned total = 0;
+    auto addPack = [&buf, &total](unsigned ns)
+        {
+            SamplePack pack(ns, buf.numChannels());
+            for (unsigned ci = 0; ci < buf.numChannels(); ci++)
+            {
+                for (unsigned i = 0; i < ns; i++)
+                {
+                    pack.data(ci)[i] = ci*100 + total + i;
+                }
+            }
+            buf.addSamples(pack);
+            total += ns;
+        };
+
+    addPack(7);
+    REQUIRE(views[1]->limits().end == 106);
+    addPack(7);                 // wraps around
+    for (unsigned ci = 0; ci < 3; ci++)
+    {
+        for (unsigned i = 0; i < 10; i++)
+        {
+            REQUIRE(views[ci]->sample(i) == ci*100 + 4 + i);
+        }
+        auto lim = views[ci]->limits();
+        REQUIRE(lim.start == ci*100 + 4);
+        REQUIRE(lim.end == ci*100 + 13);
+        lim = views[ci]->rangeLimits(2, 7);
+        REQUIRE(lim.start == ci*100 + 6);
+        REQUIRE(lim.end == ci*100 + 12);
+    }
+
+    addPack(25);                // bigger than size
+    double out[10];
+    views[2]->copySamples(0, 10, out);
+    for (unsigned i = 0; i < 10; i++)
+    {
+        REQUIRE(out[i] == 200 + 29 + i);
+    }
+
+    // removing a channel keeps the others
+    delete views[2];
+    buf.setNumChannels(2);
+    REQUIRE(views[1]->sample(9) == 100 + 38);
+    REQUIRE(views[1]->limits().end == 100 + 38);
+
+    buf.resize(5);
+    REQUIRE(views[0]->size() == 5);
+    REQUIRE(views[0]->sample(0) == 34);
+    REQUIRE(views[0]->limits().start == 34);
+
+    buf.resize(20);
+    REQUIRE(views[1]->sample(0) == 0);
+    REQUIRE(views[1]->sample(19) == 100 + 38);
+    REQUIRE(views[1]->limits().start == 0);
+
+    buf.clear();
+    REQUIRE(views[0]->sample(19) == 0);
+    REQUIRE(views[0]->limits().end == 0);
+
+    delete views[0];
+    delete views[1];
+}
+
+TEST_CASE("MultiRingBuffer with mirrored memory", "[memory, buffer]")
+{
+    // big enough to be mirrored if supported, checked against `RingBuffer`
+    const unsigned N = 10000;
+    MultiRingBufferT<double> buf(2, N);
+    RingBuffer ref0(N), ref1(N);
+    FrameBuffer* view0 = buf.makeChannel(0);
+    FrameBuffer* view1 = buf.makeChannel(1);
+
+    auto check = [&]()
+        {
+            double out[N];
+            view1->copySamples(0, N, out);
+            for (unsigned i = 0; i < N; i += 7)
+            {
+                REQUIRE(view0->sample(i) == ref0.sample(i));
+                REQUIRE(out[i] == ref1.sample(i));
+            }
+            REQUIRE(view0->limits().start == ref0.limits().start);
+            REQUIRE(view0->limits().end == ref0.limits().end);
+            REQUIRE(view1->rangeLimits(N/3, N/2).start == ref1.rangeLimits(N/3, N/2).start);
+            REQUIRE(view1->rangeLimits(N/3, N/2).end == ref1.rangeLimits(N/3, N/2).end);
+        };
+
+    unsigned total = 0;
+    unsigned packSizes[] = {1, 777, 3000, 9999, 4096, 12345, 5};
+    for (unsigned ns : packSizes)
+    {
+        SamplePack pack(ns, 2);
+        for (unsigned i = 0; i < ns; i++)
+        {
+            pack.data(0)[i] = (total + i) % 1013;
+            pack.data(1)[i] = -double((total + i) % 997);
+        }
+        total += ns;
+
+        buf.addSamples(pack);
+        ref0.addSamples(pack.data(0), ns);
+        ref1.addSamples(pack.data(1), ns);
+        check();
+    }
+
+    delete view1;
+    buf.setNumChannels(1);
+    REQUIRE(view0->sample(N-1) == ref0.sample(N-1));
+
+    buf.clear();
+    REQUIRE(view0->limits().start == 0.);
+    REQUIRE(view0->limits().end == 0.);
+
+    delete view0;
+}
+
+TEST_CASE("resizing a big MultiRingBuffer", "[memory, buffer]")
+{
+    // big enough to move channels in parallel
+    const unsigned NC = 4;
+    const unsigned N = 1 << 20;
+    MultiRingBufferT<float> buf(NC, N);
+    QList<FrameBuffer*> views;
+    QList<RingBufferT<float>*> refs;
+    for (unsigned ci = 0; ci < NC; ci++)
+    {
+        views.append(buf.makeChannel(ci));
+        refs.append(new RingBufferT<float>(N));
+    }
+
+    // wraps around the ring
+    const unsigned ns = N + N/3;
+    SamplePack pack(ns, NC);
+    for (unsigned ci = 0; ci < NC; ci++)
+    {
+        for (unsigned i = 0; i < ns; i++)
+        {
+            pack.data(ci)[i] = ((i * (ci + 3)) % 100003) - 50000. * ci;
+        }
+        refs[ci]->addSamples(pack.data(ci), ns);
+    }
+    buf.addSamples(pack);
+
+    auto check = [&](unsigned n)
+        {
+            for (unsigned ci = 0; ci < NC; ci++)
+            {
+                REQUIRE(views[ci]->size() == n);
+                REQUIRE(views[ci]->sample(0) == refs[ci]->sample(0));
+                REQUIRE(views[ci]->sample(n/2) == refs[ci]->sample(n/2));
+                REQUIRE(views[ci]->sample(n-1) == refs[ci]->sample(n-1));
+                REQUIRE(views[ci]->limits().start == refs[ci]->limits().start);
+                REQUIRE(views[ci]->limits().end == refs[ci]->limits().end);
+                REQUIRE(views[ci]->rangeLimits(n/5, n/3).start == refs[ci]->rangeLimits(n/5, n/3).start);
+                REQUIRE(views[ci]->rangeLimits(n/5, n/3).end == refs[ci]->rangeLimits(n/5, n/3).end);
+            }
+        };
+
+    check(N);
+
+    unsigned sizes[] = {N/2 + 17, N/8, 3*N};
+    for (unsigned n : sizes)
+    {
+        buf.resize(n);
+        for (auto ref : refs) ref->resize(n);
+        check(n);
+    }
+
+    // a new view shares the summary with the old one
+    FrameBuffer* view = buf.makeChannel(1);
+    REQUIRE(view->limits().start == views[1]->limits().start);
+    delete view;
+
+    qDeleteAll(views);
+    qDeleteAll(refs);
+}
+
+TEST_CASE("MultiRingBuffer snapshot", "[memory, buffer]")
+{
+    const unsigned CHUNK = MultiRingBuffer::SNAPSHOT_CHUNK;
+    const unsigned N = 10 * CHUNK + 100;
+    auto buf = new MultiRingBufferT<qint32>(2, N);
+
+    unsigned total = 0;
+    auto feed = [&](unsigned ns)
+        {
+            SamplePack pack(ns, 2);
+            for (unsigned i = 0; i < ns; i++)
+            {
+                pack.data(0)[i] = total + i;
+                pack.data(1)[i] = -(double) (total + i);
+            }
+            total += ns;
+            buf->addSamples(pack);
+        };
+
+    // ring wraps around
+    feed(N + N/3);
+    unsigned first = total - N; // value of first sample in snapshot
+
+    size_t before = memoryReserved(MemoryUser_Snapshots);
+    QVector<FrameBuffer*> snap = buf->snapshot();
+    REQUIRE(snap.size() == 2);
+    // nothing is copied yet
+    REQUIRE(memoryReserved(MemoryUser_Snapshots) == before);
+
+    auto check = [&]()
+        {
+            REQUIRE(snap[0]->size() == N);
+            REQUIRE(snap[0]->sample(0) == first);
+            REQUIRE(snap[0]->sample(N-1) == first + N - 1);
+            REQUIRE(snap[1]->sample(N/2) == -(double) (first + N/2));
+
+            double out[N];
+            snap[0]->copySamples(0, N, out);
+            unsigned numWrong = 0;
+            for (unsigned i = 0; i < N; i++)
+            {
+                if (out[i] != first + i) numWrong++;
+            }
+            REQUIRE(numWrong == 0);
+
+            REQUIRE(snap[0]->limits().start == first);
+            REQUIRE(snap[0]->limits().end == first + N - 1);
+            REQUIRE(snap[1]->limits().start == -(double) (first + N - 1));
+            Range r = snap[0]->rangeLimits(CHUNK/2, 3 * CHUNK);
+            REQUIRE(r.start == first + CHUNK/2);
+            REQUIRE(r.end == first + CHUNK/2 + 3 * CHUNK - 1);
+        };
+
+    check();
+
+    // overwriting a few samples copies only their chunks (compressed)
+    feed(10);
+    size_t grown = memoryReserved(MemoryUser_Snapshots) - before;
+    REQUIRE(grown > 0);
+    REQUIRE(grown <= sizeof(qint32) * 2 * 2 * CHUNK);
+    check();
+
+    feed(N/2);
+    check();
+
+    // a second snapshot doesn't affect the first one
+    QVector<FrameBuffer*> snap2 = buf->snapshot();
+    REQUIRE(snap2[0]->sample(N-1) == total - 1);
+    feed(7);
+    check();
+    REQUIRE(snap2[0]->sample(N-1) == total - 8);
+    qDeleteAll(snap2);
+
+    // data is kept when buffer is resized and deleted
+    buf->resize(N/2);
+    check();
+    delete buf;
+    check();
+
+    qDeleteAll(snap);
+    REQUIRE(memoryReserved(MemoryUser_Snapshots) == before);
+}
+
+template <typename T>
+static void checkCompression(const T* data, unsigned n)
+{
+    CompressedBlock block = compressBlock(data, n, MemoryUser_Snapshots);
+    REQUIRE(block.numSamples == n);
+
+    std::vector<double> out(n);
+    decompressBlock(block, out.data());
+    unsigned numWrong = 0;
+    for (unsigned i = 0; i < n; i++)
+    {
+        double expected = data[i];
+        // NaN doesn't equal itself, bits are compared
+        if (memcmp(&out[i], &expected, sizeof(double)) != 0) numWrong++;
+    }
+    REQUIRE(numWrong == 0);
+    releaseBlock(block, MemoryUser_Snapshots);
+}
+
+TEST_CASE("sample compression", "[memory]")
+{
+    const unsigned N = 1000;
+
+    // integers
+    qint16 i16[N];
+    quint32 u32[N];
+    for (unsigned i = 0; i < N; i++)
+    {
+        i16[i] = (qint16) (i * 7919);
+        u32[i] = i % 3 ? 0xFFFFFFFF - i : i;
+    }
+    checkCompression(i16, N);
+    checkCompression(u32, N);
+
+    // floating point, with special values
+    double d[N];
+    float f[N];
+    for (unsigned i = 0; i < N; i++)
+    {
+        d[i] = sin(i * 0.01) * 1000.123;
+        f[i] = (float) d[i];
+    }
+    d[10] = std::numeric_limits<double>::quiet_NaN();
+    d[11] = std::numeric_limits<double>::infinity();
+    d[12] = -0.0;
+    d[13] = 1e300;
+    checkCompression(d, N);
+    checkCompression(f, N);
+    checkCompression(d, 1);
+
+    // integer valued doubles (ex: ADC readings) are stored as integers
+    for (unsigned i = 0; i < N; i++)
+    {
+        d[i] = 2048 + (int) (sin(i * 0.001) * 100) + (i % 3);
+    }
+    checkCompression(d, N);
+    CompressedBlock block = compressBlock(d, N, MemoryUser_Snapshots);
+    REQUIRE(block.size * 5 < sizeof(d));
+    releaseBlock(block, MemoryUser_Snapshots);
+
+    // repeating values compress well as XOR too
+    for (unsigned i = 0; i < N; i++)
+    {
+        d[i] = 0.1 * (i / 100);
+    }
+    checkCompression(d, N);
+    block = compressBlock(d, N, MemoryUser_Snapshots);
+    REQUIRE(block.size * 20 < sizeof(d));
+    releaseBlock(block, MemoryUser_Snapshots);
+}
+
+TEST_CASE("CompressedBuffer", "[memory, buffer]")
+{
+    const unsigned N = 3 * CompressedBuffer::BLOCK_SIZE + 100;
+    RingBuffer source(N);
+    std::vector<double> data(N);
+    for (unsigned i = 0; i < N; i++)
+    {
+        data[i] = 100 + (int) (50 * sin(i * 0.002));
+    }
+    source.addSamples(data.data(), N);
+
+    CompressedBuffer buf(&source, 50, N - 50);
+    REQUIRE(buf.size() == N - 50);
+    REQUIRE(buf.compressedSize() * 5 < sizeof(double) * buf.size());
+    REQUIRE(buf.sample(0) == data[50]);
+    REQUIRE(buf.sample(N - 51) == data[N-1]);
+
+    std::vector<double> out(N - 50);
+    buf.copySamples(0, N - 50, out.data());
+    REQUIRE(std::equal(out.begin(), out.end(), data.begin() + 50));
+
+    REQUIRE(buf.limits().start == source.rangeLimits(50, N - 50).start);
+    REQUIRE(buf.limits().end == source.rangeLimits(50, N - 50).end);
+    unsigned starts[] = {0, 10, CompressedBuffer::BLOCK_SIZE - 50, 2 * CompressedBuffer::BLOCK_SIZE};
+    for (unsigned s : starts)
+    {
+        unsigned n = N - 50 - s - 20;
+        REQUIRE(buf.rangeLimits(s, n).start == source.rangeLimits(50 + s, n).start);
+        REQUIRE(buf.rangeLimits(s, n).end == source.rangeLimits(50 + s, n).end);
+        REQUIRE(buf.rangeLimits(s, 7).end == source.rangeLimits(50 + s, 7).end);
+    }
+
+    CompressedBuffer buf2(data.data(), 10);
+    REQUIRE(buf2.sample(9) == data[9]);
+}
+
+TEST_CASE("HistoryFile", "[memory, buffer]")
+{
+    HistoryFile history(2);
+    REQUIRE(history.isOpen());
+    REQUIRE(history.numChannels() == 2);
+    REQUIRE(history.numRows() == 0);
+
+    // packs cross both block and chunk boundaries
+    unsigned total = 0;
+    unsigned packSizes[] = {1, 1500, HistoryFile::CHUNK_ROWS, 3000, 5};
+    for (unsigned ns : packSizes)
+    {
+        SamplePack pack(ns, 2);
+        for (unsigned i = 0; i < ns; i++)
+        {
+            pack.data(0)[i] = (total + i) % 1013;
+            pack.data(1)[i] = -double(total + i);
+        }
+        total += ns;
+        history.addSamples(pack);
+    }
+    REQUIRE(history.numRows() == total);
+
+    FrameBuffer* view = history.makeChannel(1);
+    REQUIRE(view->size() == total);
+    REQUIRE(view->sample(0) == 0);
+    REQUIRE(view->sample(total-1) == -double(total-1));
+    REQUIRE(history.sample(0, 2000) == 2000 % 1013);
+
+    // copy across a chunk boundary
+    const unsigned N = 500;
+    double out[N];
+    unsigned start = HistoryFile::CHUNK_ROWS - N/2;
+    view->copySamples(start, N, out);
+    for (unsigned i = 0; i < N; i++)
+    {
+        REQUIRE(out[i] == -double(start + i));
+    }
+
+    REQUIRE(view->limits().start == -double(total-1));
+    REQUIRE(view->limits().end == 0);
+    REQUIRE(history.limits(0).start == 0);
+    REQUIRE(history.limits(0).end == 1012);
+
+    // ranges with partial and full blocks are checked against a plain scan
+    unsigned ranges[][2] = {{0, 1}, {10, 100}, {1000, 5000}, {1024, 2048},
+                            {HistoryFile::CHUNK_ROWS - 10, 3000}, {0, total}};
+    for (auto range : ranges)
+    {
+        Range expected = {history.sample(0, range[0]), history.sample(0, range[0])};
+        for (unsigned i = range[0]; i < range[0] + range[1]; i++)
+        {
+            expected.start = std::min(expected.start, history.sample(0, i));
+            expected.end = std::max(expected.end, history.sample(0, i));
+        }
+        auto lim = history.rangeLimits(0, range[0], range[1]);
+        REQUIRE(lim.start == expected.start);
+        REQUIRE(lim.end == expected.end);
+    }
+    REQUIRE(view->rangeLimits(10, 10).start == -19);
+    REQUIRE(view->rangeLimits(10, 10).end == -10);
+
+    delete view;
+}
+
+TEST_CASE("TieredHistory", "[memory, buffer]")
+{
+    // with 64 bins tiers cover 1024, 16384, 262144 samples and the last
+    // one is merged once
+    const unsigned TOTAL = 5000000;
+    TieredHistory history(1, 100, 64);
+    for (unsigned i = 0; i < TOTAL; i += 100000)
+    {
+        SamplePack pack(100000, 1);
+        for (unsigned j = 0; j < 100000; j++)
+        {
+            pack.data(0)[j] = i + j;
+        }
+        history.addSamples(pack);
+    }
+    REQUIRE(history.numRows() == TOTAL);
+
+    FrameBuffer* view = history.makeChannel(0);
+    REQUIRE(view->size() == TOTAL);
+    REQUIRE(view->limits().start == 0);
+    REQUIRE(view->limits().end == TOTAL-1);
+
+    // recent samples are exact
+    REQUIRE(view->sample(TOTAL-1) == TOTAL-1);
+    REQUIRE(view->sample(TOTAL-100) == TOTAL-100);
+    REQUIRE(view->rangeLimits(TOTAL-50, 10).start == TOTAL-50);
+    REQUIRE(view->rangeLimits(TOTAL-50, 10).end == TOTAL-41);
+
+    // older samples are means of bins of 16 samples
+    unsigned i = TOTAL - 500;
+    REQUIRE(view->sample(i) == (i - i % 16) + 7.5);
+
+    // oldest samples are in the last tier, bins of 65536 merged to 131072
+    REQUIRE(view->sample(10) == 131071 / 2.);
+    auto lim = view->rangeLimits(1000, 10);
+    REQUIRE(lim.start == 0);
+    REQUIRE(lim.end == 131071);
+
+    // ranges covering multiple tiers
+    lim = view->rangeLimits(0, TOTAL);
+    REQUIRE(lim.start == 0);
+    REQUIRE(lim.end == TOTAL-1);
+    // limits of old samples include whole bins
+    lim = view->rangeLimits(TOTAL - 20000, 19990);
+    REQUIRE(lim.start <= TOTAL - 20000);
+    REQUIRE(lim.start > TOTAL - 20000 - 4096);
+    REQUIRE(lim.end >= TOTAL - 11);
+
+    delete view;
+}
+
+TEST_CASE("TieredHistory recent size change", "[memory, buffer]")
 {
-    IndexBuffer source(10);
+    TieredHistory history(1, 100, 64);
+    auto add = [&history](unsigned first, unsigned n)
+        {
+            SamplePack pack(n, 1);
+            for (unsigned j = 0; j < n; j++)
+            {
+                pack.data(0)[j] = first + j;
+            }
+            history.addSamples(pack);
+        };
+    add(0, 1000);
+
+    FrameBuffer* view = history.makeChannel(0);
+
+    // samples that were binned before growing are still bin means
+    history.setRecentSize(300);
+    REQUIRE(view->sample(999) == 999);
+    REQUIRE(view->sample(900) == 900);
+    REQUIRE(view->sample(899) == 896 + 7.5);
+    REQUIRE(view->rangeLimits(850, 150).start <= 850);
+    REQUIRE(view->rangeLimits(850, 150).end == 999);
+
+    // new samples fill the grown buffer
+    add(1000, 250);
+    REQUIRE(view->sample(950) == 950);
+    REQUIRE(view->sample(899) == 896 + 7.5);
+    add(1250, 100);
+    REQUIRE(view->sample(1050) == 1050);
+    REQUIRE(view->sample(1049) == 1040 + 7.5);
+
+    // shrinking drops the oldest recent samples
+    history.setRecentSize(50);
+    REQUIRE(view->sample(1300) == 1300);
+    REQUIRE(view->sample(1299) == 1296 + 7.5);
+    REQUIRE(view->rangeLimits(1300, 50).start == 1300);
+
+    delete view;
+}
 
-    ReadOnlyBuffer buf(&source);
+TEST_CASE("TieredHistory past 2^32 samples", "[memory, buffer]")
+{
+    // session starts 300000 samples before 2^32, last tier has 4 bins
+    // and is merged up to bins of 524288, one of them ends at 2^32
+    const quint64 FIRST = (quint64(1) << 32) - 300000;
+    const unsigned TOTAL = 1000000;
+    TieredHistory history(1, 100, 4, FIRST);
+    for (unsigned i = 0; i < TOTAL; i += 100000)
+    {
+        SamplePack pack(100000, 1);
+        for (unsigned j = 0; j < 100000; j++)
+        {
+            pack.data(0)[j] = i + j;
+        }
+        history.addSamples(pack);
+    }
+    REQUIRE(history.numRows() == TOTAL);
+    REQUIRE(history.endRow() == FIRST + TOTAL);
+
+    FrameBuffer* view = history.makeChannel(0);
+    REQUIRE(view->size() == TOTAL);
+    REQUIRE(view->sample(TOTAL-1) == TOTAL-1);
+    REQUIRE(view->rangeLimits(TOTAL-50, 10).start == TOTAL-50);
+
+    // bins on both sides of 2^32
+    REQUIRE(view->sample(10) == 149999.5);
+    REQUIRE(view->sample(300000) == 562143.5);
+    auto lim = view->rangeLimits(299990, 20);
+    REQUIRE(lim.start == 0);
+    REQUIRE(lim.end == 824287);
+
+    lim = view->rangeLimits(0, TOTAL);
+    REQUIRE(lim.start == 0);
+    REQUIRE(lim.end == TOTAL-1);
+    REQUIRE(history.sample(0, FIRST + TOTAL - 1) == TOTAL-1);
+
+    delete view;
+}
 
+TEST_CASE("XRingBuffer", "[memory, buffer]")
+{
+    XRingBuffer buf(10);
     REQUIRE(buf.size() == 10);
+    REQUIRE(buf.findIndex(0.) == 9); // all zeros initially
+    REQUIRE(buf.findIndex(1.) == XFrameBuffer::OUT_OF_RANGE);
+
+    // timestamps with repeating values, wraps around the ring
+    double values[8] = {1, 2, 2, 3, 5, 8, 13, 21};
+    buf.addSamples(values, 4);
+    buf.addSamples(values+4, 4);
+
+    auto l = buf.limits();
+    REQUIRE(l.start == 0.);
+    REQUIRE(l.end == 21.);
+
+    REQUIRE(buf.sample(2) == 1.);
+    REQUIRE(buf.findIndex(0.) == 1);
+    REQUIRE(buf.findIndex(1.5) == 2);
+    REQUIRE(buf.findIndex(2.) == 4);
+    REQUIRE(buf.findIndex(12.9) == 7);
+    REQUIRE(buf.findIndex(21.) == 9);
+    REQUIRE(buf.findIndex(-0.01) == XFrameBuffer::OUT_OF_RANGE);
+    REQUIRE(buf.findIndex(21.01) == XFrameBuffer::OUT_OF_RANGE);
+
+    // older samples are dropped, limits should follow
+    double newValues[4] = {34, 55, 89, 144};
+    buf.addSamples(newValues, 4);
+    l = buf.limits();
+    REQUIRE(l.start == 2.);
+    REQUIRE(l.end == 144.);
+    REQUIRE(buf.findIndex(100.) == 8);
+
+    buf.clear();
+    REQUIRE(buf.limits().end == 0.);
+}
+
+TEST_CASE("SweepBuffer", "[memory, buffer]")
+{
+    RingBuffer source(10);
+    double data[13];
+    for (unsigned i = 0; i < 13; i++) data[i] = i;
+    source.addSamples(data, 13); // samples [3, 12], 13 is the next sequence
+
+    SweepBuffer buf(&source);
+    REQUIRE(buf.size() == 10);
+    REQUIRE(buf.phase() == 0);
+    REQUIRE(buf.sample(0) == 3);
+
+    // each sample is at its sequence number modulo size
+    buf.setPhase(13);
+    REQUIRE(buf.phase() == 3);
+    for (unsigned i = 0; i < 10; i++)
+    {
+        REQUIRE(buf.sample(i) == (i < 3 ? i + 10 : i));
+    }
+
     auto lim = buf.limits();
-    REQUIRE(lim.start == 0.);
+    REQUIRE(lim.start == 3.);
+    REQUIRE(lim.end == 12.);
+
+    // ranges on either side and across the phase
+    lim = buf.rangeLimits(0, 3);
+    REQUIRE(lim.start == 10.);
+    REQUIRE(lim.end == 12.);
+    lim = buf.rangeLimits(4, 6);
+    REQUIRE(lim.start == 4.);
     REQUIRE(lim.end == 9.);
+    lim = buf.rangeLimits(1, 4);
+    REQUIRE(lim.start == 3.);
+    REQUIRE(lim.end == 12.);
+
+    double out[10];
+    buf.copySamples(0, 10, out);
     for (unsigned i = 0; i < 10; i++)
     {
-        REQUIRE(buf.sample(i) == i);
+        REQUIRE(out[i] == buf.sample(i));
     }
+    buf.copySamples(2, 3, out);
+    REQUIRE(out[0] == 12);
+    REQUIRE(out[1] == 3);
+    REQUIRE(out[2] == 4);
 }
 
-TEST_CASE("ReadOnlyBuffer sliced constructor", "[memory, buffer]")
+TEST_CASE("minMax kernels", "[memory, buffer, simd]")
 {
-    IndexBuffer source(10);
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::SSE2,
+                                SimdLevel::AVX2, SimdLevel::AVX512};
 
-    ReadOnlyBuffer buf(&source, 5, 4);
+    // length that is not a multiple of any vector size
+    const unsigned N = 1003;
+    double values[N];
+    for (unsigned i = 0; i < N; i++)
+    {
+        values[i] = (i * 7919) % 1000 - 500.;
+    }
 
-    REQUIRE(buf.size() == 4);
-    auto lim = buf.limits();
-    REQUIRE(lim.start == 5.);
-    REQUIRE(lim.end == 8.);
-    for (unsigned i = 0; i < 4; i++)
+    for (auto level : levels)
+    {
+        if (!isSimdLevelSupported(level)) continue;
+        INFO("level: " << simdLevelName(level));
+
+        // check all lengths shorter than vector sizes too
+        for (unsigned n = 1; n < 40; n++)
+        {
+            Range expected = {values[0], values[0]};
+            for (unsigned i = 1; i < n; i++)
+            {
+                expected.start = std::min(expected.start, values[i]);
+                expected.end = std::max(expected.end, values[i]);
+            }
+            auto r = minMax(level, values, n);
+            REQUIRE(r.start == expected.start);
+            REQUIRE(r.end == expected.end);
+        }
+
+        auto r = minMax(level, values, N);
+        REQUIRE(r.start == -500.);
+        REQUIRE(r.end == 499.);
+
+        // first element is max, last element is min
+        double desc[N];
+        for (unsigned i = 0; i < N; i++) desc[i] = N - i;
+        r = minMax(level, desc, N);
+        REQUIRE(r.start == 1.);
+        REQUIRE(r.end == N);
+
+        // NaN is ignored if not first
+        desc[500] = std::numeric_limits<double>::quiet_NaN();
+        r = minMax(level, desc, N);
+        REQUIRE(r.start == 1.);
+        REQUIRE(r.end == N);
+    }
+
+    auto r = minMax(values, N);
+    REQUIRE(r.start == -500.);
+    REQUIRE(r.end == 499.);
+}
+
+TEST_CASE("minMax kernels with NaN", "[memory, buffer, simd]")
+{
+    const SimdLevel levels[] = {SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512};
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    const unsigned N = 67;
+    double values[N];
+    for (unsigned i = 0; i < N; i++) values[i] = i;
+    values[26] = 500;
+    values[30] = -100;
+
+    // NaN in each lane of the first vectors, in the loop and in the tail
+    for (unsigned pos = 1; pos < N; pos++)
+    {
+        INFO("NaN at: " << pos);
+        double data[N];
+        std::copy(values, values + N, data);
+        data[pos] = nan;
+        if (pos + 9 < N) data[pos + 9] = nan;
+
+        auto expected = minMax(SimdLevel::Scalar, data, N);
+        for (auto level : levels)
+        {
+            if (!isSimdLevelSupported(level)) continue;
+            INFO("level: " << simdLevelName(level));
+
+            auto r = minMax(level, data, N);
+            REQUIRE(r.start == expected.start);
+            REQUIRE(r.end == expected.end);
+        }
+    }
+
+    // NaN at first element is returned
+    double data[N];
+    std::copy(values, values + N, data);
+    data[0] = nan;
+    for (auto level : levels)
+    {
+        if (!isSimdLevelSupported(level)) continue;
+        auto r = minMax(level, data, N);
+        REQUIRE(std::isnan(r.start));
+        REQUIRE(std::isnan(r.end));
+    }
+}
+
+TEST_CASE("gainOffset kernels", "[simd]")
+{
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::SSE2,
+                                SimdLevel::AVX2, SimdLevel::AVX512};
+
+    const unsigned N = 70;
+    double values[N];
+    for (unsigned i = 0; i < N; i++)
+    {
+        values[i] = (i * 7919) % 1000 - 500.;
+    }
+
+    for (auto level : levels)
+    {
+        if (!isSimdLevelSupported(level)) continue;
+        INFO("level: " << simdLevelName(level));
+
+        // all lengths shorter than and around the vector sizes
+        for (unsigned n = 0; n <= N; n++)
+        {
+            double out[N+1];
+            out[n] = -1.;       // guard
+            gainOffset(level, values, n, 2.5, -3., out);
+            for (unsigned i = 0; i < n; i++)
+            {
+                REQUIRE(out[i] == Approx(values[i] * 2.5 - 3.));
+            }
+            REQUIRE(out[n] == -1.);
+        }
+
+        // in place
+        double inPlace[N];
+        std::copy(values, values+N, inPlace);
+        gainOffset(level, inPlace, N, 0.5, 10., inPlace);
+        for (unsigned i = 0; i < N; i++)
+        {
+            REQUIRE(inPlace[i] == Approx(values[i] * 0.5 + 10.));
+        }
+    }
+
+    // default kernel
+    double out[N];
+    gainOffset(values, N, -1., 1., out);
+    REQUIRE(out[0] == 1. - values[0]);
+    REQUIRE(out[N-1] == 1. - values[N-1]);
+}
+
+TEST_CASE("MinMaxPyramid range queries", "[memory, buffer]")
+{
+    // not a multiple of leaf size or a power of 2
+    const unsigned N = MinMaxPyramid::LEAF_SIZE * 37 + 13;
+    double values[N];
+    for (unsigned i = 0; i < N; i++)
+    {
+        values[i] = (i * 7919) % 1013;
+    }
+
+    MinMaxPyramid pyramid;
+    pyramid.build(values, N);
+
+    auto bruteForce = [&values](unsigned start, unsigned end) -> Range
+        {
+            Range r = {values[start], values[start]};
+            for (unsigned i = start+1; i < end; i++)
+            {
+                r.start = std::min(r.start, values[i]);
+                r.end = std::max(r.end, values[i]);
+            }
+            return r;
+        };
+
+    auto checkRanges = [&]()
+        {
+            auto r = pyramid.limits();
+            auto e = bruteForce(0, N);
+            REQUIRE(r.start == e.start);
+            REQUIRE(r.end == e.end);
+
+            for (unsigned start = 0; start < N; start += 29)
+            {
+                for (unsigned end = start+1; end <= N; end += 31)
+                {
+                    r = pyramid.limits(values, start, end);
+                    e = bruteForce(start, end);
+                    REQUIRE(r.start == e.start);
+                    REQUIRE(r.end == e.end);
+                }
+            }
+        };
+
+    checkRanges();
+
+    // modify some data and update
+    for (unsigned i = 100; i < 300; i++) values[i] = -1. * i;
+    pyramid.update(values, 100, 300);
+    values[N-1] = 5000;
+    pyramid.update(values, N-1, N);
+    checkRanges();
+
+    // single leaf
+    MinMaxPyramid small;
+    small.build(values, 3);
+    REQUIRE(small.limits().start == bruteForce(0, 3).start);
+    REQUIRE(small.limits().end == bruteForce(0, 3).end);
+    REQUIRE(small.limits(values, 1, 2).end == values[1]);
+}
+
+TEST_CASE("RingBuffer range limits", "[memory, buffer]")
+{
+    const unsigned N = 1000;
+    RingBuffer buf(N);
+
+    double values[N];
+    for (unsigned i = 0; i < N; i++)
+    {
+        values[i] = (i * 7919) % 1013;
+    }
+
+    // make sure data wraps around
+    buf.addSamples(values, N);
+    buf.addSamples(values, 333);
+
+    for (unsigned start = 0; start < N; start += 17)
     {
-        REQUIRE(buf.sample(i) == (i + 5));
+        for (unsigned n = 1; start + n <= N; n += 23)
+        {
+            Range e = {buf.sample(start), buf.sample(start)};
+            for (unsigned i = start+1; i < start+n; i++)
+            {
+                e.start = std::min(e.start, buf.sample(i));
+                e.end = std::max(e.end, buf.sample(i));
+            }
+            auto r = buf.rangeLimits(start, n);
+            REQUIRE(r.start == e.start);
+            REQUIRE(r.end == e.end);
+        }
     }
 }
@@ -0,0 +1,167 @@
+/*
+  Copyright © 2022 Hasan Yavuz Özderya
+
+  This file is part of serialplot.
+
+  serialplot is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  serialplot is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// This tells Catch to provide a main() - only do this in one cpp file per executable
+#define CATCH_CONFIG_RUNNER
+#include "catch.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <QPainter>
+#include <QPolygonF>
+#include <QVector>
+#include "curvelayer.h"
+
+static const QSize LAYER_SIZE(200, 100);
+static const int MARGIN = 4;
+
+/// Scrolling data like a plot shows it, `first` is the index of sample
+/// at the left edge. Samples are 2 pixels apart.
+class ScrollingCurve
+{
+public:
+    int first = 0;
+    QVector<double> changed;    ///< values that overwrite the sine
+
+    double value(int i) const
+        {
+            if (i >= 0 && i < changed.size() && !std::isnan(changed[i])) return changed[i];
+            return 50 + 40 * sin(i * 0.3);
+        };
+
+    /// Draws like a plot, a few samples outside of the layer are
+    /// included so that lines to them are drawn
+    void draw(QPainter* painter, const QRectF& clip) const
+        {
+            Q_UNUSED(clip);
+            QPolygonF line;
+            for (int j = -5; j < LAYER_SIZE.width() / 2 + 5; j++)
+            {
+                line << QPointF(j * 2 + 0.5, value(first + j));
+            }
+            painter->setRenderHint(QPainter::Antialiasing);
+            painter->setPen(QPen(Qt::red, 1.5));
+            painter->drawPolyline(line);
+        };
+
+    CurveLayer::DrawFunc drawFunc() const
+        {
+            return [this](QPainter* painter, const QRectF& clip) {draw(painter, clip);};
+        };
+};
+
+/// Returns a layer that is fully drawn from `curve`
+static QImage fullRedraw(const ScrollingCurve& curve)
+{
+    CurveLayer layer;
+    layer.redraw(LAYER_SIZE, 1, curve.drawFunc());
+    return layer.image();
+}
+
+/// Returns true if images differ at most by 1 in any channel of a
+/// pixel. Antialiasing of a moved line may round a little differently.
+static bool sameImage(const QImage& a, const QImage& b)
+{
+    if (a.size() != b.size()) return false;
+
+    for (int y = 0; y < a.height(); y++)
+    {
+        for (int x = 0; x < a.width(); x++)
+        {
+            QRgb pa = a.pixel(x, y);
+            QRgb pb = b.pixel(x, y);
+            if (abs(qRed(pa) - qRed(pb)) > 1 || abs(qGreen(pa) - qGreen(pb)) > 1 ||
+                abs(qBlue(pa) - qBlue(pb)) > 1 || abs(qAlpha(pa) - qAlpha(pb)) > 1)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE("scrolled curve layer is the same as full redraw", "[plot]")
+{
+    ScrollingCurve curve;
+    CurveLayer layer;
+    layer.redraw(LAYER_SIZE, 1, curve.drawFunc());
+    REQUIRE(layer.isValid());
+    REQUIRE(sameImage(layer.image(), fullRedraw(curve)));
+
+    // a few frames of new samples, 2 pixels per sample
+    for (int added : {1, 3, 2, 7})
+    {
+        curve.first += added;
+        REQUIRE(layer.scroll(added * 2, MARGIN, curve.drawFunc()));
+        REQUIRE(sameImage(layer.image(), fullRedraw(curve)));
+    }
+
+    // no scroll, newest samples are still redrawn
+    REQUIRE(layer.scroll(0, MARGIN, curve.drawFunc()));
+    REQUIRE(sameImage(layer.image(), fullRedraw(curve)));
+}
+
+TEST_CASE("curve layer doesn't scroll by a fraction of a pixel", "[plot]")
+{
+    ScrollingCurve curve;
+    CurveLayer layer;
+    layer.redraw(LAYER_SIZE, 1, curve.drawFunc());
+    QImage before = layer.image();
+
+    curve.first += 1;
+    REQUIRE_FALSE(layer.scroll(2.5, MARGIN, curve.drawFunc()));
+    REQUIRE(layer.image() == before);
+
+    // out of image
+    REQUIRE_FALSE(layer.scroll(LAYER_SIZE.width(), MARGIN, curve.drawFunc()));
+    REQUIRE_FALSE(layer.scroll(-2, MARGIN, curve.drawFunc()));
+
+    // tiny errors of scale calculations are tolerated
+    REQUIRE(layer.scroll(2 - 1e-9, MARGIN, curve.drawFunc()));
+    REQUIRE(sameImage(layer.image(), fullRedraw(curve)));
+}
+
+TEST_CASE("redrawn columns of curve layer are the same as full redraw", "[plot]")
+{
+    ScrollingCurve curve;
+    CurveLayer layer;
+    layer.redraw(LAYER_SIZE, 1, curve.drawFunc());
+
+    // overwrite samples 40-44 in place, like a sweep display
+    curve.changed.fill(NAN, 50);
+    for (int i = 40; i < 45; i++) curve.changed[i] = 10;
+    layer.redrawColumns(40 * 2 - MARGIN, 44 * 2 + 1 + MARGIN, curve.drawFunc());
+    REQUIRE(sameImage(layer.image(), fullRedraw(curve)));
+
+    layer.invalidate();
+    REQUIRE_FALSE(layer.isValid());
+    layer.invalidate(true);
+    REQUIRE(layer.image().isNull());
+}
+
+// Note: this is added because a `QGuiApplication` is needed for painting
+#include <QGuiApplication>
+int main(int argc, char* argv[])
+{
+    QGuiApplication a(argc, argv);
+
+    int result = Catch::Session().run( argc, argv );
+
+    return result;
+}
@@ -18,7 +18,7 @@ public:
             _hasX = false;
         };
 
-    void feedIn(const SamplePack& data)
+    void feedIn(const SamplePackView& data)
         {
             REQUIRE(data.numChannels() == numChannels());
 
@@ -51,11 +51,13 @@ class TestSource : public Source
 public:
     int _numChannels;
     bool _hasX;
+    NumberFormat _numberFormat;
 
-    TestSource(unsigned nc, bool x)
+    TestSource(unsigned nc, bool x, NumberFormat nf = NumberFormat_double)
         {
             _numChannels = nc;
             _hasX = x;
+            _numberFormat = nf;
         };
 
     virtual unsigned numChannels() const
@@ -68,7 +70,12 @@ public:
             return _hasX;
         };
 
-    void _feed(const SamplePack& data) const
+    virtual NumberFormat numberFormat() const
+        {
+            return _numberFormat;
+        };
+
+    void _feed(const SamplePackView& data) const
         {
             feedOut(data);
         };
@@ -78,6 +85,13 @@ public:
             _numChannels = nc;
             _hasX = x;
 
+            updateNumChannels();
+        };
+
+    void _setNumberFormat(NumberFormat nf)
+        {
+            _numberFormat = nf;
+
             updateNumChannels();
         };
 };
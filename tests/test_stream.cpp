@@ -17,7 +17,10 @@
   along with serialplot.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <cmath>
 #include "stream.h"
+#include "packqueue.h"
+#include "allocator.h"
 
 #include "catch.hpp"
 #include "test_helpers.h"
@@ -65,7 +68,6 @@ TEST_CASE("changing stream number of channels via sink", "[memory, stream, sink]
     }
 
 // TODO: enable test when `Stream` supports X channel
-#if 0
     // increase nc value, add X
     so._setNumChannels(5, true);
 
@@ -77,8 +79,8 @@ TEST_CASE("changing stream number of channels via sink", "[memory, stream, sink]
         const StreamChannel* c = s.channel(i);
         REQUIRE(c != NULL);
         REQUIRE(c->index() == i);
+        REQUIRE(c->xData() != NULL);
     }
-#endif
 
     // reduce nc value, remove X
     so._setNumChannels(1, false);
@@ -130,8 +132,6 @@ TEST_CASE("adding data to a stream with no X", "[memory, stream, data, sink]")
     }
 }
 
-// TODO: enable test when `Stream` supports X channel
-#if 0
 TEST_CASE("adding data to a stream with X", "[memory, stream, data, sink]")
 {
     Stream s(3, false, 10);
@@ -152,7 +152,8 @@ TEST_CASE("adding data to a stream with X", "[memory, stream, data, sink]")
     }
 
     TestSource so(3, true);
-    REQUIRE_THROWS(so.connectSink(&s));
+    so.connectSink(&s);
+    REQUIRE(s.hasX());
 
     // test
     so._feed(pack);
@@ -182,8 +183,77 @@ TEST_CASE("adding data to a stream with X", "[memory, stream, data, sink]")
     {
         REQUIRE(x->sample(i) == (i-5)+10);
     }
+
+    // find values at X
+    REQUIRE(s.channel(1)->findValue(10) == 0);
+    REQUIRE(s.channel(1)->findValue(12.5) == 2.5);
+    REQUIRE(std::isnan(s.channel(1)->findValue(15)));
+
+    // clearing also clears X
+    s.clear();
+    REQUIRE(x->sample(9) == 0);
+}
+
+TEST_CASE("adding interleaved data to a stream", "[memory, stream, data, sink]")
+{
+    Stream s(2, true, 4);
+    TestSource so(2, true);
+    so.connectSink(&s);
+
+    // rows of {x, ch0, ch1}
+    double rows[] = {0, 10, 20, 1, 11, 21, 2, 12, 22};
+    so._feed(SamplePackView::interleaved(3, 2, rows, true));
+
+    for (unsigned i = 0; i < 3; i++)
+    {
+        REQUIRE(s.channel(0)->xData()->sample(i + 1) == i);
+        REQUIRE(s.channel(0)->yData()->sample(i + 1) == 10 + i);
+        REQUIRE(s.channel(1)->yData()->sample(i + 1) == 20 + i);
+    }
+}
+
+TEST_CASE("stream applies gain and offset", "[memory, stream, data, sink]")
+{
+    Stream s(2, false, 4);
+    TestSource so(2, false);
+    so.connectSink(&s);
+
+    auto info = s.infoModel();
+    info->setData(info->index(0, ChannelInfoModel::COLUMN_GAIN), 2.);
+    info->setData(info->index(0, ChannelInfoModel::COLUMN_GAIN), Qt::Checked, Qt::CheckStateRole);
+    info->setData(info->index(1, ChannelInfoModel::COLUMN_OFFSET), -5.);
+    info->setData(info->index(1, ChannelInfoModel::COLUMN_OFFSET), Qt::Checked, Qt::CheckStateRole);
+
+    SamplePack pack(4, 2, false);
+    for (unsigned i = 0; i < 4; i++)
+    {
+        pack.data(0)[i] = i;
+        pack.data(1)[i] = 10 + i;
+    }
+    so._feed(pack);
+
+    for (unsigned i = 0; i < 4; i++)
+    {
+        REQUIRE(s.channel(0)->yData()->sample(i) == 2. * i);
+        REQUIRE(s.channel(1)->yData()->sample(i) == 5. + i);
+    }
+    // source data isn't modified
+    REQUIRE(pack.data(0)[3] == 3.);
+
+    // interleaved input goes through the same plan
+    double rows[] = {1, 1, 2, 2};
+    so._feed(SamplePackView::interleaved(2, 2, rows));
+    REQUIRE(s.channel(0)->yData()->sample(2) == 2.);
+    REQUIRE(s.channel(0)->yData()->sample(3) == 4.);
+    REQUIRE(s.channel(1)->yData()->sample(2) == -4.);
+    REQUIRE(s.channel(1)->yData()->sample(3) == -3.);
+
+    // disabling gain restores raw values
+    info->setData(info->index(0, ChannelInfoModel::COLUMN_GAIN), Qt::Unchecked, Qt::CheckStateRole);
+    so._feed(pack);
+    REQUIRE(s.channel(0)->yData()->sample(3) == 3.);
+    REQUIRE(s.channel(1)->yData()->sample(3) == 8.);
 }
-#endif
 
 TEST_CASE("paused stream shouldn't store data", "[memory, stream, pause]")
 {
@@ -250,3 +320,353 @@ TEST_CASE("clear stream data", "[memory, stream, pause]")
         }
     }
 }
+
+TEST_CASE("stream storage format follows source number format", "[memory, stream, sink]")
+{
+    Stream s(2, false, 10);
+    REQUIRE(s.storageFormat() == NumberFormat_double);
+
+    TestSource so(2, false, NumberFormat_int16);
+    so.connectSink(&s);
+    REQUIRE(s.storageFormat() == NumberFormat_int16);
+
+    // prepare data
+    SamplePack pack(5, 2, false);
+    for (unsigned ci = 0; ci < 2; ci++)
+    {
+        for (unsigned i = 0; i < 5; i++)
+        {
+            pack.data(ci)[i] = -1000. * i;
+        }
+    }
+    so._feed(pack);
+
+    // narrowing is postponed until clear
+    so._setNumberFormat(NumberFormat_uint8);
+    REQUIRE(s.storageFormat() == NumberFormat_int16);
+    REQUIRE(s.channel(0)->yData()->sample(9) == -4000.);
+
+    // widening keeps the data
+    so._setNumberFormat(NumberFormat_float);
+    REQUIRE(s.storageFormat() == NumberFormat_float);
+    for (unsigned ci = 0; ci < 2; ci++)
+    {
+        const FrameBuffer* y = s.channel(ci)->yData();
+        for (unsigned i = 5; i < 10; i++)
+        {
+            REQUIRE(y->sample(i) == -1000. * (i-5));
+        }
+        auto lim = y->limits();
+        REQUIRE(lim.start == -4000.);
+        REQUIRE(lim.end == 0.);
+    }
+
+    so._setNumberFormat(NumberFormat_uint8);
+    REQUIRE(s.storageFormat() == NumberFormat_float);
+    s.clear();
+    REQUIRE(s.storageFormat() == NumberFormat_uint8);
+    REQUIRE(s.channel(1)->yData()->sample(9) == 0);
+}
+
+TEST_CASE("stream storage holds both old and new formats", "[memory, stream, sink]")
+{
+    Stream s(1, false, 10);
+    TestSource so(1, false, NumberFormat_int32);
+    so.connectSink(&s);
+    REQUIRE(s.storageFormat() == NumberFormat_int32);
+
+    SamplePack pack(5, 1, false);
+    for (unsigned i = 0; i < 5; i++) pack.data(0)[i] = 100000001 + i;
+    so._feed(pack);
+
+    // neither int32 nor float can hold the other
+    so._setNumberFormat(NumberFormat_float);
+    REQUIRE(s.storageFormat() == NumberFormat_double);
+    for (unsigned i = 0; i < 5; i++) pack.data(0)[i] = 0.25 + i;
+    so._feed(pack);
+
+    const FrameBuffer* y = s.channel(0)->yData();
+    for (unsigned i = 0; i < 5; i++)
+    {
+        REQUIRE(y->sample(i) == 100000001. + i);
+        REQUIRE(y->sample(i + 5) == 0.25 + i);
+    }
+
+    // uint16 and int16 are combined as int32
+    s.clear();
+    so._setNumberFormat(NumberFormat_uint16);
+    REQUIRE(s.storageFormat() == NumberFormat_uint16);
+    for (unsigned i = 0; i < 5; i++) pack.data(0)[i] = 60000 + i;
+    so._feed(pack);
+    so._setNumberFormat(NumberFormat_int16);
+    REQUIRE(s.storageFormat() == NumberFormat_int32);
+    for (unsigned i = 0; i < 5; i++) pack.data(0)[i] = -30000. - i;
+    so._feed(pack);
+    for (unsigned i = 0; i < 5; i++)
+    {
+        REQUIRE(s.channel(0)->yData()->sample(i) == 60000. + i);
+        REQUIRE(s.channel(0)->yData()->sample(i + 5) == -30000. - i);
+    }
+}
+
+TEST_CASE("stream records history", "[memory, stream, history]")
+{
+    Stream s(2, false, 10);
+    TestSource so(2, false);
+    so.connectSink(&s);
+
+    // prepare data
+    SamplePack pack(5, 2, false);
+    for (unsigned ci = 0; ci < 2; ci++)
+    {
+        for (unsigned i = 0; i < 5; i++)
+        {
+            pack.data(ci)[i] = ci * 10 + i + 1;
+        }
+    }
+    so._feed(pack);
+
+    // history starts with buffer contents
+    s.setHistoryMode(HistoryMode_File);
+    REQUIRE(s.history() != nullptr);
+    REQUIRE(s.history()->numRows() == 10);
+
+    for (unsigned i = 0; i < 3; i++) so._feed(pack);
+
+    for (unsigned ci = 0; ci < 2; ci++)
+    {
+        const StreamChannel* c = s.channel(ci);
+        REQUIRE(c->xData()->size() == 25);
+        REQUIRE(c->yData()->size() == 25);
+        REQUIRE(c->yData()->sample(4) == 0);
+        for (unsigned i = 5; i < 25; i++)
+        {
+            REQUIRE(c->yData()->sample(i) == ci * 10 + (i % 5) + 1);
+        }
+        REQUIRE(c->findValue(20) == ci * 10 + 1);
+    }
+
+    // changing buffer size doesn't affect history
+    s.setNumSamples(4);
+    REQUIRE(s.channel(0)->yData()->size() == 25);
+
+    // number of channels change starts a new history
+    so._setNumChannels(3, false);
+    REQUIRE(s.history()->numRows() == 4);
+    REQUIRE(s.channel(2)->yData()->size() == 4);
+
+    // clear starts a new history
+    s.clear();
+    REQUIRE(s.history()->numRows() == 4);
+    REQUIRE(s.channel(0)->yData()->limits().end == 0);
+
+    // disabling switches back to buffers
+    SamplePack pack3(5, 3, false);
+    for (unsigned i = 0; i < 5; i++) pack3.data(1)[i] = i;
+    so._feed(pack3);
+    s.setHistoryMode(HistoryMode_Off);
+    REQUIRE(s.history() == nullptr);
+    REQUIRE(s.channel(1)->yData()->size() == 4);
+    REQUIRE(s.channel(1)->yData()->sample(3) == 4);
+    REQUIRE(s.channel(1)->xData()->size() == 4);
+}
+
+TEST_CASE("stream keeps tiered history", "[memory, stream, history]")
+{
+    Stream s(1, false, 10);
+    TestSource so(1, false);
+    so.connectSink(&s);
+    s.setHistoryMode(HistoryMode_Tiered);
+    REQUIRE(s.history() != nullptr);
+
+    SamplePack pack(100, 1, false);
+    for (unsigned i = 0; i < 100; i++) pack.data(0)[i] = i;
+    so._feed(pack);
+
+    // last `numSamples` are at full resolution
+    const FrameBuffer* y = s.channel(0)->yData();
+    REQUIRE(y->size() == 110);
+    REQUIRE(s.channel(0)->xData()->size() == 110);
+    for (unsigned i = 100; i < 110; i++)
+    {
+        REQUIRE(y->sample(i) == i - 10);
+    }
+    REQUIRE(y->limits().end == 99);
+
+    // history follows the number of samples
+    s.setNumSamples(50);
+    so._feed(pack);
+    y = s.channel(0)->yData();
+    for (unsigned i = 160; i < 210; i++)
+    {
+        REQUIRE(y->sample(i) == i - 110);
+    }
+
+    // snapshot doesn't have bin means, grown part is empty like
+    // without history
+    s.setNumSamples(80);
+    QVector<FrameBuffer*> snap = s.snapshot();
+    REQUIRE(snap[0]->size() == 80);
+    for (unsigned i = 0; i < 30; i++)
+    {
+        REQUIRE(snap[0]->sample(i) == 0);
+    }
+    for (unsigned i = 30; i < 80; i++)
+    {
+        REQUIRE(snap[0]->sample(i) == i + 20);
+    }
+    qDeleteAll(snap);
+
+    s.setHistoryMode(HistoryMode_File);
+    REQUIRE(s.channel(0)->yData()->size() == 80);
+    s.setHistoryMode(HistoryMode_Off);
+    REQUIRE(s.history() == nullptr);
+}
+
+TEST_CASE("stream snapshot keeps data", "[memory, stream]")
+{
+    Stream s(2, false, 10);
+    TestSource so(2, false);
+    so.connectSink(&s);
+
+    SamplePack pack(10, 2, false);
+    for (unsigned i = 0; i < 10; i++)
+    {
+        pack.data(0)[i] = i;
+        pack.data(1)[i] = i + 100;
+    }
+    so._feed(pack);
+
+    QVector<FrameBuffer*> snap = s.snapshot();
+    REQUIRE(snap.size() == 2);
+    REQUIRE(snap[1]->size() == 10);
+
+    // stream is modified after snapshot
+    so._feed(pack);
+    s.clear();
+    s.setNumSamples(20);
+    for (unsigned i = 0; i < 10; i++)
+    {
+        REQUIRE(snap[0]->sample(i) == i);
+        REQUIRE(snap[1]->sample(i) == i + 100);
+    }
+    REQUIRE(snap[1]->limits().start == 100);
+
+    // while recording history last part is taken
+    s.setHistoryMode(HistoryMode_File);
+    so._feed(pack);
+    QVector<FrameBuffer*> hsnap = s.snapshot();
+    REQUIRE(hsnap[0]->size() == 20);
+    REQUIRE(hsnap[0]->sample(19) == 9);
+
+    qDeleteAll(snap);
+    qDeleteAll(hsnap);
+}
+
+TEST_CASE("stream sample sequence numbers", "[memory, stream, data]")
+{
+    Stream s(2, false, 10);
+    TestSource so(2, false);
+    so.connectSink(&s);
+    REQUIRE(s.sequence() == 0);
+    REQUIRE(s.firstAvailable() == 0);
+
+    quint64 addedFirst = 0, addedLast = 0;
+    QObject::connect(&s, &Stream::samplesAdded, [&](quint64 first, quint64 last)
+                     {
+                         addedFirst = first;
+                         addedLast = last;
+                     });
+
+    SamplePack pack(4, 2, false);
+    unsigned total = 0;
+    auto feed = [&]()
+        {
+            for (unsigned i = 0; i < 4; i++)
+            {
+                pack.data(0)[i] = total + i;
+                pack.data(1)[i] = -(double) (total + i);
+            }
+            total += 4;
+            so._feed(pack);
+        };
+
+    feed();
+    REQUIRE(s.sequence() == 4);
+    REQUIRE(addedFirst == 0);
+    REQUIRE(addedLast == 4);
+
+    // a range is readable while it's in the buffer
+    for (unsigned i = 0; i < 3; i++) feed();
+    REQUIRE(s.sequence() == 16);
+    REQUIRE(addedFirst == 12);
+    REQUIRE(s.firstAvailable() == 6);
+
+    double out[20];
+    REQUIRE(s.readSamples(1, 12, 16, out));
+    REQUIRE(out[0] == -12);
+    REQUIRE(out[3] == -15);
+    REQUIRE(s.readSamples(0, 6, 16, out));
+    REQUIRE(out[0] == 6);
+    REQUIRE_FALSE(s.readSamples(0, 5, 8, out));
+    REQUIRE_FALSE(s.readSamples(0, 14, 17, out));
+
+    // growing doesn't bring back overwritten samples
+    s.setNumSamples(20);
+    REQUIRE(s.firstAvailable() == 6);
+    feed();
+    REQUIRE(s.readSamples(0, 6, 20, out));
+    REQUIRE(out[0] == 6);
+
+    // sequence continues after clear, but old samples are gone
+    s.clear();
+    REQUIRE(s.sequence() == 20);
+    REQUIRE(s.firstAvailable() == 20);
+    REQUIRE_FALSE(s.readSamples(0, 19, 20, out));
+    feed();
+    REQUIRE(s.readSamples(0, 20, 24, out));
+    REQUIRE(out[3] == 23);
+
+    // paused stream doesn't add samples
+    s.pause(true);
+    feed();
+    REQUIRE(s.sequence() == 24);
+}
+
+TEST_CASE("steady state reading doesn't allocate", "[memory, stream, data]")
+{
+    Stream s(3, false, 1000);
+    PackQueue queue(64);
+    TestSource so(3, false);
+    so.connectSink(&queue);
+    queue.drain();
+    queue.connectSink(&s);
+
+    // like a reader: single sample packs of ascii lines mixed with
+    // packs of binary reads of varying size
+    auto read = [&so, &queue]()
+        {
+            for (unsigned i = 0; i < 100; i++)
+            {
+                SamplePack pack(i % 10 ? 1 : 1 + i % 50, 3);
+                pack.data(0)[0] = i;
+                so._feed(pack);
+            }
+            queue.drain();
+        };
+
+    // warm up the pool, queue slots cycle through pack sizes
+    for (int i = 0; i < 20; i++)
+    {
+        read();
+    }
+    size_t misses = poolMisses();
+    size_t packsMem = memoryReserved(MemoryUser_Packs);
+    for (int i = 0; i < 50; i++)
+    {
+        read();
+    }
+    REQUIRE(poolMisses() == misses);
+    REQUIRE(memoryReserved(MemoryUser_Packs) == packsMem);
+    REQUIRE(s.channel(0)->yData()->sample(999) == 99);
+}